@@ -0,0 +1,1126 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Benchmark the transmit leaf modules against the simulated radio on
+**    the host
+**
+**  Notes:
+**    1. A single threaded driver feeds the leaf modules. Telemetry
+**       workloads generate SB messages that are header compressed by
+**       TX_HDRC, packed in place into TX_RING slots by TX_FRAME and
+**       selected by TX_SCHED. The file workload sends TX_LZ compressed
+**       blocks protected by TX_FEC. Packets are sent by RADIO_SIM.
+**    2. The driver is the benchmark's own code. TLM_FWD, RADIO_IF and
+**       RADIO_TX aren't linked so the results don't measure the app's
+**       transmit pipeline, including its task handoffs, semaphores, duty
+**       cycle limiting, hopping, ADR, striping and SPI batching.
+**    3. Each sweep point is a SF/BW/CR/workload combination run in real
+**       time for the configured duration. Messages arrive as a Poisson
+**       process at the offered load, a percentage of the point's estimated
+**       link capacity.
+**    4. Latency is measured per message from its arrival to its packet's
+**       TxDone so it includes frame packing, queueing, BUSY waits and time
+**       on air. Goodput counts message bytes, before compression, in
+**       packets that completed within the duration and weren't lost.
+**       Utilization is the airtime of completed packets over the duration.
+**       CPU time is the driver thread's CPU time per packet sent.
+**    5. Results are written to stdout, one JSON object per sweep point, so
+**       runs can be compared across releases. Progress is written to
+**       stderr.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "radio_sim.h"
+#include "tx_fec.h"
+#include "tx_frame.h"
+#include "tx_hdrc.h"
+#include "tx_lz.h"
+#include "tx_ring.h"
+#include "tx_sched.h"
+#include "tx_toa.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define BENCH_VERSION         1
+
+#define BENCH_MAX_LIST        8        /* Values per SF/BW/CR list       */
+#define BENCH_MAX_WORKLOADS   8
+#define BENCH_LATENCY_MAX     (1 << 18)  /* Latency samples per sweep point */
+#define BENCH_FRAME_MSG_MAX   (RADIO_TX_MAX_PAYLOAD_LEN / 2)
+
+#define BENCH_APID_CNT        4
+#define BENCH_TLM_CLASS       1        /* Default TLM_FWD_TOPICIDS class */
+#define BENCH_FILE_CLASS      2        /* Default FILE_XFER_CLASS        */
+
+#define BENCH_FILE_PATTERN_LEN  4096   /* Synthetic file data period */
+
+#define WORKLOAD_FIXED    0
+#define WORKLOAD_UNIFORM  1
+#define WORKLOAD_FILE     2
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef struct
+{
+   
+   uint8_t   Type;
+   uint16_t  MinLen;       /* Telemetry message lengths */
+   uint16_t  MaxLen;
+   uint8_t   FecK;         /* File FEC, zero disables */
+   uint8_t   FecM;
+   char      Name[32];
+   
+} Workload_t;
+
+
+typedef struct
+{
+   
+   uint8_t   SfCnt;
+   uint8_t   Sf[BENCH_MAX_LIST];      /* 5..12 */
+   uint8_t   BwCnt;
+   uint16_t  Bw[BENCH_MAX_LIST];      /* kHz */
+   uint8_t   CrCnt;
+   uint8_t   Cr[BENCH_MAX_LIST];      /* Register codes */
+   uint8_t   WorkloadCnt;
+   Workload_t Workload[BENCH_MAX_WORKLOADS];
+   
+   uint32_t  DurationMs;
+   uint32_t  LoadPct;
+   uint32_t  FlushMs;
+   uint32_t  QueueMs;
+   uint16_t  HdrRefresh;
+   uint32_t  BusyUs;
+   uint8_t   LossPct;
+   uint32_t  Seed;
+   
+} Config_t;
+
+
+/*
+** Messages carried by a queued or in flight packet
+*/
+typedef struct
+{
+   
+   uint16_t  MsgCnt;
+   uint32_t  Bytes;        /* Message bytes before compression */
+   uint32_t  Airtime;      /* us */
+   uint64_t  ArrivalNs[BENCH_FRAME_MSG_MAX];
+   
+} PktInfo_t;
+
+
+typedef struct
+{
+   
+   /*
+   ** Pipeline
+   */
+   
+   TX_TOA_Class_t    Toa;
+   TX_HDRC_Class_t   Hdrc;
+   TX_FRAME_Class_t  Frame;
+   TX_LZ_Class_t     Lz;
+   TX_FEC_Class_t    Fec;
+   TX_SCHED_Class_t  Sched;
+   TX_RING_Class_t   TxRing[TX_SCHED_CLASS_CNT];
+   RADIO_SIM_Class_t RadioSim;
+   
+   PktInfo_t  RingInfo[TX_SCHED_CLASS_CNT][TX_RING_DEPTH];
+   PktInfo_t  FrameInfo;
+   PktInfo_t  TxInfo;
+   
+   uint16_t   SeqCnt[BENCH_APID_CNT];
+   uint8_t    Msg[RADIO_TX_MAX_PAYLOAD_LEN + TX_HDRC_HDR_LEN];
+   uint8_t    Pkt[RADIO_TX_MAX_PAYLOAD_LEN];
+   
+   uint8_t    FileData[BENCH_FILE_PATTERN_LEN];
+   uint32_t   FileOffset;
+   uint8_t    LzIn[TX_LZ_WINDOW_LEN];
+   uint16_t   LzInLen;
+   uint16_t   FecDataMax;
+   
+   uint32_t   Rand;
+   
+   /*
+   ** TxDone from the simulator's thread
+   */
+   
+   pthread_mutex_t Mutex;
+   pthread_cond_t  Cond;
+   bool       TxActive;
+   bool       TxDone;
+   bool       TxLost;
+   uint64_t   TxDoneNs;
+   uint32_t   LostCnt;
+   
+   /*
+   ** Results
+   */
+   
+   uint32_t   MsgOffered;
+   uint32_t   MsgSent;
+   uint32_t   MsgDropped;
+   uint32_t   PktSent;
+   uint32_t   PktLost;
+   uint64_t   Bytes;
+   uint64_t   AirtimeUs;
+   uint32_t   LatencyCnt;
+   uint32_t   Latency[BENCH_LATENCY_MAX];   /* us */
+   
+} Bench_t;
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static Bench_t Bench;
+
+/* SX128x LoRa bandwidth register codes */
+static const uint16_t BwKhz[]  = { 1600, 800, 400, 200 };
+static const uint8_t  BwCode[] = { 0x0A, 0x18, 0x26, 0x34 };
+
+static const char *CrName[] = { "", "4/5", "4/6", "4/7", "4/8", "4/5LI", "4/6LI", "4/8LI" };
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static bool ParseArgs(int argc, char *argv[], Config_t *Config);
+static uint8_t ParseList(const char *Str, uint32_t *Value, uint32_t Min, uint32_t Max);
+static bool ParseWorkload(const char *Str, Workload_t *Workload);
+static void Usage(const char *Name);
+static bool RunPoint(const Config_t *Config, uint8_t Sf, uint16_t Bw, uint8_t Cr,
+                     const Workload_t *Workload);
+static uint64_t ArrivalPeriodNs(const Config_t *Config, const Workload_t *Workload);
+static void Produce(const Workload_t *Workload, uint64_t ArrivalNs);
+static void ProduceMsg(const Workload_t *Workload, uint64_t ArrivalNs);
+static uint16_t PackMsg(uint16_t MsgLen, uint64_t ArrivalNs);
+static void ProduceFilePkt(uint64_t ArrivalNs);
+static uint16_t CompressFileBlock(uint8_t *Buf, uint16_t Len, uint32_t *InUsed);
+static void FlushFrame(void);
+static void Enqueue(uint8_t Class, const uint8_t *Pkt, uint16_t PktLen, const PktInfo_t *Info);
+static void QueueSlot(uint8_t Class, uint16_t PktLen, const PktInfo_t *Info);
+static void StartTx(void);
+static void CompleteTx(void);
+static void TxDoneCallback(uint8_t Radio, bool TxTimeout);
+static void Report(const Config_t *Config, uint8_t Sf, uint16_t Bw, uint8_t Cr,
+                   const Workload_t *Workload, uint64_t ElapsedNs, uint64_t CpuNs);
+static int  CompareU32(const void *A, const void *B);
+static uint32_t Random(void);
+static uint64_t GetTimeNs(clockid_t Clock);
+
+
+/******************************************************************************
+** Function: main
+**
+*/
+int main(int argc, char *argv[])
+{
+   
+   static Config_t Config;
+   uint8_t s, b, c, w;
+   
+   if (!ParseArgs(argc, argv, &Config))
+   {
+      Usage(argv[0]);
+      return 1;
+   }
+   
+   for (w = 0; w < Config.WorkloadCnt; w++)
+   {
+      for (s = 0; s < Config.SfCnt; s++)
+      {
+         for (b = 0; b < Config.BwCnt; b++)
+         {
+            for (c = 0; c < Config.CrCnt; c++)
+            {
+               if (!RunPoint(&Config, Config.Sf[s], Config.Bw[b], Config.Cr[c], &Config.Workload[w]))
+               {
+                  return 1;
+               }
+            }
+         }
+      }
+   }
+   
+   return 0;
+   
+} /* End main() */
+
+
+/******************************************************************************
+** Function: ParseArgs
+**
+*/
+static bool ParseArgs(int argc, char *argv[], Config_t *Config)
+{
+   
+   uint32_t Value[BENCH_MAX_LIST];
+   uint8_t  i;
+   int      Opt;
+   
+   memset(Config, 0, sizeof(Config_t));
+   
+   Config->DurationMs = 2000;
+   Config->LoadPct    = 90;
+   Config->FlushMs    = 250;
+   Config->QueueMs    = 2000;
+   Config->HdrRefresh = 16;
+   Config->BusyUs     = 50;
+   Config->Seed       = 1;
+   
+   Config->SfCnt = ParseList("5,7,9", Value, 5, 12);
+   for (i = 0; i < Config->SfCnt; i++) Config->Sf[i] = Value[i];
+   Config->BwCnt = ParseList("1600,400", Value, 200, 1600);
+   for (i = 0; i < Config->BwCnt; i++) Config->Bw[i] = Value[i];
+   Config->CrCnt = ParseList("1,4", Value, 1, 7);
+   for (i = 0; i < Config->CrCnt; i++) Config->Cr[i] = Value[i];
+   
+   while ((Opt = getopt(argc, argv, "s:b:c:w:d:l:f:q:H:u:p:S:h")) != -1)
+   {
+      switch (Opt)
+      {
+         case 's':
+            Config->SfCnt = ParseList(optarg, Value, 5, 12);
+            for (i = 0; i < Config->SfCnt; i++) Config->Sf[i] = Value[i];
+            if (Config->SfCnt == 0) return false;
+            break;
+         case 'b':
+            Config->BwCnt = ParseList(optarg, Value, 200, 1600);
+            for (i = 0; i < Config->BwCnt; i++)
+            {
+               Config->Bw[i] = Value[i];
+               if (Value[i] != 1600 && Value[i] != 800 && Value[i] != 400 && Value[i] != 200) return false;
+            }
+            if (Config->BwCnt == 0) return false;
+            break;
+         case 'c':
+            Config->CrCnt = ParseList(optarg, Value, 1, 7);
+            for (i = 0; i < Config->CrCnt; i++) Config->Cr[i] = Value[i];
+            if (Config->CrCnt == 0) return false;
+            break;
+         case 'w':
+            if (Config->WorkloadCnt >= BENCH_MAX_WORKLOADS ||
+                !ParseWorkload(optarg, &Config->Workload[Config->WorkloadCnt])) return false;
+            Config->WorkloadCnt++;
+            break;
+         case 'd':
+            Config->DurationMs = strtoul(optarg, NULL, 0);
+            break;
+         case 'l':
+            Config->LoadPct = strtoul(optarg, NULL, 0);
+            break;
+         case 'f':
+            Config->FlushMs = strtoul(optarg, NULL, 0);
+            break;
+         case 'q':
+            Config->QueueMs = strtoul(optarg, NULL, 0);
+            break;
+         case 'H':
+            Config->HdrRefresh = strtoul(optarg, NULL, 0);
+            break;
+         case 'u':
+            Config->BusyUs = strtoul(optarg, NULL, 0);
+            break;
+         case 'p':
+            Config->LossPct = strtoul(optarg, NULL, 0);
+            break;
+         case 'S':
+            Config->Seed = strtoul(optarg, NULL, 0);
+            break;
+         default:
+            return false;
+      }
+   }
+   
+   if (Config->WorkloadCnt == 0)
+   {
+      ParseWorkload("fixed:16",      &Config->Workload[0]);
+      ParseWorkload("fixed:64",      &Config->Workload[1]);
+      ParseWorkload("uniform:16-240",&Config->Workload[2]);
+      ParseWorkload("file:16:4",     &Config->Workload[3]);
+      Config->WorkloadCnt = 4;
+   }
+   
+   return (optind == argc && Config->DurationMs > 0 && Config->LoadPct > 0 && Config->LossPct <= 100);
+   
+} /* End ParseArgs() */
+
+
+/******************************************************************************
+** Function: ParseList
+**
+** Parse a comma separated list of values and return the value count
+**
+** Notes:
+**   1. Returns zero if a value is malformed or out of range.
+**
+*/
+static uint8_t ParseList(const char *Str, uint32_t *Value, uint32_t Min, uint32_t Max)
+{
+   
+   uint8_t  Cnt = 0;
+   char    *End;
+   
+   while (*Str != '\0' && Cnt < BENCH_MAX_LIST)
+   {
+      Value[Cnt] = strtoul(Str, &End, 0);
+      if (End == Str || Value[Cnt] < Min || Value[Cnt] > Max || (*End != ',' && *End != '\0'))
+      {
+         return 0;
+      }
+      Cnt++;
+      Str = (*End == ',') ? End + 1 : End;
+   }
+   
+   return (*Str == '\0') ? Cnt : 0;
+   
+} /* End ParseList() */
+
+
+/******************************************************************************
+** Function: ParseWorkload
+**
+** Parse fixed:Len, uniform:MinLen-MaxLen or file:K:M
+**
+*/
+static bool ParseWorkload(const char *Str, Workload_t *Workload)
+{
+   
+   unsigned A, B;
+   char     End;
+   bool     RetStatus = false;
+   
+   memset(Workload, 0, sizeof(Workload_t));
+   snprintf(Workload->Name, sizeof(Workload->Name), "%s", Str);
+   
+   if (sscanf(Str, "fixed:%u%c", &A, &End) == 1)
+   {
+      Workload->Type   = WORKLOAD_FIXED;
+      Workload->MinLen = A;
+      Workload->MaxLen = A;
+   }
+   else if (sscanf(Str, "uniform:%u-%u%c", &A, &B, &End) == 2)
+   {
+      Workload->Type   = WORKLOAD_UNIFORM;
+      Workload->MinLen = A;
+      Workload->MaxLen = B;
+   }
+   else if (sscanf(Str, "file:%u:%u%c", &A, &B, &End) == 2)
+   {
+      Workload->Type = WORKLOAD_FILE;
+      Workload->FecK = (A <= TX_FEC_MAX_DATA) ? A : 0;
+      Workload->FecM = (B <= TX_FEC_MAX_PARITY) ? B : 0;
+      return (A == 0 || (A == Workload->FecK && B > 0 && B == Workload->FecM));
+   }
+   else
+   {
+      return false;
+   }
+   
+   RetStatus = (Workload->MinLen >= TX_HDRC_HDR_LEN && Workload->MinLen <= Workload->MaxLen &&
+                Workload->MaxLen <= TX_FRAME_MAX_MSG_LEN);
+   
+   return RetStatus;
+   
+} /* End ParseWorkload() */
+
+
+/******************************************************************************
+** Function: Usage
+**
+*/
+static void Usage(const char *Name)
+{
+   
+   fprintf(stderr,
+           "Usage: %s [options]\n"
+           "  -s SF,...       Spreading factors 5..12 (5,7,9)\n"
+           "  -b kHz,...      Bandwidths 1600, 800, 400, 200 (1600,400)\n"
+           "  -c CR,...       Coding rate register codes 1..7 (1,4)\n"
+           "  -w Workload     fixed:Len, uniform:MinLen-MaxLen or file:K:M, repeatable\n"
+           "                  (fixed:16 fixed:64 uniform:16-240 file:16:4)\n"
+           "  -d ms           Duration per sweep point (2000)\n"
+           "  -l percent      Offered load relative to the estimated link capacity (90)\n"
+           "  -f ms           Telemetry frame flush time, TLM_FWD_FLUSH_MS (250)\n"
+           "  -q ms           Queued airtime limit, TX_QUEUE_AIRTIME_MS (2000)\n"
+           "  -H count        Header compression refresh, 0 disables (16)\n"
+           "  -u us           Simulated BUSY time per command (50)\n"
+           "  -p percent      Simulated packet loss (0)\n"
+           "  -S seed         Random seed (1)\n"
+           "Message lengths include the %d byte telemetry header and are limited to %d bytes.\n",
+           Name, TX_HDRC_HDR_LEN, TX_FRAME_MAX_MSG_LEN);
+   
+} /* End Usage() */
+
+
+/******************************************************************************
+** Function: RunPoint
+**
+** Run one sweep point and report its results
+**
+*/
+static bool RunPoint(const Config_t *Config, uint8_t Sf, uint16_t Bw, uint8_t Cr,
+                     const Workload_t *Workload)
+{
+   
+   static const uint32_t Weight[TX_SCHED_CLASS_CNT] = {0};
+   RADIO_SIM_Config_t  SimConfig;
+   pthread_condattr_t  CondAttr;
+   struct timespec     Timeout;
+   uint8_t  BwReg = 0;
+   uint32_t i;
+   uint64_t StartNs, EndNs, NowNs, WakeNs, FlushNs;
+   uint64_t StartCpuNs;
+   uint64_t PeriodNs, NextArrivalNs;
+   
+   for (i = 0; i < sizeof(BwKhz)/sizeof(BwKhz[0]); i++)
+   {
+      if (BwKhz[i] == Bw) BwReg = BwCode[i];
+   }
+   
+   memset(&Bench, 0, sizeof(Bench_t));
+   Bench.Rand = (Config->Seed != 0) ? Config->Seed : 1;
+   pthread_mutex_init(&Bench.Mutex, NULL);
+   pthread_condattr_init(&CondAttr);
+   pthread_condattr_setclock(&CondAttr, CLOCK_MONOTONIC);
+   pthread_cond_init(&Bench.Cond, &CondAttr);
+   pthread_condattr_destroy(&CondAttr);
+   
+   TX_TOA_Constructor(&Bench.Toa, true);
+   if (!TX_TOA_SetActive(&Bench.Toa, Sf << 4, BwReg, Cr, RADIO_TX_PREAMBLE_LEN))
+   {
+      fprintf(stderr, "Invalid LoRa parameters SF%d, %d kHz, CR %d\n", Sf, Bw, Cr);
+      return false;
+   }
+   TX_HDRC_Constructor(&Bench.Hdrc, Config->HdrRefresh);
+   TX_FRAME_Constructor(&Bench.Frame, (Config->HdrRefresh > 0) ? TX_FRAME_TYPE_SB_MSG_HC : TX_FRAME_TYPE_SB_MSG,
+                        RADIO_TX_MAX_PAYLOAD_LEN);
+   TX_LZ_Constructor(&Bench.Lz);
+   Bench.FecDataMax = RADIO_TX_MAX_PAYLOAD_LEN;
+   if (Workload->FecK > 0)
+   {
+      TX_FEC_Constructor(&Bench.Fec, Workload->FecK, Workload->FecM, RADIO_TX_MAX_PAYLOAD_LEN);
+      Bench.FecDataMax = Bench.Fec.DataMax;
+   }
+   TX_SCHED_Constructor(&Bench.Sched, Weight);
+   for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
+   {
+      TX_RING_Constructor(&Bench.TxRing[i], Config->QueueMs * 1000);
+   }
+   
+   /* Log-like file data: a fixed record text followed by random bytes */
+   for (i = 0; i < BENCH_FILE_PATTERN_LEN; i++)
+   {
+      Bench.FileData[i] = ((i % 32) < 24) ? (uint8_t)"TEMP=+021.5C VOLT=03.30V"[i % 32] : (uint8_t)Random();
+   }
+   
+   SimConfig.Radio      = 0;
+   SimConfig.BusyUs     = Config->BusyUs;
+   SimConfig.LossPct    = Config->LossPct;
+   SimConfig.Seed       = Config->Seed;
+   SimConfig.OutputPath = NULL;
+   if (!RADIO_SIM_Constructor(&Bench.RadioSim, &SimConfig, TxDoneCallback))
+   {
+      fprintf(stderr, "Failed to start the simulated radio\n");
+      return false;
+   }
+   RADIO_SIM_SetModulation(&Bench.RadioSim, Sf << 4, BwReg, Cr);
+   
+   fprintf(stderr, "SF%-2d %4d kHz CR %-5s %-16s ", Sf, Bw, CrName[Cr], Workload->Name);
+   
+   PeriodNs      = ArrivalPeriodNs(Config, Workload);
+   StartNs       = GetTimeNs(CLOCK_MONOTONIC);
+   StartCpuNs    = GetTimeNs(CLOCK_THREAD_CPUTIME_ID);
+   EndNs         = StartNs + (uint64_t)Config->DurationMs * 1000000;
+   NextArrivalNs = StartNs;
+   
+   pthread_mutex_lock(&Bench.Mutex);
+   while ((NowNs = GetTimeNs(CLOCK_MONOTONIC)) < EndNs)
+   {
+   
+      if (Bench.TxDone)
+      {
+         pthread_mutex_unlock(&Bench.Mutex);
+         CompleteTx();
+         pthread_mutex_lock(&Bench.Mutex);
+      }
+   
+      pthread_mutex_unlock(&Bench.Mutex);
+      while (NextArrivalNs <= NowNs)
+      {
+         Produce(Workload, NextArrivalNs);
+         NextArrivalNs += (uint64_t)(-log(((Random() >> 8) + 1) / 16777216.0) * PeriodNs);
+      }
+      if (TX_FRAME_Expired(&Bench.Frame, (uint32_t)(NowNs / 1000000), Config->FlushMs))
+      {
+         FlushFrame();
+      }
+      if (!Bench.TxActive)
+      {
+         StartTx();
+      }
+      pthread_mutex_lock(&Bench.Mutex);
+   
+      WakeNs = (NextArrivalNs < EndNs) ? NextArrivalNs : EndNs;
+      if (TX_FRAME_IsOpen(&Bench.Frame))
+      {
+         FlushNs = ((uint64_t)Bench.Frame.OpenTime + Config->FlushMs + 1) * 1000000;
+         if (FlushNs < WakeNs) WakeNs = FlushNs;
+      }
+      Timeout.tv_sec  = WakeNs / 1000000000;
+      Timeout.tv_nsec = WakeNs % 1000000000;
+      while (!Bench.TxDone && GetTimeNs(CLOCK_MONOTONIC) < WakeNs)
+      {
+         pthread_cond_timedwait(&Bench.Cond, &Bench.Mutex, &Timeout);
+      }
+   
+   }
+   pthread_mutex_unlock(&Bench.Mutex);
+   if (Bench.TxDone)
+   {
+      CompleteTx();
+   }
+   
+   Report(Config, Sf, Bw, Cr, Workload, EndNs - StartNs, GetTimeNs(CLOCK_THREAD_CPUTIME_ID) - StartCpuNs);
+   
+   RADIO_SIM_Destructor(&Bench.RadioSim);
+   pthread_cond_destroy(&Bench.Cond);
+   pthread_mutex_destroy(&Bench.Mutex);
+   
+   return true;
+   
+} /* End RunPoint() */
+
+
+/******************************************************************************
+** Function: ArrivalPeriodNs
+**
+** Return the mean time between arrivals for the offered load
+**
+** Notes:
+**   1. Capacity is estimated from uncompressed messages in full frames, or
+**      full file packets including parity, so compression and FEC savings
+**      show up as goodput above the offered load.
+**
+*/
+static uint64_t ArrivalPeriodNs(const Config_t *Config, const Workload_t *Workload)
+{
+   
+   uint32_t MsgLen, MsgsPerPkt;
+   uint64_t PktNs;
+   
+   if (Workload->Type == WORKLOAD_FILE)
+   {
+      MsgsPerPkt = 1;
+      PktNs = (uint64_t)TX_TOA_Get(&Bench.Toa, RADIO_TX_MAX_PAYLOAD_LEN) * 1000;
+   }
+   else
+   {
+      MsgLen = TX_FRAME_MSG_HDR_LEN + (Workload->MinLen + Workload->MaxLen) / 2;
+      MsgsPerPkt = (RADIO_TX_MAX_PAYLOAD_LEN - TX_FRAME_HDR_LEN) / MsgLen;
+      PktNs = (uint64_t)TX_TOA_Get(&Bench.Toa, TX_FRAME_HDR_LEN + MsgsPerPkt * MsgLen) * 1000;
+   }
+   
+   return PktNs * 100 / ((uint64_t)MsgsPerPkt * Config->LoadPct);
+   
+} /* End ArrivalPeriodNs() */
+
+
+/******************************************************************************
+** Function: Produce
+**
+*/
+static void Produce(const Workload_t *Workload, uint64_t ArrivalNs)
+{
+   
+   if (Workload->Type == WORKLOAD_FILE)
+   {
+      ProduceFilePkt(ArrivalNs);
+   }
+   else
+   {
+      ProduceMsg(Workload, ArrivalNs);
+   }
+   
+} /* End Produce() */
+
+
+/******************************************************************************
+** Function: ProduceMsg
+**
+** Create a telemetry message and add it to the open frame like TLM_FWD
+**
+*/
+static void ProduceMsg(const Workload_t *Workload, uint64_t ArrivalNs)
+{
+   
+   uint16_t MsgLen = Workload->MinLen;
+   uint16_t Apid   = Bench.MsgOffered % BENCH_APID_CNT;
+   uint16_t Seq    = Bench.SeqCnt[Apid]++ & 0x3FFF;
+   uint32_t Secs   = (uint32_t)(ArrivalNs / 1000000000);
+   uint16_t Subs   = (uint16_t)((ArrivalNs % 1000000000) * 65536 / 1000000000);
+   uint16_t EntryLen;
+   uint16_t i;
+   
+   if (Workload->Type == WORKLOAD_UNIFORM)
+   {
+      MsgLen += Random() % (Workload->MaxLen - Workload->MinLen + 1);
+   }
+   Bench.MsgOffered++;
+   
+   Bench.Msg[0]  = 0x08 | (uint8_t)(Apid >> 8);
+   Bench.Msg[1]  = (uint8_t)Apid;
+   Bench.Msg[2]  = 0xC0 | (uint8_t)(Seq >> 8);
+   Bench.Msg[3]  = (uint8_t)Seq;
+   Bench.Msg[4]  = (uint8_t)((MsgLen - 7) >> 8);
+   Bench.Msg[5]  = (uint8_t)(MsgLen - 7);
+   Bench.Msg[6]  = (uint8_t)(Secs >> 24);
+   Bench.Msg[7]  = (uint8_t)(Secs >> 16);
+   Bench.Msg[8]  = (uint8_t)(Secs >> 8);
+   Bench.Msg[9]  = (uint8_t)Secs;
+   Bench.Msg[10] = (uint8_t)(Subs >> 8);
+   Bench.Msg[11] = (uint8_t)Subs;
+   for (i = TX_HDRC_HDR_LEN; i < MsgLen; i++)
+   {
+      Bench.Msg[i] = (uint8_t)(i + Seq);
+   }
+   
+   EntryLen = PackMsg(MsgLen, ArrivalNs);
+   if (EntryLen == 0 && Bench.Frame.MsgCnt > 0)
+   {
+      FlushFrame();
+      EntryLen = PackMsg(MsgLen, ArrivalNs);
+   }
+   
+   if (EntryLen > 0)
+   {
+      Bench.FrameInfo.ArrivalNs[Bench.FrameInfo.MsgCnt++] = ArrivalNs;
+      Bench.FrameInfo.Bytes += MsgLen;
+   }
+   else
+   {
+      Bench.MsgDropped++;
+   }
+   
+} /* End ProduceMsg() */
+
+
+/******************************************************************************
+** Function: PackMsg
+**
+** Write the message into the open frame like TLM_FWD, opening a frame in
+** the telemetry ring's producer slot if needed
+**
+** Notes:
+**   1. Returns zero if the message doesn't fit or the ring is full.
+**
+*/
+static uint16_t PackMsg(uint16_t MsgLen, uint64_t ArrivalNs)
+{
+   
+   TX_RING_Slot_t *Slot;
+   uint16_t EntryLen = 0;
+   
+   if (!TX_FRAME_IsOpen(&Bench.Frame))
+   {
+      Slot = TX_RING_ProducerSlot(&Bench.TxRing[BENCH_TLM_CLASS]);
+      if (Slot == NULL)
+      {
+         return 0;
+      }
+      TX_FRAME_Open(&Bench.Frame, Slot->Data, (uint32_t)(ArrivalNs / 1000000));
+   }
+   
+   if (Bench.Frame.Type == TX_FRAME_TYPE_SB_MSG_HC)
+   {
+      EntryLen = TX_HDRC_Compress(&Bench.Hdrc, Bench.Msg, MsgLen, 
+                                  TX_FRAME_MsgBuf(&Bench.Frame), TX_FRAME_MsgSpace(&Bench.Frame));
+   }
+   else if (MsgLen <= TX_FRAME_MsgSpace(&Bench.Frame))
+   {
+      memcpy(TX_FRAME_MsgBuf(&Bench.Frame), Bench.Msg, MsgLen);
+      EntryLen = MsgLen;
+   }
+   
+   if (EntryLen > 0)
+   {
+      TX_FRAME_CommitMsg(&Bench.Frame, EntryLen);
+   }
+   
+   return EntryLen;
+   
+} /* End PackMsg() */
+
+
+/******************************************************************************
+** Function: ProduceFilePkt
+**
+** Create the next file transfer packet like RADIO_IF's FillFileBlock()
+**
+*/
+static void ProduceFilePkt(uint64_t ArrivalNs)
+{
+   
+   PktInfo_t Info;
+   uint32_t  InUsed;
+   uint16_t  PktLen;
+   
+   Info.MsgCnt       = 0;
+   Info.Bytes        = 0;
+   Info.ArrivalNs[0] = ArrivalNs;
+   
+   if (Bench.Fec.K == 0)
+   {
+      PktLen = CompressFileBlock(Bench.Pkt, Bench.FecDataMax, &InUsed);
+   }
+   else if (Bench.Fec.ParityPending)
+   {
+      PktLen = TX_FEC_NextParity(&Bench.Fec, Bench.Pkt);
+      InUsed = 0;
+   }
+   else
+   {
+      PktLen = CompressFileBlock(&Bench.Pkt[TX_FEC_HDR_LEN], Bench.FecDataMax, &InUsed);
+      PktLen = TX_FEC_EncodeData(&Bench.Fec, Bench.Pkt, PktLen);
+   }
+   
+   if (InUsed > 0)
+   {
+      Info.MsgCnt       = 1;
+      Info.Bytes        = InUsed;
+      Bench.MsgOffered++;
+   }
+   
+   Enqueue(BENCH_FILE_CLASS, Bench.Pkt, PktLen, &Info);
+   
+} /* End ProduceFilePkt() */
+
+
+/******************************************************************************
+** Function: CompressFileBlock
+**
+** Top off the compression window from the synthetic file and compress as
+** much of it as fits in a Len byte block
+**
+*/
+static uint16_t CompressFileBlock(uint8_t *Buf, uint16_t Len, uint32_t *InUsed)
+{
+   
+   uint16_t BlockLen;
+   uint16_t Used;
+   
+   while (Bench.LzInLen < TX_LZ_WINDOW_LEN)
+   {
+      Bench.LzIn[Bench.LzInLen++] = Bench.FileData[Bench.FileOffset++ % BENCH_FILE_PATTERN_LEN];
+   }
+   
+   BlockLen = TX_LZ_CompressBlock(&Bench.Lz, Bench.LzIn, Bench.LzInLen, Buf, Len, &Used);
+   
+   Bench.LzInLen -= Used;
+   memmove(Bench.LzIn, &Bench.LzIn[Used], Bench.LzInLen);
+   *InUsed = Used;
+   
+   return BlockLen;
+   
+} /* End CompressFileBlock() */
+
+
+/******************************************************************************
+** Function: FlushFrame
+**
+*/
+static void FlushFrame(void)
+{
+   
+   if (TX_FRAME_IsOpen(&Bench.Frame) && Bench.Frame.MsgCnt > 0)
+   {
+      QueueSlot(BENCH_TLM_CLASS, Bench.Frame.Len, &Bench.FrameInfo);
+      TX_FRAME_Close(&Bench.Frame);
+   }
+   Bench.FrameInfo.MsgCnt = 0;
+   Bench.FrameInfo.Bytes  = 0;
+   
+} /* End FlushFrame() */
+
+
+/******************************************************************************
+** Function: Enqueue
+**
+** Copy a packet into a ring's producer slot and queue it
+**
+*/
+static void Enqueue(uint8_t Class, const uint8_t *Pkt, uint16_t PktLen, const PktInfo_t *Info)
+{
+   
+   TX_RING_Slot_t *Slot = TX_RING_ProducerSlot(&Bench.TxRing[Class]);
+   
+   if (Slot != NULL)
+   {
+      memcpy(Slot->Data, Pkt, PktLen);
+      QueueSlot(Class, PktLen, Info);
+   }
+   else
+   {
+      Bench.MsgDropped += Info->MsgCnt;
+   }
+   
+} /* End Enqueue() */
+
+
+/******************************************************************************
+** Function: QueueSlot
+**
+** Queue the packet built in a ring's producer slot like RADIO_IF's
+** RADIO_IF_QueuePayload()
+**
+*/
+static void QueueSlot(uint8_t Class, uint16_t PktLen, const PktInfo_t *Info)
+{
+   
+   TX_RING_Class_t *TxRing = &Bench.TxRing[Class];
+   TX_RING_Slot_t  *Slot   = TX_RING_ProducerSlot(TxRing);
+   PktInfo_t *RingInfo = &Bench.RingInfo[Class][TX_RING_INDEX(TxRing->Head)];
+   
+   if (Slot != NULL)
+   {
+      Slot->Len        = PktLen;
+      Slot->Airtime    = TX_TOA_Get(&Bench.Toa, PktLen);
+      Slot->EnqueueMs  = (uint32_t)(Info->ArrivalNs[0] / 1000000);
+      Slot->DeadlineMs = 0;
+      RingInfo->MsgCnt  = Info->MsgCnt;
+      RingInfo->Bytes   = Info->Bytes;
+      RingInfo->Airtime = Slot->Airtime;
+      memcpy(RingInfo->ArrivalNs, Info->ArrivalNs, Info->MsgCnt * sizeof(uint64_t));
+      TX_RING_Produce(TxRing);
+   }
+   else
+   {
+      Bench.MsgDropped += Info->MsgCnt;
+   }
+   
+} /* End QueueSlot() */
+
+
+/******************************************************************************
+** Function: StartTx
+**
+** Select the next packet like RADIO_IF and start transmitting it
+**
+*/
+static void StartTx(void)
+{
+   
+   const TX_RING_Slot_t *Slot;
+   uint8_t Backlog = 0;
+   uint8_t Class;
+   
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      if (TX_RING_ConsumerSlot(&Bench.TxRing[Class]) != NULL)
+      {
+         Backlog |= (1 << Class);
+      }
+   }
+   
+   Class = TX_SCHED_Select(&Bench.Sched, Backlog);
+   if (Class != TX_SCHED_NONE)
+   {
+   
+      Slot = TX_RING_ConsumerSlot(&Bench.TxRing[Class]);
+      Bench.TxInfo = Bench.RingInfo[Class][TX_RING_INDEX(Bench.TxRing[Class].Tail)];
+      TX_SCHED_Charge(&Bench.Sched, Class, Slot->Airtime);
+   
+      RADIO_SIM_WriteBuffer(&Bench.RadioSim, 0, Slot->Data, Slot->Len);
+      RADIO_SIM_SetPayloadLen(&Bench.RadioSim, Slot->Len);
+      TX_RING_Consume(&Bench.TxRing[Class]);
+   
+      Bench.TxActive = RADIO_SIM_SetTx(&Bench.RadioSim);
+      if (!Bench.TxActive)
+      {
+         Bench.MsgDropped += Bench.TxInfo.MsgCnt;
+      }
+   }
+   
+} /* End StartTx() */
+
+
+/******************************************************************************
+** Function: CompleteTx
+**
+** Account for the in flight packet after its TxDone
+**
+*/
+static void CompleteTx(void)
+{
+   
+   uint16_t i;
+   
+   Bench.TxActive = false;
+   Bench.TxDone   = false;
+   Bench.PktSent++;
+   Bench.AirtimeUs += Bench.TxInfo.Airtime;
+   
+   if (Bench.TxLost)
+   {
+      Bench.PktLost++;
+      Bench.MsgDropped += Bench.TxInfo.MsgCnt;
+      return;
+   }
+   
+   Bench.MsgSent += Bench.TxInfo.MsgCnt;
+   Bench.Bytes   += Bench.TxInfo.Bytes;
+   for (i = 0; i < Bench.TxInfo.MsgCnt && Bench.LatencyCnt < BENCH_LATENCY_MAX; i++)
+   {
+      Bench.Latency[Bench.LatencyCnt++] = (uint32_t)((Bench.TxDoneNs - Bench.TxInfo.ArrivalNs[i]) / 1000);
+   }
+   
+} /* End CompleteTx() */
+
+
+/******************************************************************************
+** Function: TxDoneCallback
+**
+** Called from the simulator's transmission thread
+**
+*/
+static void TxDoneCallback(uint8_t Radio, bool TxTimeout)
+{
+   
+   pthread_mutex_lock(&Bench.Mutex);
+   
+   Bench.TxDoneNs = GetTimeNs(CLOCK_MONOTONIC);
+   Bench.TxLost   = (Bench.RadioSim.LostCnt != Bench.LostCnt);
+   Bench.LostCnt  = Bench.RadioSim.LostCnt;
+   Bench.TxDone   = true;
+   pthread_cond_signal(&Bench.Cond);
+   
+   pthread_mutex_unlock(&Bench.Mutex);
+   
+} /* End TxDoneCallback() */
+
+
+/******************************************************************************
+** Function: Report
+**
+** Write a sweep point's results as a JSON object on one line
+**
+*/
+static void Report(const Config_t *Config, uint8_t Sf, uint16_t Bw, uint8_t Cr,
+                   const Workload_t *Workload, uint64_t ElapsedNs, uint64_t CpuNs)
+{
+   
+   uint32_t P50 = 0, P99 = 0, Max = 0;
+   double   Seconds = ElapsedNs / 1e9;
+   double   GoodputBps = Bench.Bytes * 8 / Seconds;
+   double   UtilPct    = Bench.AirtimeUs / (ElapsedNs / 1e3) * 100;
+   
+   if (Bench.LatencyCnt > 0)
+   {
+      qsort(Bench.Latency, Bench.LatencyCnt, sizeof(uint32_t), CompareU32);
+      P50 = Bench.Latency[(Bench.LatencyCnt - 1) * 50 / 100];
+      P99 = Bench.Latency[(uint32_t)(((uint64_t)Bench.LatencyCnt - 1) * 99 / 100)];
+      Max = Bench.Latency[Bench.LatencyCnt - 1];
+   }
+   
+   printf("{\"bench\":\"lora_tx\",\"version\":%d,\"sf\":%d,\"bw_khz\":%d,\"cr\":\"%s\","
+          "\"workload\":\"%s\",\"load_pct\":%u,\"duration_ms\":%u,\"hdr_refresh\":%u,"
+          "\"busy_us\":%u,\"loss_pct\":%u,"
+          "\"msgs_offered\":%u,\"msgs_sent\":%u,\"msgs_dropped\":%u,"
+          "\"pkts_sent\":%u,\"pkts_lost\":%u,\"goodput_bps\":%.0f,\"utilization_pct\":%.1f,"
+          "\"latency_p50_us\":%u,\"latency_p99_us\":%u,\"latency_max_us\":%u,"
+          "\"cpu_us_per_pkt\":%.2f}\n",
+          BENCH_VERSION, Sf, Bw, CrName[Cr], Workload->Name, Config->LoadPct, Config->DurationMs,
+          Config->HdrRefresh, Config->BusyUs, Config->LossPct,
+          Bench.MsgOffered, Bench.MsgSent, Bench.MsgDropped, Bench.PktSent, Bench.PktLost,
+          GoodputBps, UtilPct, P50, P99, Max,
+          (Bench.PktSent > 0) ? CpuNs / 1e3 / Bench.PktSent : 0.0);
+   fflush(stdout);
+   
+   fprintf(stderr, "%8.0f bps %5.1f%% p50 %7.1f ms p99 %7.1f ms\n",
+           GoodputBps, UtilPct, P50 / 1e3, P99 / 1e3);
+   
+} /* End Report() */
+
+
+/******************************************************************************
+** Function: CompareU32
+**
+*/
+static int CompareU32(const void *A, const void *B)
+{
+   
+   uint32_t ValA = *(const uint32_t *)A;
+   uint32_t ValB = *(const uint32_t *)B;
+   
+   return (ValA > ValB) - (ValA < ValB);
+   
+} /* End CompareU32() */
+
+
+/******************************************************************************
+** Function: Random
+**
+** xorshift32
+**
+*/
+static uint32_t Random(void)
+{
+   
+   Bench.Rand ^= Bench.Rand << 13;
+   Bench.Rand ^= Bench.Rand >> 17;
+   Bench.Rand ^= Bench.Rand << 5;
+   
+   return Bench.Rand;
+   
+} /* End Random() */
+
+
+/******************************************************************************
+** Function: GetTimeNs
+**
+*/
+static uint64_t GetTimeNs(clockid_t Clock)
+{
+   
+   struct timespec Now;
+   
+   clock_gettime(Clock, &Now);
+   
+   return (uint64_t)Now.tv_sec * 1000000000 + Now.tv_nsec;
+   
+} /* End GetTimeNs() */
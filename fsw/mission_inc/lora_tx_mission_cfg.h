@@ -22,5 +22,13 @@
 #ifndef _lora_tx_mission_cfg_
 #define _lora_tx_mission_cfg_
 
+/*
+** Forwarded telemetry message header layout. The primary header length
+** includes the cFE extended header when the mission uses it. The header
+** compressor expects the secondary header to start with the cFE 32-16
+** (seconds, subseconds) time format.
+*/
+
+#define LORA_TX_TLM_PRI_HDR_LEN   6
 
 #endif /* _lora_tx_mission_cfg_ */
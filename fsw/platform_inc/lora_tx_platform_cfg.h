@@ -34,5 +34,25 @@
 #define LORA_TX_PLATFORM_REV   0
 #define LORA_TX_INI_FILENAME   "/cf/lora_tx_ini.json"
 
+#define LORA_TX_MAX_RADIOS      2     /* SX128x radios per app instance, must match the EDS RadioStatsArray */
+
+#define LORA_TX_RING_DEPTH     32     /* Transmit ring frame slots per class, must be a power of 2 */
+#define LORA_TX_SCHED_CLASS_CNT 3     /* Transmit scheduler classes, must match the EDS TxClassStats array */
+
+#define LORA_TX_TLM_FWD_MAX_MIDS  16  /* Maximum number of forwarded telemetry topics, must match the EDS MidAirtimeArray */
+#define LORA_TX_HDRC_CTX_CNT      16  /* Header compression APID contexts */
+
+#define LORA_TX_LZ_WINDOW_LEN   1024  /* File transfer compression input window, 16..4096 bytes */
+#define LORA_TX_FEC_MAX_PARITY     8  /* File transfer FEC parity packets per group, 1..127 */
+
+#define LORA_TX_HOP_MAX_CHANNELS  32  /* Frequency hopping table channels */
+
+#define LORA_TX_ADR_MAX_PROFILES   4  /* Adaptive data rate profiles, must match the EDS AdrProfileStats array */
+
+#define LORA_TX_PROFILE_MAX_CNT    8  /* Radio profile table entries */
+#define LORA_TX_PROFILE_NAME_LEN  16  /* Radio profile name including the terminator, must match the EDS ProfileName */
+
+#define LORA_TX_HIST_BUCKET_CNT   24  /* Latency histogram log2 buckets, must match the EDS LatencyHistBuckets array */
+
 
 #endif /* _lora_tx_platform_cfg_ */
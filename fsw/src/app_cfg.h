@@ -77,15 +77,37 @@
 #define CFG_BC_SCH_1_HZ_TOPICID         BC_SCH_1_HZ_TOPICID
 #define CFG_LORA_TX_STATUS_TLM_TOPICID  LORA_TX_STATUS_TLM_TOPICID
 #define CFG_LORA_TX_RADIO_TLM_TOPICID   LORA_TX_RADIO_TLM_TOPICID
+#define CFG_LORA_TX_PERF_TLM_TOPICID    LORA_TX_PERF_TLM_TOPICID
+#define CFG_LORA_TX_MID_AIRTIME_TLM_TOPICID  LORA_TX_MID_AIRTIME_TLM_TOPICID
+
+#define CFG_PERF_TLM_PERIOD      PERF_TLM_PERIOD
+#define CFG_PERF_ID_DEQUEUE      PERF_ID_DEQUEUE
+#define CFG_PERF_ID_ENCODE       PERF_ID_ENCODE
+#define CFG_PERF_ID_SPI_WRITE    PERF_ID_SPI_WRITE
+#define CFG_PERF_ID_TX_DONE      PERF_ID_TX_DONE
 
 #define CFG_CHILD_NAME       CHILD_NAME
 #define CFG_CHILD_PERF_ID    CHILD_PERF_ID
 #define CFG_CHILD_STACK_SIZE CHILD_STACK_SIZE
 #define CFG_CHILD_PRIORITY   CHILD_PRIORITY
+#define CFG_CHILD2_NAME      CHILD2_NAME
+#define CFG_CHILD2_PERF_ID   CHILD2_PERF_ID
+
+#define CFG_RADIO_CNT          RADIO_CNT
+#define CFG_RADIO_STRIPE       RADIO_STRIPE
+#define CFG_RADIO_AUTO_INIT    RADIO_AUTO_INIT
+#define CFG_RADIO_WARM_START   RADIO_WARM_START
 
 #define CFG_RADIO_SPI_DEV_STR  RADIO_SPI_DEV_STR
 #define CFG_RADIO_SPI_DEV_NUM  RADIO_SPI_DEV_NUM
 #define CFG_RADIO_SPI_SPEED    RADIO_SPI_SPEED
+#define CFG_RADIO_SPI_BATCH    RADIO_SPI_BATCH
+#define CFG_RADIO_GPIO_EVENTS  RADIO_GPIO_EVENTS
+#define CFG_RADIO_GPIO_CHIP    RADIO_GPIO_CHIP
+#define CFG_RADIO_BACKEND      RADIO_BACKEND
+#define CFG_RADIO_SIM_BUSY_US  RADIO_SIM_BUSY_US
+#define CFG_RADIO_SIM_LOSS_PCT RADIO_SIM_LOSS_PCT
+#define CFG_RADIO_SIM_OUTPUT   RADIO_SIM_OUTPUT
 #define CFG_RADIO_PIN_BUSY     RADIO_PIN_BUSY
 #define CFG_RADIO_PIN_NRST     RADIO_PIN_NRST
 #define CFG_RADIO_PIN_NSS      RADIO_PIN_NSS
@@ -95,11 +117,56 @@
 #define CFG_RADIO_PIN_TX_EN    RADIO_PIN_TX_EN   
 #define CFG_RADIO_PIN_RX_EN    RADIO_PIN_RX_EN
       
+#define CFG_RADIO2_SPI_DEV_STR  RADIO2_SPI_DEV_STR
+#define CFG_RADIO2_SPI_DEV_NUM  RADIO2_SPI_DEV_NUM
+#define CFG_RADIO2_SIM_OUTPUT   RADIO2_SIM_OUTPUT
+#define CFG_RADIO2_PIN_BUSY     RADIO2_PIN_BUSY
+#define CFG_RADIO2_PIN_NRST     RADIO2_PIN_NRST
+#define CFG_RADIO2_PIN_NSS      RADIO2_PIN_NSS
+#define CFG_RADIO2_PIN_DIO1     RADIO2_PIN_DIO1
+#define CFG_RADIO2_PIN_DIO2     RADIO2_PIN_DIO2
+#define CFG_RADIO2_PIN_DIO3     RADIO2_PIN_DIO3
+#define CFG_RADIO2_PIN_TX_EN    RADIO2_PIN_TX_EN
+#define CFG_RADIO2_PIN_RX_EN    RADIO2_PIN_RX_EN
+#define CFG_RADIO2_FREQUENCY    RADIO2_FREQUENCY
+
 #define CFG_RADIO_FREQUENCY    RADIO_FREQUENCY
 #define CFG_RADIO_LORA_SF      RADIO_LORA_SF
 #define CFG_RADIO_LORA_BW      RADIO_LORA_BW
 #define CFG_RADIO_LORA_CR      RADIO_LORA_CR
 
+#define CFG_PROFILE_TBL_FILE   PROFILE_TBL_FILE
+
+#define CFG_TX_QUEUE_AIRTIME_MS  TX_QUEUE_AIRTIME_MS
+#define CFG_TX_SCHED_WEIGHTS     TX_SCHED_WEIGHTS
+
+#define CFG_DUTY_CYCLE_BUDGET_MS  DUTY_CYCLE_BUDGET_MS
+#define CFG_DUTY_CYCLE_WINDOW_MS  DUTY_CYCLE_WINDOW_MS
+
+#define CFG_HOP_ENABLE           HOP_ENABLE
+#define CFG_HOP_CHANNELS         HOP_CHANNELS
+#define CFG_HOP_PKTS_PER_HOP     HOP_PKTS_PER_HOP
+
+#define CFG_ADR_ENABLE           ADR_ENABLE
+#define CFG_ADR_PROFILES         ADR_PROFILES
+#define CFG_ADR_MARGIN_DB        ADR_MARGIN_DB
+#define CFG_ADR_BACKLOG_HIGH_MS  ADR_BACKLOG_HIGH_MS
+#define CFG_ADR_BACKLOG_LOW_MS   ADR_BACKLOG_LOW_MS
+#define CFG_ADR_HOLD_MS          ADR_HOLD_MS
+
+#define CFG_FILE_XFER_BLOCK_LEN  FILE_XFER_BLOCK_LEN
+#define CFG_FILE_XFER_FEC_K      FILE_XFER_FEC_K
+#define CFG_FILE_XFER_FEC_M      FILE_XFER_FEC_M
+#define CFG_FILE_XFER_CLASS      FILE_XFER_CLASS
+
+#define CFG_TLM_FWD_PIPE_NAME    TLM_FWD_PIPE_NAME
+#define CFG_TLM_FWD_PIPE_DEPTH   TLM_FWD_PIPE_DEPTH
+#define CFG_TLM_FWD_BATCH_LIM    TLM_FWD_BATCH_LIM
+#define CFG_TLM_FWD_PERIOD_MS    TLM_FWD_PERIOD_MS
+#define CFG_TLM_FWD_FLUSH_MS     TLM_FWD_FLUSH_MS
+#define CFG_TLM_FWD_TOPICIDS     TLM_FWD_TOPICIDS
+#define CFG_TLM_FWD_HDR_REFRESH  TLM_FWD_HDR_REFRESH
+
 #define APP_CONFIG(XX) \
    XX(APP_CFE_NAME,char*) \
    XX(APP_PERF_ID,uint32) \
@@ -109,13 +176,33 @@
    XX(BC_SCH_1_HZ_TOPICID,uint32) \
    XX(LORA_TX_STATUS_TLM_TOPICID,uint32) \
    XX(LORA_TX_RADIO_TLM_TOPICID,uint32) \
+   XX(LORA_TX_PERF_TLM_TOPICID,uint32) \
+   XX(LORA_TX_MID_AIRTIME_TLM_TOPICID,uint32) \
+   XX(PERF_TLM_PERIOD,uint32) \
+   XX(PERF_ID_DEQUEUE,uint32) \
+   XX(PERF_ID_ENCODE,uint32) \
+   XX(PERF_ID_SPI_WRITE,uint32) \
+   XX(PERF_ID_TX_DONE,uint32) \
    XX(CHILD_NAME,char*) \
    XX(CHILD_PERF_ID,uint32) \
    XX(CHILD_STACK_SIZE,uint32) \
    XX(CHILD_PRIORITY,uint32) \
+   XX(CHILD2_NAME,char*) \
+   XX(CHILD2_PERF_ID,uint32) \
+   XX(RADIO_CNT,uint32) \
+   XX(RADIO_STRIPE,uint32) \
+   XX(RADIO_AUTO_INIT,uint32) \
+   XX(RADIO_WARM_START,uint32) \
    XX(RADIO_SPI_DEV_STR,char*) \
    XX(RADIO_SPI_DEV_NUM,uint32) \
    XX(RADIO_SPI_SPEED,uint32) \
+   XX(RADIO_SPI_BATCH,uint32) \
+   XX(RADIO_GPIO_EVENTS,uint32) \
+   XX(RADIO_GPIO_CHIP,char*) \
+   XX(RADIO_BACKEND,char*) \
+   XX(RADIO_SIM_BUSY_US,uint32) \
+   XX(RADIO_SIM_LOSS_PCT,uint32) \
+   XX(RADIO_SIM_OUTPUT,char*) \
    XX(RADIO_PIN_BUSY,uint32) \
    XX(RADIO_PIN_NRST,uint32) \
    XX(RADIO_PIN_NSS,uint32) \
@@ -124,10 +211,47 @@
    XX(RADIO_PIN_DIO3,uint32) \
    XX(RADIO_PIN_TX_EN,uint32) \
    XX(RADIO_PIN_RX_EN,uint32) \
+   XX(RADIO2_SPI_DEV_STR,char*) \
+   XX(RADIO2_SPI_DEV_NUM,uint32) \
+   XX(RADIO2_SIM_OUTPUT,char*) \
+   XX(RADIO2_PIN_BUSY,uint32) \
+   XX(RADIO2_PIN_NRST,uint32) \
+   XX(RADIO2_PIN_NSS,uint32) \
+   XX(RADIO2_PIN_DIO1,uint32) \
+   XX(RADIO2_PIN_DIO2,uint32) \
+   XX(RADIO2_PIN_DIO3,uint32) \
+   XX(RADIO2_PIN_TX_EN,uint32) \
+   XX(RADIO2_PIN_RX_EN,uint32) \
+   XX(RADIO2_FREQUENCY,uint32) \
    XX(RADIO_FREQUENCY,uint32) \
    XX(RADIO_LORA_SF,uint32) \
    XX(RADIO_LORA_BW,uint32) \
-   XX(RADIO_LORA_CR,uint32)
+   XX(RADIO_LORA_CR,uint32) \
+   XX(PROFILE_TBL_FILE,char*) \
+   XX(TX_QUEUE_AIRTIME_MS,uint32) \
+   XX(TX_SCHED_WEIGHTS,char*) \
+   XX(DUTY_CYCLE_BUDGET_MS,uint32) \
+   XX(DUTY_CYCLE_WINDOW_MS,uint32) \
+   XX(HOP_ENABLE,uint32) \
+   XX(HOP_CHANNELS,char*) \
+   XX(HOP_PKTS_PER_HOP,uint32) \
+   XX(ADR_ENABLE,uint32) \
+   XX(ADR_PROFILES,char*) \
+   XX(ADR_MARGIN_DB,uint32) \
+   XX(ADR_BACKLOG_HIGH_MS,uint32) \
+   XX(ADR_BACKLOG_LOW_MS,uint32) \
+   XX(ADR_HOLD_MS,uint32) \
+   XX(FILE_XFER_BLOCK_LEN,uint32) \
+   XX(FILE_XFER_FEC_K,uint32) \
+   XX(FILE_XFER_FEC_M,uint32) \
+   XX(FILE_XFER_CLASS,uint32) \
+   XX(TLM_FWD_PIPE_NAME,char*) \
+   XX(TLM_FWD_PIPE_DEPTH,uint32) \
+   XX(TLM_FWD_BATCH_LIM,uint32) \
+   XX(TLM_FWD_PERIOD_MS,uint32) \
+   XX(TLM_FWD_FLUSH_MS,uint32) \
+   XX(TLM_FWD_TOPICIDS,char*) \
+   XX(TLM_FWD_HDR_REFRESH,uint32)
    
 DECLARE_ENUM(Config,APP_CONFIG)
 
@@ -140,8 +264,10 @@ DECLARE_ENUM(Config,APP_CONFIG)
 ** exceeded so it is the developer's responsibility to verify the ranges. 
 */
 
-#define LORA_TX_BASE_EID   (APP_C_FW_APP_BASE_EID +  0)
-#define RADIO_IF_BASE_EID  (APP_C_FW_APP_BASE_EID + 20)
+#define LORA_TX_BASE_EID      (APP_C_FW_APP_BASE_EID +  0)
+#define RADIO_IF_BASE_EID     (APP_C_FW_APP_BASE_EID + 20)
+#define TLM_FWD_BASE_EID      (APP_C_FW_APP_BASE_EID + 40)
+#define PROFILE_TBL_BASE_EID  (APP_C_FW_APP_BASE_EID + 60)
 
 
 #endif /* _app_cfg_ */
@@ -35,8 +35,9 @@
 /* Convenience macros */
 #define  INITBL_OBJ   (&(LoraTx.IniTbl))
 #define  CMDMGR_OBJ   (&(LoraTx.CmdMgr))
-#define  CHILDMGR_OBJ (&(LoraTx.ChildMgr))
+#define  TBLMGR_OBJ   (&(LoraTx.TblMgr))
 #define  RADIO_IF_OBJ (&(LoraTx.RadioIf))
+#define  TLM_FWD_OBJ  (&(LoraTx.TlmFwd))
 
 
 /*******************************/
@@ -62,7 +63,8 @@ DEFINE_ENUM(Config,APP_CONFIG)
 static CFE_EVS_BinFilter_t  EventFilters[] =
 {  
    /* Event ID                  Mask */
-   {RADIO_IF_CHILD_TASK_EID,   CFE_EVS_FIRST_4_STOP}  // Use CFE_EVS_NO_FILTER to see all events
+   {RADIO_IF_CHILD_TASK_EID,   CFE_EVS_FIRST_4_STOP},  // Use CFE_EVS_NO_FILTER to see all events
+   {RADIO_IF_TX_DONE_EID,      CFE_EVS_FIRST_4_STOP}
 
 };
 
@@ -142,12 +144,19 @@ bool LORA_TX_NoOpCmd(void* ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
 bool LORA_TX_ResetAppCmd(void* ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
 {
 
+   uint8 i;
+   
    CFE_EVS_ResetAllFilters();
    
    CMDMGR_ResetStatus(CMDMGR_OBJ);
-   CHILDMGR_ResetStatus(CHILDMGR_OBJ);
+   TBLMGR_ResetStatus(TBLMGR_OBJ);
+   for (i = 0; i < LoraTx.RadioIf.RadioCnt; i++)
+   {
+      CHILDMGR_ResetStatus(&LoraTx.ChildMgr[i]);
+   }
    
    RADIO_IF_ResetStatus();
+   TLM_FWD_ResetStatus();
 	  
    return true;
 
@@ -162,6 +171,7 @@ static int32 InitApp(void)
 {
 
    int32 Status = APP_C_FW_CFS_ERROR;
+   uint8 i;
    
    CHILDMGR_TaskInit_t ChildTaskInit;
    
@@ -175,25 +185,38 @@ static int32 InitApp(void)
       LoraTx.PerfId   = INITBL_GetIntConfig(INITBL_OBJ, CFG_APP_PERF_ID);
       LoraTx.CmdMid   = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_LORA_TX_CMD_TOPICID));
       LoraTx.OneHzMid = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_BC_SCH_1_HZ_TOPICID));
+      LoraTx.CmdPipeTimeout = INITBL_GetIntConfig(INITBL_OBJ, CFG_TLM_FWD_PERIOD_MS);
+      LoraTx.PerfTlmPeriod  = INITBL_GetIntConfig(INITBL_OBJ, CFG_PERF_TLM_PERIOD);
       
       CFE_ES_PerfLogEntry(LoraTx.PerfId);
 
+      /* The child tasks find their radio so the radios must be constructed first */
+      RADIO_IF_Constructor(RADIO_IF_OBJ, &LoraTx.IniTbl, LoraTx.ChildMgr);
+
       /* Constructor sends error events */
-      ChildTaskInit.TaskName  = INITBL_GetStrConfig(INITBL_OBJ, CFG_CHILD_NAME);
-      ChildTaskInit.PerfId    = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_PERF_ID);
-      ChildTaskInit.StackSize = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_STACK_SIZE);
-      ChildTaskInit.Priority  = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_PRIORITY);
-      Status = CHILDMGR_Constructor(CHILDMGR_OBJ, 
-                                    ChildMgr_TaskMainCallback,
-                                    RADIO_IF_ChildTask, 
-                                    &ChildTaskInit); 
+      Status = CFE_SUCCESS;
+      for (i = 0; i < LoraTx.RadioIf.RadioCnt && Status == CFE_SUCCESS; i++)
+      {
+         ChildTaskInit.TaskName  = INITBL_GetStrConfig(INITBL_OBJ, (i == 0) ? CFG_CHILD_NAME : CFG_CHILD2_NAME);
+         ChildTaskInit.PerfId    = INITBL_GetIntConfig(INITBL_OBJ, (i == 0) ? CFG_CHILD_PERF_ID : CFG_CHILD2_PERF_ID);
+         ChildTaskInit.StackSize = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_STACK_SIZE);
+         ChildTaskInit.Priority  = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_PRIORITY);
+         Status = CHILDMGR_Constructor(&LoraTx.ChildMgr[i], 
+                                       ChildMgr_TaskMainCallback,
+                                       RADIO_IF_ChildTask, 
+                                       &ChildTaskInit); 
+      }
 
    } /* End if INITBL Constructed */
   
    if (Status == CFE_SUCCESS)
    {
 
-      RADIO_IF_Constructor(RADIO_IF_OBJ, &LoraTx.IniTbl);
+      TLM_FWD_Constructor(TLM_FWD_OBJ, &LoraTx.IniTbl);
+
+      TBLMGR_Constructor(TBLMGR_OBJ, INITBL_GetStrConfig(INITBL_OBJ, CFG_APP_CFE_NAME));
+      TBLMGR_RegisterTblWithDef(TBLMGR_OBJ, PROFILE_TBL_NAME, PROFILE_TBL_LoadCmd, PROFILE_TBL_DumpCmd,
+                                INITBL_GetStrConfig(INITBL_OBJ, CFG_PROFILE_TBL_FILE));
 
       /*
       ** Initialize app level interfaces
@@ -206,12 +229,26 @@ static int32 InitApp(void)
       CMDMGR_Constructor(CMDMGR_OBJ);
       CMDMGR_RegisterFunc(CMDMGR_OBJ, CMDMGR_NOOP_CMD_FC,   NULL, LORA_TX_NoOpCmd,     0);
       CMDMGR_RegisterFunc(CMDMGR_OBJ, CMDMGR_RESET_CMD_FC,  NULL, LORA_TX_ResetAppCmd, 0);
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_LOAD_TBL_CC,  TBLMGR_OBJ, TBLMGR_LoadTblCmd, sizeof(APP_C_FW_LoadTbl_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_DUMP_TBL_CC,  TBLMGR_OBJ, TBLMGR_DumpTblCmd, sizeof(APP_C_FW_DumpTbl_CmdPayload_t));
 
       CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_INIT_RADIO_CC,     RADIO_IF_OBJ, RADIO_IF_InitRadioCmd,    0);
       CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SEND_RADIO_TLM_CC, RADIO_IF_OBJ, RADIO_IF_SendRadioTlmCmd, 0);
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SEND_PERF_TLM_CC,  RADIO_IF_OBJ, RADIO_IF_SendPerfTlmCmd,  0);
       CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SET_SPI_SPEED_CC,  RADIO_IF_OBJ, RADIO_IF_SetSpiSpeedCmd,  sizeof(LORA_TX_SetSpiSpeed_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SET_RADIO_FREQUENCY_CC, RADIO_IF_OBJ, RADIO_IF_SetRadioFrequencyCmd, sizeof(LORA_TX_SetRadioFrequency_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SET_HOPPING_CC,         RADIO_IF_OBJ, RADIO_IF_SetHoppingCmd,        sizeof(LORA_TX_SetHopping_CmdPayload_t));
 
       CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SET_LO_RA_PARAMS_CC, RADIO_IF_OBJ, RADIO_IF_SetLoRaParamsCmd,  sizeof(LORA_TX_SetLoRaParams_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SELECT_PROFILE_CC,   RADIO_IF_OBJ, RADIO_IF_SelectProfileCmd,  sizeof(LORA_TX_SelectProfile_CmdPayload_t));
+
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_START_FILE_TRANSFER_CC, RADIO_IF_OBJ, RADIO_IF_StartFileTransferCmd, sizeof(LORA_TX_StartFileTransfer_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_STOP_FILE_TRANSFER_CC,  RADIO_IF_OBJ, RADIO_IF_StopFileTransferCmd,  0);
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_ESTIMATE_FILE_TRANSFER_CC, RADIO_IF_OBJ, RADIO_IF_EstimateFileTransferCmd, sizeof(LORA_TX_EstimateFileTransfer_CmdPayload_t));
+
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SET_ADR_CC, RADIO_IF_OBJ, RADIO_IF_SetAdrCmd, sizeof(LORA_TX_SetAdr_CmdPayload_t));
+      
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, LORA_TX_SEND_MID_AIRTIME_TLM_CC, TLM_FWD_OBJ, TLM_FWD_SendMidAirtimeTlmCmd, 0);
 
       CFE_MSG_Init(CFE_MSG_PTR(LoraTx.StatusTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_LORA_TX_STATUS_TLM_TOPICID)), sizeof(LORA_TX_StatusTlm_t));
    
@@ -232,6 +269,11 @@ static int32 InitApp(void)
 /******************************************************************************
 ** Function: ProcessCommands
 **
+** Notes:
+**   1. The command pipe pend times out so the telemetry forwarding pipe is
+**      drained at least once per forwarding period. It is also drained after
+**      every command pipe message.
+**
 */
 static int32 ProcessCommands(void)
 {
@@ -244,7 +286,7 @@ static int32 ProcessCommands(void)
    
 
    CFE_ES_PerfLogExit(LoraTx.PerfId);
-   SysStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, LoraTx.CmdPipe, CFE_SB_PEND_FOREVER);
+   SysStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, LoraTx.CmdPipe, LoraTx.CmdPipeTimeout);
    CFE_ES_PerfLogEntry(LoraTx.PerfId);
 
    if (SysStatus == CFE_SUCCESS)
@@ -266,6 +308,12 @@ static int32 ProcessCommands(void)
 
             SendStatusTlm();
             
+            if (LoraTx.PerfTlmPeriod > 0 && ++LoraTx.PerfTlmCnt >= LoraTx.PerfTlmPeriod)
+            {
+               LoraTx.PerfTlmCnt = 0;
+               RADIO_IF_SendPerfTlm();
+            }
+            
          }
          else
          {
@@ -284,13 +332,18 @@ static int32 ProcessCommands(void)
       }
       
    } /* Valid SB receive */ 
-   else 
+   else if (SysStatus != CFE_SB_TIME_OUT)
    {
    
          CFE_ES_WriteToSysLog("LORA_TX software bus error. Status = 0x%08X\n", SysStatus);   /* Use SysLog, events may not be working */
          RetStatus = CFE_ES_RunStatus_APP_ERROR;
    }  
-      
+   
+   if (RetStatus == CFE_ES_RunStatus_APP_RUN)
+   {
+      TLM_FWD_ForwardMsgs();
+   }
+   
    return RetStatus;
 
 } /* End ProcessCommands() */
@@ -304,14 +357,134 @@ static void SendStatusTlm(void)
 {
    
    LORA_TX_StatusTlm_Payload_t *StatusTlmPayload = &LoraTx.StatusTlm.Payload;
+   LORA_TX_TxClassStats_t      *ClassTlm;
+   LORA_TX_RadioStats_t        *RadioTlm;
+   const RADIO_IF_Radio_t      *Radio;
+   const TX_RING_Class_t       *TxRing;
+   const TX_SCHED_ClassStats_t *Stats;
+   uint32 LatencyCnt;
+   uint64 LatencySum;
+   uint8  i;
+   uint8  r;
    
    StatusTlmPayload->ValidCmdCnt   = LoraTx.CmdMgr.ValidCmdCnt;
    StatusTlmPayload->InvalidCmdCnt = LoraTx.CmdMgr.InvalidCmdCnt;
 
    /*
-   ** Tx Demo Object
+   ** Radio Interface Object
    */ 
+   
+   StatusTlmPayload->FileXferActive    = LoraTx.RadioIf.FileXfer.Active;
+   StatusTlmPayload->FileXferPktsTotal = LoraTx.RadioIf.FileXfer.PktsTotal;
+   StatusTlmPayload->FileXferPktsSent  = LoraTx.RadioIf.FileXfer.PktsSent;
+   
+   RADIO_IF_UpdateTxStats();
+   StatusTlmPayload->TxPktCnt      = LoraTx.RadioIf.TxStats.PktCnt;
+   StatusTlmPayload->TxPktRate     = LoraTx.RadioIf.TxStats.PktRate;
+   StatusTlmPayload->TxByteCnt     = LoraTx.RadioIf.TxStats.ByteCnt;
+   StatusTlmPayload->TxByteRate    = LoraTx.RadioIf.TxStats.ByteRate;
+   StatusTlmPayload->TxAirtime     = (uint32)(LoraTx.RadioIf.TxStats.AirtimeTotal / 1000);
+   StatusTlmPayload->TxAirtimeRate = LoraTx.RadioIf.TxStats.AirtimeRate;
+   StatusTlmPayload->TxLinkUtil    = LoraTx.RadioIf.TxStats.LinkUtil;
+   StatusTlmPayload->TxDropCnt     = LoraTx.RadioIf.TxStats.DropCnt;
+   StatusTlmPayload->TxDropRate    = LoraTx.RadioIf.TxStats.DropRate;
+   StatusTlmPayload->TxAirEfficiency = LoraTx.RadioIf.TxStats.AirEfficiency;
+   StatusTlmPayload->TxTimeoutCnt  = LoraTx.RadioIf.TxStats.TxTimeoutCnt;
+   StatusTlmPayload->TxDoneLostCnt = LoraTx.RadioIf.TxStats.TxDoneLostCnt;
+   StatusTlmPayload->TxStagedCnt   = LoraTx.RadioIf.TxStats.StagedCnt;
+   
+   /* Class, queue and hop statistics are summed across the radios */
+   StatusTlmPayload->TxQueueDepth     = 0;
+   StatusTlmPayload->TxQueueHighWater = 0;
+   StatusTlmPayload->TxQueueFullCnt   = 0;
+   for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
+   {
+      ClassTlm = &StatusTlmPayload->TxClassStats[i];
+      memset(ClassTlm, 0, sizeof(LORA_TX_TxClassStats_t));
+      LatencyCnt = 0;
+      LatencySum = 0;
       
+      for (r = 0; r < LoraTx.RadioIf.RadioCnt; r++)
+      {
+         TxRing = &LoraTx.RadioIf.Radio[r].TxRing[i];
+         Stats  = &LoraTx.RadioIf.Radio[r].Sched.Stats[i];
+         
+         ClassTlm->QueueDepth += TX_RING_Depth(TxRing);
+         ClassTlm->PktCnt     += Stats->PktCnt;
+         ClassTlm->Airtime    += Stats->AirtimeMs;
+         ClassTlm->DropCnt    += Stats->DropCnt;
+         LatencyCnt += Stats->LatencyCnt;
+         LatencySum += Stats->LatencySum;
+         if (Stats->LatencyMax > ClassTlm->LatencyMax)
+         {
+            ClassTlm->LatencyMax = Stats->LatencyMax;
+         }
+         
+         StatusTlmPayload->TxQueueFullCnt += TxRing->FullCnt;
+         if (TxRing->HighWater > StatusTlmPayload->TxQueueHighWater)
+         {
+            StatusTlmPayload->TxQueueHighWater = TxRing->HighWater;
+         }
+      }
+      ClassTlm->LatencyAvg = (LatencyCnt > 0) ? (uint32)(LatencySum / LatencyCnt) : 0;
+      
+      StatusTlmPayload->TxQueueDepth += ClassTlm->QueueDepth;
+   }
+   
+   StatusTlmPayload->DutyBudgetRemaining = RADIO_IF_DutyBudgetRemaining();
+   StatusTlmPayload->DutyThrottleCnt     = LoraTx.RadioIf.Duty.ThrottleCnt;
+   StatusTlmPayload->DutyThrottleTime    = LoraTx.RadioIf.Duty.ThrottleMs;
+   StatusTlmPayload->HopCnt              = 0;
+   for (r = 0; r < LoraTx.RadioIf.RadioCnt; r++)
+   {
+      StatusTlmPayload->HopCnt += LoraTx.RadioIf.Radio[r].Hop.HopCnt;
+   }
+   StatusTlmPayload->HopEnabled = LoraTx.RadioIf.Radio[0].Hop.Enabled;
+   StatusTlmPayload->HopChannel = LoraTx.RadioIf.Radio[0].Hop.Cur;
+   
+   StatusTlmPayload->RadioCnt    = LoraTx.RadioIf.RadioCnt;
+   StatusTlmPayload->RadioStripe = LoraTx.RadioIf.Stripe ? APP_C_FW_BooleanUint8_TRUE : APP_C_FW_BooleanUint8_FALSE;
+   memset(StatusTlmPayload->Radio, 0, sizeof(StatusTlmPayload->Radio));
+   for (r = 0; r < LoraTx.RadioIf.RadioCnt; r++)
+   {
+      Radio    = &LoraTx.RadioIf.Radio[r];
+      RadioTlm = &StatusTlmPayload->Radio[r];
+      
+      RadioTlm->Initialized   = Radio->Initialized ? APP_C_FW_BooleanUint8_TRUE : APP_C_FW_BooleanUint8_FALSE;
+      RadioTlm->RfFrequencyHz = Radio->Initialized ? RADIO_TX_GetShadow(r)->Frequency : Radio->Frequency*1000000UL;
+      RadioTlm->PktCnt        = Radio->TxStats.PktCnt;
+      RadioTlm->ByteRate      = Radio->TxStats.ByteRate;
+      RadioTlm->AirtimeRate   = Radio->TxStats.AirtimeRate;
+      RadioTlm->LinkUtil      = Radio->TxStats.LinkUtil;
+      RadioTlm->TxDoneLostCnt = Radio->TxStats.TxDoneLostCnt;
+      RadioTlm->HopChannel    = Radio->Hop.Cur;
+      for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
+      {
+         RadioTlm->QueueDepth += TX_RING_Depth(&Radio->TxRing[i]);
+      }
+   }
+   
+   StatusTlmPayload->AdrEnabled   = LoraTx.RadioIf.Adr.Enabled;
+   StatusTlmPayload->AdrProfile   = LoraTx.RadioIf.Adr.Cur;
+   StatusTlmPayload->AdrMarginDb  = LoraTx.RadioIf.Adr.MarginReq;
+   StatusTlmPayload->AdrSwitchCnt = LoraTx.RadioIf.Adr.SwitchCnt;
+   strncpy(StatusTlmPayload->ProfileName, LoraTx.RadioIf.RadioConfig.ProfileName, sizeof(StatusTlmPayload->ProfileName));
+   StatusTlmPayload->ProfileTblCnt = LoraTx.RadioIf.ProfileTbl.Data.Cnt;
+   for (i = 0; i < TX_ADR_MAX_PROFILES; i++)
+   {
+      StatusTlmPayload->AdrProfileStats[i].DwellTime = RADIO_IF_AdrDwellTime(i);
+      StatusTlmPayload->AdrProfileStats[i].SwitchCnt = LoraTx.RadioIf.Adr.Stats[i].SwitchCnt;
+   }
+   
+   /*
+   ** Telemetry Forwarding Object
+   */ 
+   
+   StatusTlmPayload->TlmFwdMsgCnt  = LoraTx.TlmFwd.MsgCnt;
+   StatusTlmPayload->TlmFwdDropCnt = LoraTx.TlmFwd.DropCnt;
+   StatusTlmPayload->TlmFwdFrameCnt = TLM_FWD_FrameCnt();
+   StatusTlmPayload->TlmFwdHdrBytesSaved = LoraTx.TlmFwd.Hdrc.BytesSaved;
+   
    CFE_SB_TimeStampMsg(CFE_MSG_PTR(LoraTx.StatusTlm.TelemetryHeader));
    CFE_SB_TransmitMsg(CFE_MSG_PTR(LoraTx.StatusTlm.TelemetryHeader), true);
    
@@ -30,6 +30,7 @@
 
 #include "app_cfg.h"
 #include "radio_if.h"
+#include "tlm_fwd.h"
 
 /***********************/
 /** Macro Definitions **/
@@ -65,7 +66,8 @@ typedef struct
    INITBL_Class_t     IniTbl;
    CFE_SB_PipeId_t    CmdPipe;
    CMDMGR_Class_t     CmdMgr;
-   CHILDMGR_Class_t   ChildMgr;
+   TBLMGR_Class_t     TblMgr;
+   CHILDMGR_Class_t   ChildMgr[LORA_TX_MAX_RADIOS];
    
    /*
    ** Telemetry Packets
@@ -80,8 +82,12 @@ typedef struct
    uint32             PerfId;
    CFE_SB_MsgId_t     CmdMid;
    CFE_SB_MsgId_t     OneHzMid;
+   int32              CmdPipeTimeout;
+   uint32             PerfTlmPeriod;   /* Seconds, 0 sends PerfTlm on command only */
+   uint32             PerfTlmCnt;
    
    RADIO_IF_Class_t   RadioIf;
+   TLM_FWD_Class_t    TlmFwd;
  
 } LORA_TX_Class_t;
 
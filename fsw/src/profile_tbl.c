@@ -0,0 +1,432 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the radio profile table class
+**
+**  Notes:
+**    1. See profile_tbl.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "profile_tbl.h"
+#include "tx_hop.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define JSON_OBJ_NAME      0
+#define JSON_OBJ_SF        1
+#define JSON_OBJ_BW        2
+#define JSON_OBJ_CR        3
+#define JSON_OBJ_PREAMBLE  4
+#define JSON_OBJ_INVERT_IQ 5
+#define JSON_OBJ_FREQ      6
+#define JSON_OBJ_POWER     7
+#define JSON_OBJ_RAMP      8
+#define JSON_OBJ_CNT       9
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/*
+** A profile as it's read from the JSON file
+*/
+typedef struct
+{
+
+   char  Name[PROFILE_TBL_NAME_LEN];
+   int   SpreadingFactor;
+   int   BandwidthKhz;
+   int   CodingRate;
+   int   PreambleLen;
+   int   InvertIQ;
+   int   FrequencyMhz;
+   int   TxPower;
+   int   RampTimeUs;
+   
+} JsonProfile_t;
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static PROFILE_TBL_Class_t *ProfileTbl = NULL;
+
+static PROFILE_TBL_Data_t TblData;   /* Working buffer for loads */
+
+static const struct
+{
+   uint16 Khz;
+   uint8  Code;
+} Bandwidth[] = {{203, 0x34}, {406, 0x26}, {812, 0x18}, {1625, 0x0A}};
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static bool LoadJsonData(size_t JsonFileLen);
+static void ConstructJsonObjs(CJSON_Obj_t JsonObj[JSON_OBJ_CNT], uint8 Index, JsonProfile_t *JsonProfile);
+static bool LoadProfile(PROFILE_TBL_Entry_t *Entry, const JsonProfile_t *JsonProfile);
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_Constructor
+**
+*/
+void PROFILE_TBL_Constructor(PROFILE_TBL_Class_t *ProfileTblPtr, const TX_TOA_Class_t *Toa)
+{
+   
+   ProfileTbl = ProfileTblPtr;
+   
+   memset(ProfileTbl, 0, sizeof(PROFILE_TBL_Class_t));
+   
+   ProfileTbl->Toa = Toa;
+   
+} /* End PROFILE_TBL_Constructor() */
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_LoadCmd
+**
+*/
+bool PROFILE_TBL_LoadCmd(TBLMGR_Tbl_t *Tbl, uint8 LoadType, const char *Filename)
+{
+   
+   bool RetStatus = false;
+   
+   if (LoadType != TBLMGR_LOAD_TBL_REPLACE)
+   {
+      CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "%s load failed, only replace loads are supported", PROFILE_TBL_NAME);
+   }
+   else if (CJSON_ProcessFile(Filename, ProfileTbl->JsonBuf, PROFILE_TBL_JSON_FILE_MAX_CHAR, LoadJsonData))
+   {
+      ProfileTbl->Loaded = true;
+      RetStatus = true;
+   }
+   
+   return RetStatus;
+   
+} /* End PROFILE_TBL_LoadCmd() */
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_DumpCmd
+**
+** Notes:
+**   1. The dump uses the load file's format so it can be reloaded.
+**
+*/
+bool PROFILE_TBL_DumpCmd(TBLMGR_Tbl_t *Tbl, uint8 DumpType, const char *Filename)
+{
+   
+   bool      RetStatus = false;
+   int32     SysStatus;
+   osal_id_t FileHandle;
+   char      DumpRecord[320];
+   const PROFILE_TBL_Entry_t *Entry;
+   uint8     i;
+   uint8     b;
+   
+   SysStatus = OS_OpenCreate(&FileHandle, Filename, OS_FILE_FLAG_CREATE | OS_FILE_FLAG_TRUNCATE, OS_WRITE_ONLY);
+   
+   if (SysStatus == OS_SUCCESS)
+   {
+      
+      sprintf(DumpRecord, "{\n   \"name\": \"%s\",\n   \"description\": \"Table dump\",\n   \"profile\": [",
+              PROFILE_TBL_NAME);
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+      
+      for (i = 0; i < ProfileTbl->Data.Cnt; i++)
+      {
+         
+         Entry = &ProfileTbl->Data.Entry[i];
+         for (b = 0; Bandwidth[b].Code != Entry->Profile.Bandwidth; b++);
+         
+         sprintf(DumpRecord, "%s\n      {\n         \"name\": \"%s\",\n"
+                 "         \"spreading-factor\": %d,\n         \"bandwidth-khz\": %d,\n"
+                 "         \"coding-rate\": %d,\n         \"preamble-len\": %d,\n"
+                 "         \"invert-iq\": %d,\n         \"frequency-mhz\": %d,\n"
+                 "         \"tx-power\": %d,\n         \"ramp-time-us\": %d\n      }",
+                 (i == 0) ? "" : ",", Entry->Name,
+                 Entry->Profile.SpreadingFactor >> 4, Bandwidth[b].Khz,
+                 Entry->Profile.CodingRate, Entry->Profile.PreambleLen,
+                 Entry->Profile.InvertIQ, (int)(Entry->Profile.Frequency / 1000000),
+                 Entry->Profile.TxPower, Entry->Profile.TxRampUs);
+         OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+      
+      }
+      
+      sprintf(DumpRecord, "\n   ]\n}\n");
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+      
+      OS_close(FileHandle);
+      
+      RetStatus = true;
+   
+   } /* End if file create */
+   else
+   {
+      CFE_EVS_SendEvent(PROFILE_TBL_DUMP_EID, CFE_EVS_EventType_ERROR,
+                        "Error creating dump file '%s', status=%d", Filename, (int)SysStatus);
+   }
+   
+   return RetStatus;
+   
+} /* End PROFILE_TBL_DumpCmd() */
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_Find
+**
+*/
+const PROFILE_TBL_Entry_t *PROFILE_TBL_Find(const char *Name)
+{
+   
+   uint8 i;
+   
+   for (i = 0; i < ProfileTbl->Data.Cnt; i++)
+   {
+      if (strncmp(ProfileTbl->Data.Entry[i].Name, Name, PROFILE_TBL_NAME_LEN) == 0)
+      {
+         return &ProfileTbl->Data.Entry[i];
+      }
+   }
+   
+   return NULL;
+   
+} /* End PROFILE_TBL_Find() */
+
+
+/******************************************************************************
+** Function: LoadJsonData
+**
+** Notes:
+**   1. Profiles are read in array order until an index isn't found. Every
+**      profile is validated before the table is replaced so a failed load
+**      leaves the current table in place.
+**
+*/
+static bool LoadJsonData(size_t JsonFileLen)
+{
+   
+   bool   RetStatus = true;
+   size_t ObjLoadCnt;
+   uint8  i;
+   uint8  j;
+   JsonProfile_t JsonProfile;
+   CJSON_Obj_t   JsonObj[JSON_OBJ_CNT];
+   
+   ProfileTbl->JsonFileLen = JsonFileLen;
+   memset(&TblData, 0, sizeof(PROFILE_TBL_Data_t));
+   
+   for (i = 0; i <= PROFILE_TBL_MAX_CNT && RetStatus; i++)
+   {
+      
+      ConstructJsonObjs(JsonObj, i, &JsonProfile);
+      ObjLoadCnt = CJSON_LoadObjArray(JsonObj, JSON_OBJ_CNT, ProfileTbl->JsonBuf, ProfileTbl->JsonFileLen);
+      
+      if (ObjLoadCnt == 0)
+      {
+         break;   /* End of the profile array */
+      }
+      
+      if (i == PROFILE_TBL_MAX_CNT)
+      {
+         CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "%s load failed, more than %d profiles", PROFILE_TBL_NAME, PROFILE_TBL_MAX_CNT);
+         RetStatus = false;
+      }
+      else if (ObjLoadCnt != JSON_OBJ_CNT)
+      {
+         CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "%s load failed, profile %d has %d of %d parameters",
+                           PROFILE_TBL_NAME, i, (int)ObjLoadCnt, JSON_OBJ_CNT);
+         RetStatus = false;
+      }
+      else
+      {
+         RetStatus = LoadProfile(&TblData.Entry[i], &JsonProfile);
+         for (j = 0; j < i && RetStatus; j++)
+         {
+            if (strcmp(TblData.Entry[j].Name, TblData.Entry[i].Name) == 0)
+            {
+               CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                                 "%s load failed, profiles %d and %d are both named %s",
+                                 PROFILE_TBL_NAME, j, i, TblData.Entry[i].Name);
+               RetStatus = false;
+            }
+         }
+         TblData.Cnt++;
+      }
+   
+   } /* End profile loop */
+   
+   if (RetStatus)
+   {
+      if (TblData.Cnt > 0)
+      {
+         memcpy(&ProfileTbl->Data, &TblData, sizeof(PROFILE_TBL_Data_t));
+         CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_INFORMATION,
+                           "Loaded %d radio profiles", ProfileTbl->Data.Cnt);
+      }
+      else
+      {
+         CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "%s load failed, no profiles defined", PROFILE_TBL_NAME);
+         RetStatus = false;
+      }
+   }
+   
+   return RetStatus;
+   
+} /* End LoadJsonData() */
+
+
+/******************************************************************************
+** Function: ConstructJsonObjs
+**
+** Construct the JSON objects of the profile at Index
+**
+*/
+static void ConstructJsonObjs(CJSON_Obj_t JsonObj[JSON_OBJ_CNT], uint8 Index, JsonProfile_t *JsonProfile)
+{
+   
+   char Key[64];
+   
+   memset(JsonProfile, 0, sizeof(JsonProfile_t));
+   
+   sprintf(Key, "profile[%d].name", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_NAME], Key, JSONString, JsonProfile->Name, PROFILE_TBL_NAME_LEN);
+   sprintf(Key, "profile[%d].spreading-factor", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_SF], Key, JSONNumber, &JsonProfile->SpreadingFactor, 4);
+   sprintf(Key, "profile[%d].bandwidth-khz", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_BW], Key, JSONNumber, &JsonProfile->BandwidthKhz, 4);
+   sprintf(Key, "profile[%d].coding-rate", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_CR], Key, JSONNumber, &JsonProfile->CodingRate, 4);
+   sprintf(Key, "profile[%d].preamble-len", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_PREAMBLE], Key, JSONNumber, &JsonProfile->PreambleLen, 4);
+   sprintf(Key, "profile[%d].invert-iq", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_INVERT_IQ], Key, JSONNumber, &JsonProfile->InvertIQ, 4);
+   sprintf(Key, "profile[%d].frequency-mhz", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_FREQ], Key, JSONNumber, &JsonProfile->FrequencyMhz, 4);
+   sprintf(Key, "profile[%d].tx-power", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_POWER], Key, JSONNumber, &JsonProfile->TxPower, 4);
+   sprintf(Key, "profile[%d].ramp-time-us", Index);
+   CJSON_ObjConstructor(&JsonObj[JSON_OBJ_RAMP], Key, JSONNumber, &JsonProfile->RampTimeUs, 4);
+   
+} /* End ConstructJsonObjs() */
+
+
+/******************************************************************************
+** Function: LoadProfile
+**
+** Validate a JSON profile and compile it into Entry
+**
+** Notes:
+**   1. The modulation parameters are validated by the time on air model
+**      which must cover every parameter the radio accepts.
+**   2. A maximum length packet must fit in the radio's TX timeout, see
+**      RADIO_TX_SendStaged(), otherwise the radio would abort it.
+**
+*/
+static bool LoadProfile(PROFILE_TBL_Entry_t *Entry, const JsonProfile_t *JsonProfile)
+{
+   
+   RADIO_TX_Profile_t *Profile = &Entry->Profile;
+   uint32 MaxAirtimeMs;
+   uint8 b;
+   
+   strncpy(Entry->Name, JsonProfile->Name, PROFILE_TBL_NAME_LEN - 1);
+   
+   for (b = 0; b < (sizeof(Bandwidth)/sizeof(Bandwidth[0])); b++)
+   {
+      if (Bandwidth[b].Khz == JsonProfile->BandwidthKhz) break;
+   }
+   
+   Profile->SpreadingFactor = (uint8)(JsonProfile->SpreadingFactor << 4);
+   Profile->Bandwidth       = (b < (sizeof(Bandwidth)/sizeof(Bandwidth[0]))) ? Bandwidth[b].Code : 0;
+   Profile->CodingRate      = (uint8)JsonProfile->CodingRate;
+   Profile->PreambleLen     = (uint16)JsonProfile->PreambleLen;
+   Profile->InvertIQ        = (JsonProfile->InvertIQ != 0);
+   Profile->Frequency       = (uint32)JsonProfile->FrequencyMhz * 1000000UL;
+   Profile->TxPower         = (int8)JsonProfile->TxPower;
+   Profile->TxRampUs        = (uint16)JsonProfile->RampTimeUs;
+   
+   if (Entry->Name[0] == '\0')
+   {
+      CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "%s load failed, profile without a name", PROFILE_TBL_NAME);
+      return false;
+   }
+   
+   if (JsonProfile->SpreadingFactor < 5 || JsonProfile->SpreadingFactor > 12 ||
+       TX_TOA_Compute(ProfileTbl->Toa, Profile->SpreadingFactor, Profile->Bandwidth,
+                      Profile->CodingRate, Profile->PreambleLen, 1, TX_TOA_HDR_EXPLICIT) == 0)
+   {
+      CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "%s load failed, profile %s has invalid LoRa parameters: SF=%d, BW=%d kHz, CR=%d",
+                        PROFILE_TBL_NAME, Entry->Name, JsonProfile->SpreadingFactor,
+                        JsonProfile->BandwidthKhz, JsonProfile->CodingRate);
+      return false;
+   }
+   
+   if (Profile->Frequency != 0 &&
+       (JsonProfile->FrequencyMhz < 0 || Profile->Frequency < TX_HOP_FREQ_MIN || Profile->Frequency > TX_HOP_FREQ_MAX))
+   {
+      CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "%s load failed, profile %s frequency %d MHz is outside the %lu..%lu MHz band",
+                        PROFILE_TBL_NAME, Entry->Name, JsonProfile->FrequencyMhz,
+                        TX_HOP_FREQ_MIN / 1000000, TX_HOP_FREQ_MAX / 1000000);
+      return false;
+   }
+   
+   if (JsonProfile->PreambleLen < 0 || JsonProfile->PreambleLen > UINT16_MAX ||
+       JsonProfile->TxPower < INT8_MIN || JsonProfile->TxPower > INT8_MAX ||
+       !RADIO_TX_CompileProfile(Profile, &Entry->Image))
+   {
+      CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "%s load failed, profile %s can't be programmed: preamble %d symbols, TX power %d dBm, ramp %d us",
+                        PROFILE_TBL_NAME, Entry->Name, JsonProfile->PreambleLen,
+                        JsonProfile->TxPower, JsonProfile->RampTimeUs);
+      return false;
+   }
+   
+   MaxAirtimeMs = TX_TOA_Compute(ProfileTbl->Toa, Profile->SpreadingFactor, Profile->Bandwidth, Profile->CodingRate,
+                                 Profile->PreambleLen, RADIO_TX_MAX_PAYLOAD_LEN, TX_TOA_HDR_EXPLICIT) / 1000;
+   if (MaxAirtimeMs + 1 + RADIO_TX_TIMEOUT_MARGIN > RADIO_TX_TIMEOUT_MAX)
+   {
+      CFE_EVS_SendEvent(PROFILE_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "%s load failed, profile %s %d byte packet time on air %u ms exceeds the %d ms TX timeout limit",
+                        PROFILE_TBL_NAME, Entry->Name, RADIO_TX_MAX_PAYLOAD_LEN, (unsigned int)MaxAirtimeMs,
+                        RADIO_TX_TIMEOUT_MAX - 1 - RADIO_TX_TIMEOUT_MARGIN);
+      return false;
+   }
+   
+   return true;
+   
+} /* End LoadProfile() */
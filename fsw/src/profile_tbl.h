@@ -0,0 +1,165 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the radio profile table class
+**
+**  Notes:
+**    1. A profile is a named radio operating point: modulation, preamble,
+**       IQ polarity, frequency, TX power and ramp time. The table is a JSON
+**       file managed by app_c_fw's table manager.
+**    2. Every profile is validated and compiled into its radio commands by
+**       RADIO_TX_CompileProfile() when the table is loaded. A table with an
+**       invalid profile is rejected and the current table is kept.
+**    3. The JSON uses human units: spreading factor 5..12, bandwidth in kHz
+**       (203, 406, 812 or 1625), SX128x coding rate codes 1..7, preamble
+**       symbols, frequency in MHz with 0 keeping each radio's frequency,
+**       TX power in dBm and ramp time in microseconds.
+**
+*/
+
+#ifndef _profile_tbl_
+#define _profile_tbl_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "radio_tx.h"
+#include "tx_toa.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define PROFILE_TBL_NAME       "Radio Profiles"
+#define PROFILE_TBL_MAX_CNT    LORA_TX_PROFILE_MAX_CNT
+#define PROFILE_TBL_NAME_LEN   LORA_TX_PROFILE_NAME_LEN
+
+#define PROFILE_TBL_JSON_FILE_MAX_CHAR  4000
+
+
+/*
+** Event Message IDs
+*/
+
+#define PROFILE_TBL_LOAD_EID  (PROFILE_TBL_BASE_EID + 0)
+#define PROFILE_TBL_DUMP_EID  (PROFILE_TBL_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef struct
+{
+
+   char                Name[PROFILE_TBL_NAME_LEN];
+   RADIO_TX_Profile_t  Profile;
+   RADIO_TX_Image_t    Image;
+   
+} PROFILE_TBL_Entry_t;
+
+
+typedef struct
+{
+
+   uint8                Cnt;
+   PROFILE_TBL_Entry_t  Entry[PROFILE_TBL_MAX_CNT];
+   
+} PROFILE_TBL_Data_t;
+
+
+/******************************************************************************
+** PROFILE_TBL_Class
+*/
+typedef struct
+{
+
+   /*
+   ** Framework References
+   */
+   
+   const TX_TOA_Class_t *Toa;   /* Validates the modulation parameters */
+   
+   /*
+   ** Table Data
+   */
+   
+   bool   Loaded;
+   PROFILE_TBL_Data_t Data;
+   
+   size_t JsonFileLen;
+   char   JsonBuf[PROFILE_TBL_JSON_FILE_MAX_CHAR];
+   
+} PROFILE_TBL_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_Constructor
+**
+** Initialize the profile table object to a known state
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**   2. The table is empty until it's loaded by the table manager.
+**
+*/
+void PROFILE_TBL_Constructor(PROFILE_TBL_Class_t *ProfileTblPtr, const TX_TOA_Class_t *Toa);
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_LoadCmd
+**
+** Command to load the table
+**
+** Notes:
+**   1. Function signature must match TBLMGR_LoadTblFuncPtr_t.
+**   2. Only replace loads are supported because a profile is compiled as a
+**      whole.
+**
+*/
+bool PROFILE_TBL_LoadCmd(TBLMGR_Tbl_t *Tbl, uint8 LoadType, const char *Filename);
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_DumpCmd
+**
+** Command to write the table contents to a file as JSON text
+**
+** Notes:
+**   1. Function signature must match TBLMGR_DumpTblFuncPtr_t.
+**
+*/
+bool PROFILE_TBL_DumpCmd(TBLMGR_Tbl_t *Tbl, uint8 DumpType, const char *Filename);
+
+
+/******************************************************************************
+** Function: PROFILE_TBL_Find
+**
+** Return a pointer to the named profile or NULL if it isn't in the table
+**
+*/
+const PROFILE_TBL_Entry_t *PROFILE_TBL_Find(const char *Name);
+
+
+#endif /* _profile_tbl_ */
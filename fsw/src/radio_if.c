@@ -29,23 +29,107 @@
 ** Include Files:
 */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "app_cfg.h"
 #include "radio_if.h"
 #include "radio_tx.h"
 
 
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p,v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/*
+** Init file configurations that are defined per radio. The remaining
+** RADIO_* configurations are shared by the radios.
+*/
+typedef struct
+{
+
+   uint16  SpiDevStr;
+   uint16  SpiDevNum;
+   uint16  SimOutput;
+   uint16  Frequency;
+   uint16  PinBusy;
+   uint16  PinNrst;
+   uint16  PinNss;
+   uint16  PinDio1;
+   uint16  PinDio2;
+   uint16  PinDio3;
+   uint16  PinTxEn;
+   uint16  PinRxEn;
+   
+} RadioCfg_t;
+
+
 /**********************/
 /** Global File Data **/
 /**********************/
 
 static RADIO_IF_Class_t *RadioIf = NULL;
 
+#if (RADIO_IF_MAX_RADIOS != 2)
+   #error RadioCfg[] must define the init file configurations of each radio
+#endif
+
+static const RadioCfg_t RadioCfg[RADIO_IF_MAX_RADIOS] =
+{
+   { CFG_RADIO_SPI_DEV_STR,  CFG_RADIO_SPI_DEV_NUM,  CFG_RADIO_SIM_OUTPUT,  CFG_RADIO_FREQUENCY,
+     CFG_RADIO_PIN_BUSY,     CFG_RADIO_PIN_NRST,     CFG_RADIO_PIN_NSS,     CFG_RADIO_PIN_DIO1,
+     CFG_RADIO_PIN_DIO2,     CFG_RADIO_PIN_DIO3,     CFG_RADIO_PIN_TX_EN,   CFG_RADIO_PIN_RX_EN },
+   { CFG_RADIO2_SPI_DEV_STR, CFG_RADIO2_SPI_DEV_NUM, CFG_RADIO2_SIM_OUTPUT, CFG_RADIO2_FREQUENCY,
+     CFG_RADIO2_PIN_BUSY,    CFG_RADIO2_PIN_NRST,    CFG_RADIO2_PIN_NSS,    CFG_RADIO2_PIN_DIO1,
+     CFG_RADIO2_PIN_DIO2,    CFG_RADIO2_PIN_DIO3,    CFG_RADIO2_PIN_TX_EN,  CFG_RADIO2_PIN_RX_EN }
+};
+
 
 /*******************************/
 /** Local Function Prototypes **/
 /*******************************/
 
+static bool LoadSchedWeights(const char *WeightList, uint32 Weight[TX_SCHED_CLASS_CNT]);
+static void InitRadio(RADIO_IF_Radio_t *Radio);
+static void ApplyAdr(void);
+static void ApplyToa(void);
+static void ApplyLoRa(RADIO_IF_Radio_t *Radio);
+static uint8 PrimaryRadio(void);
+static RADIO_IF_Radio_t *SlotRadio(uint8 Class);
+static bool FileXferRadio(const RADIO_IF_Radio_t *Radio);
+static uint8 FileXferRadioCnt(void);
+static void UpdateRates(RADIO_IF_TxStats_t *TxStats, uint32 DropCnt, uint8 RadioCnt);
+static uint32 GetTimeMs(void);
+static uint32 GetTimeUs(void);
+static uint32 PerfBegin(RADIO_IF_Radio_t *Radio, uint8 Stage);
+static void PerfEnd(RADIO_IF_Radio_t *Radio, uint8 Stage, uint32 StartUs, bool Record);
+static bool SendNextPacket(RADIO_IF_Radio_t *Radio);
+static uint8 SelectPacket(RADIO_IF_Radio_t *Radio, uint32 TimeMs, const TX_RING_Slot_t **Slot);
+static const TX_RING_Slot_t *NextRingSlot(RADIO_IF_Radio_t *Radio, uint8 Class, uint32 TimeMs);
+static void QueueStaleApids(RADIO_IF_Radio_t *Radio, const TX_RING_Slot_t *Slot);
+static void SendRingPayload(RADIO_IF_Radio_t *Radio, uint8 Class, const TX_RING_Slot_t *Slot, uint32 TimeOnAir);
+static void StartTx(RADIO_IF_Radio_t *Radio, const uint8 *Payload, uint16 PayloadLen, uint32 TimeOnAir);
+static void StageNextPacket(RADIO_IF_Radio_t *Radio);
+static void StartFileXfer(void);
+static bool FileBlockReady(RADIO_IF_Radio_t *Radio);
+static int32 NextFileBlock(RADIO_IF_Radio_t *Radio, uint8 Buf);
+static void SendFileBlock(RADIO_IF_Radio_t *Radio, uint32 TimeOnAir);
+static void FileXferDone(void);
+static void StopFileXfer(void);
+static int32 FillFileBlock(uint8 *Buf);
+static int32 CompressFileBlock(uint8 *Buf, uint16 Len);
+static int32 ReadFile(uint8 *Buf, uint16 Len);
+static void TxDoneCallback(uint8 Radio, bool TxTimeout);
+static void WaitForTxDone(RADIO_IF_Radio_t *Radio, uint16 PayloadLen, uint32 TimeOnAir);
+
 
 /******************************************************************************
 ** Function: RADIO_IF_Constructor
@@ -54,27 +138,233 @@ static RADIO_IF_Class_t *RadioIf = NULL;
 **
 ** Notes:
 **   1. This must be called prior to any other function.
+**   2. Each radio's hop sequence starts on a different channel so radios
+**      that hop at the same time transmit on different channels.
+**   3. When RADIO_AUTO_INIT is set each radio's initialization is requested
+**      here and performed when its child task starts.
 **
 */
-void RADIO_IF_Constructor(RADIO_IF_Class_t *RadioIfPtr, INITBL_Class_t *IniTbl)
+void RADIO_IF_Constructor(RADIO_IF_Class_t *RadioIfPtr, INITBL_Class_t *IniTbl,
+                          CHILDMGR_Class_t ChildMgr[RADIO_IF_MAX_RADIOS])
 {
    
+   uint8  i;
+   uint8  r;
+   uint32 SchedWeight[TX_SCHED_CLASS_CNT];
+   const TX_ADR_Profile_t *Profile;
+   RADIO_IF_Radio_t *Radio;
+   char   SemName[OS_MAX_API_NAME];
+   
    RadioIf = RadioIfPtr;
    
    memset(RadioIf, 0, sizeof(RADIO_IF_Class_t));
    
    RadioIf->IniTbl = IniTbl;
-   RadioIf->Initialized = false;
    RadioIf->SpiSpeed = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_SPI_SPEED);
    
-   RadioIf->RadioConfig.Frequency = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_FREQUENCY);
+   RadioIf->RadioCnt = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_CNT);
+   if (RadioIf->RadioCnt == 0 || RadioIf->RadioCnt > RADIO_IF_MAX_RADIOS)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid radio count %d, using 1. Limit %d radios",
+                        RadioIf->RadioCnt, RADIO_IF_MAX_RADIOS);
+      RadioIf->RadioCnt = 1;
+   }
+   RadioIf->Stripe = (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_STRIPE) != 0);
+   
+   RadioIf->Backend = RADIO_TX_BACKEND_SX128X;
+   if (strcmp(INITBL_GetStrConfig(RadioIf->IniTbl, CFG_RADIO_BACKEND), "SIM") == 0)
+   {
+      RadioIf->Backend = RADIO_TX_BACKEND_SIM;
+   }
+   else if (strcmp(INITBL_GetStrConfig(RadioIf->IniTbl, CFG_RADIO_BACKEND), "SX128X") != 0)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid radio backend %s, using SX128X. Valid backends: SX128X, SIM",
+                        INITBL_GetStrConfig(RadioIf->IniTbl, CFG_RADIO_BACKEND));
+   }
    
    RadioIf->RadioConfig.LoRa.SpreadingFactor = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_LORA_SF);
    RadioIf->RadioConfig.LoRa.Bandwidth       = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_LORA_BW);
    RadioIf->RadioConfig.LoRa.CodingRate      = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_LORA_CR);
+   
+   RadioIf->RadioConfig.PreambleLen = RADIO_TX_PREAMBLE_LEN;
+   
+   TX_TOA_Constructor(&RadioIf->Toa, true);
+   if (!TX_TOA_SetActive(&RadioIf->Toa, RadioIf->RadioConfig.LoRa.SpreadingFactor,
+                         RadioIf->RadioConfig.LoRa.Bandwidth, RadioIf->RadioConfig.LoRa.CodingRate,
+                         RadioIf->RadioConfig.PreambleLen))
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid init file LoRa parameters: SF=0x%02X, BW=0x%02X, CR=%d",
+                        RadioIf->RadioConfig.LoRa.SpreadingFactor, RadioIf->RadioConfig.LoRa.Bandwidth,
+                        RadioIf->RadioConfig.LoRa.CodingRate);
+   }
+   
+   PROFILE_TBL_Constructor(&RadioIf->ProfileTbl, &RadioIf->Toa);
+   
+   TX_ADR_Constructor(&RadioIf->Adr, INITBL_GetIntConfig(RadioIf->IniTbl, CFG_ADR_BACKLOG_HIGH_MS),
+                      INITBL_GetIntConfig(RadioIf->IniTbl, CFG_ADR_BACKLOG_LOW_MS),
+                      INITBL_GetIntConfig(RadioIf->IniTbl, CFG_ADR_HOLD_MS));
+   RadioIf->Adr.MarginReq = (int8)INITBL_GetIntConfig(RadioIf->IniTbl, CFG_ADR_MARGIN_DB);
+   if (TX_ADR_LoadProfiles(&RadioIf->Adr, INITBL_GetStrConfig(RadioIf->IniTbl, CFG_ADR_PROFILES), GetTimeMs()) > 0)
+   {
+      for (i = 0; i < RadioIf->Adr.ProfileCnt; i++)
+      {
+         Profile = &RadioIf->Adr.Profile[i];
+         if (TX_TOA_Compute(&RadioIf->Toa, Profile->SpreadingFactor, Profile->Bandwidth,
+                            Profile->CodingRate, RADIO_TX_PREAMBLE_LEN, 1, TX_TOA_HDR_EXPLICIT) == 0)
+         {
+            CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                              "Invalid ADR profile %d LoRa parameters: SF=0x%02X, BW=0x%02X, CR=%d",
+                              i, Profile->SpreadingFactor, Profile->Bandwidth, Profile->CodingRate);
+            RadioIf->Adr.ProfileCnt = 0;
+            break;
+         }
+      }
+   }
+   else
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid ADR profiles %s. Limit %d SF:BW:CR:MarginDb profiles with increasing margins",
+                        INITBL_GetStrConfig(RadioIf->IniTbl, CFG_ADR_PROFILES), TX_ADR_MAX_PROFILES);
+   }
+   RadioIf->Adr.Enabled = (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_ADR_ENABLE) != 0) && (RadioIf->Adr.ProfileCnt > 0);
+   
+   RADIO_TX_SetTxDoneCallback(TxDoneCallback);
+   
+   Radio = &RadioIf->Radio[0];
+   TX_HOP_Constructor(&Radio->Hop, INITBL_GetIntConfig(RadioIf->IniTbl, CFG_HOP_PKTS_PER_HOP));
+   if (TX_HOP_LoadChannels(&Radio->Hop, INITBL_GetStrConfig(RadioIf->IniTbl, CFG_HOP_CHANNELS)) == 0)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid hop channels %s. Limit %d channels from %lu to %lu Hz",
+                        INITBL_GetStrConfig(RadioIf->IniTbl, CFG_HOP_CHANNELS), TX_HOP_MAX_CHANNELS,
+                        TX_HOP_FREQ_MIN, TX_HOP_FREQ_MAX);
+   }
+   Radio->Hop.Enabled = (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_HOP_ENABLE) != 0) && (Radio->Hop.ChanCnt > 0);
+   
+   if (!LoadSchedWeights(INITBL_GetStrConfig(RadioIf->IniTbl, CFG_TX_SCHED_WEIGHTS), SchedWeight))
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid transmit scheduler weights %s, %d weights required. Using equal weights",
+                        INITBL_GetStrConfig(RadioIf->IniTbl, CFG_TX_SCHED_WEIGHTS), TX_SCHED_CLASS_CNT);
+   }
+   
+   for (r = 0; r < RadioIf->RadioCnt; r++)
+   {
+      
+      Radio = &RadioIf->Radio[r];
+      Radio->Id        = r;
+      Radio->ChildMgr  = &ChildMgr[r];
+      Radio->Frequency = INITBL_GetIntConfig(RadioIf->IniTbl, RadioCfg[r].Frequency);
+      Radio->SpiSpeed  = RadioIf->SpiSpeed;
       
+      if (r > 0)
+      {
+         Radio->Hop = RadioIf->Radio[0].Hop;
+      }
+      TX_HOP_SetFirst(&Radio->Hop, (r * Radio->Hop.ChanCnt) / RadioIf->RadioCnt);
+      
+      snprintf(SemName, sizeof(SemName), "%s%d", RADIO_IF_TX_DONE_SEM_NAME, r);
+      if (OS_BinSemCreate(&Radio->TxDoneSem, SemName, OS_SEM_EMPTY, 0) != OS_SUCCESS)
+      {
+         CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Failed to create TxDone semaphore %s", SemName);
+      }
+      
+      snprintf(SemName, sizeof(SemName), "%s%d", RADIO_IF_WAKEUP_SEM_NAME, r);
+      if (OS_BinSemCreate(&Radio->WakeupSem, SemName, OS_SEM_EMPTY, 0) != OS_SUCCESS)
+      {
+         CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Failed to create wakeup semaphore %s", SemName);
+      }
+      
+      TX_SCHED_Constructor(&Radio->Sched, SchedWeight);
+      for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
+      {
+         TX_RING_Constructor(&Radio->TxRing[i], INITBL_GetIntConfig(RadioIf->IniTbl, CFG_TX_QUEUE_AIRTIME_MS) * 1000);
+      }
+      
+      /* Each radio's stages use the next RADIO_IF_PERF_STAGE_CNT IDs */
+      Radio->PerfId[RADIO_IF_PERF_DEQUEUE]   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_PERF_ID_DEQUEUE);
+      Radio->PerfId[RADIO_IF_PERF_ENCODE]    = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_PERF_ID_ENCODE);
+      Radio->PerfId[RADIO_IF_PERF_SPI_WRITE] = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_PERF_ID_SPI_WRITE);
+      Radio->PerfId[RADIO_IF_PERF_TX_DONE]   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_PERF_ID_TX_DONE);
+      for (i = 0; i < RADIO_IF_PERF_STAGE_CNT; i++)
+      {
+         Radio->PerfId[i] += r * RADIO_IF_PERF_STAGE_CNT;
+         TX_HIST_Constructor(&Radio->PerfHist[i]);
+      }
+   
+   } /* End radio loop */
+   
+   TX_DUTY_Constructor(&RadioIf->Duty, INITBL_GetIntConfig(RadioIf->IniTbl, CFG_DUTY_CYCLE_BUDGET_MS),
+                       INITBL_GetIntConfig(RadioIf->IniTbl, CFG_DUTY_CYCLE_WINDOW_MS));
+   if (OS_MutSemCreate(&RadioIf->DutyMutex, RADIO_IF_DUTY_MUT_NAME, 0) != OS_SUCCESS)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to create duty cycle mutex %s", RADIO_IF_DUTY_MUT_NAME);
+   }
+   
+   if (OS_MutSemCreate(&RadioIf->FileXfer.Mutex, RADIO_IF_FILE_MUT_NAME, 0) != OS_SUCCESS)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to create file transfer mutex %s", RADIO_IF_FILE_MUT_NAME);
+   }
+   RadioIf->FileXfer.FileHandle = OS_OBJECT_ID_UNDEFINED;
+   RadioIf->FileXfer.BlockLen   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_FILE_XFER_BLOCK_LEN);
+   if (RadioIf->FileXfer.BlockLen == 0 || RadioIf->FileXfer.BlockLen > RADIO_TX_MAX_PAYLOAD_LEN)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid file transfer block length %d, using %d",
+                        RadioIf->FileXfer.BlockLen, RADIO_TX_MAX_PAYLOAD_LEN);
+      RadioIf->FileXfer.BlockLen = RADIO_TX_MAX_PAYLOAD_LEN;
+   }
+   
+   RadioIf->FileXfer.Class = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_FILE_XFER_CLASS);
+   if (RadioIf->FileXfer.Class >= TX_SCHED_CLASS_CNT)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid file transfer class %d, using %d",
+                        RadioIf->FileXfer.Class, TX_SCHED_CLASS_CNT - 1);
+      RadioIf->FileXfer.Class = TX_SCHED_CLASS_CNT - 1;
+   }
+   
+   RadioIf->FileXfer.DataLen = RadioIf->FileXfer.BlockLen;
+   if (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_FILE_XFER_FEC_K) > 0)
+   {
+      RadioIf->FileXfer.FecEnabled = TX_FEC_Constructor(&RadioIf->FileXfer.Fec,
+                                                        INITBL_GetIntConfig(RadioIf->IniTbl, CFG_FILE_XFER_FEC_K),
+                                                        INITBL_GetIntConfig(RadioIf->IniTbl, CFG_FILE_XFER_FEC_M),
+                                                        RadioIf->FileXfer.BlockLen);
+      if (RadioIf->FileXfer.FecEnabled)
+      {
+         RadioIf->FileXfer.DataLen = RadioIf->FileXfer.Fec.DataMax;
+      }
+      else
+      {
+         CFE_EVS_SendEvent(RADIO_IF_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Invalid file transfer FEC configuration K=%d, M=%d, FEC disabled. Limits K 1..%d, M 1..%d",
+                           INITBL_GetIntConfig(RadioIf->IniTbl, CFG_FILE_XFER_FEC_K),
+                           INITBL_GetIntConfig(RadioIf->IniTbl, CFG_FILE_XFER_FEC_M),
+                           TX_FEC_MAX_DATA, TX_FEC_MAX_PARITY);
+      }
+   }
+   
    CFE_MSG_Init(CFE_MSG_PTR(RadioIf->RadioTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(RadioIf->IniTbl, CFG_LORA_TX_RADIO_TLM_TOPICID)), sizeof(LORA_TX_RadioTlm_t));
-
+   
+   CFE_MSG_Init(CFE_MSG_PTR(RadioIf->PerfTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(RadioIf->IniTbl, CFG_LORA_TX_PERF_TLM_TOPICID)), sizeof(LORA_TX_PerfTlm_t));
+   
+   if (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_AUTO_INIT) != 0)
+   {
+      for (r = 0; r < RadioIf->RadioCnt; r++)
+      {
+         RadioIf->Radio[r].InitReq = (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_WARM_START) != 0) ?
+                                     RADIO_IF_INIT_WARM : RADIO_IF_INIT_COLD;
+      }
+   }
+   
 } /* End RADIO_IF_Constructor() */
 
 
@@ -83,22 +373,91 @@ void RADIO_IF_Constructor(RADIO_IF_Class_t *RadioIfPtr, INITBL_Class_t *IniTbl)
 **
 ** Notes:
 **   1. Returning false causes the child task to terminate.
-**   2. Information events are sent because this is instructional code and the
-**      events provide feedback. The events are filtered so they won't flood
-**      the ground. A reset app command resets the event filter.  
+**   2. Performs at most one packet transmission per call so stop requests
+**      are serviced between packets. When there's nothing to transmit the
+**      task pends on its radio's wakeup semaphore so it doesn't consume the
+**      CPU.
+**   3. The transmit scheduler selects the class that sends the next packet.
+**      Ring payloads are only consumed once the radio is initialized.
+**   4. Adaptive data rate profile changes are selected and the time on air
+**      table is rebuilt by the first radio's task. Every radio applies
+**      LoRa parameter changes at the top of the loop so they take effect
+**      between packets without draining the ring.
+**   5. File transfer requests are serviced by whichever task sees them
+**      first.
+**   6. Radio initialization requests are serviced first so a radio is
+**      never reset while its task has a packet in progress.
 **
 */
 bool RADIO_IF_ChildTask(CHILDMGR_Class_t *ChildMgr)
 {
    
    bool RetStatus = true;
- 
-   CFE_EVS_SendEvent (RADIO_IF_CHILD_TASK_EID, CFE_EVS_EventType_INFORMATION, 
-                      "RADIO_IF_ChildTask()"); 
-   OS_TaskDelay(2000);
-       
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   RADIO_IF_Radio_t    *Radio = NULL;
+   uint8 i;
+   
+   for (i = 0; i < RadioIf->RadioCnt; i++)
+   {
+      if (RadioIf->Radio[i].ChildMgr == ChildMgr)
+      {
+         Radio = &RadioIf->Radio[i];
+      }
+   }
+   
+   if (Radio == NULL)
+   {
+      CFE_EVS_SendEvent(RADIO_IF_CHILD_TASK_EID, CFE_EVS_EventType_ERROR,
+                        "Child task isn't assigned to a radio, terminating the task");
+      return false;
+   }
+   
+   if (Radio->InitReq != RADIO_IF_INIT_NONE)
+   {
+      InitRadio(Radio);
+   }
+   
+   if (Radio->Id == PrimaryRadio())
+   {
+      if (Radio->Initialized)
+      {
+         ApplyAdr();
+      }
+      ApplyToa();
+   }
+   if (Radio->Initialized)
+   {
+      ApplyLoRa(Radio);
+   }
+   
+   if (FileXfer->StartReq || (FileXfer->Active && FileXfer->StopReq))
+   {
+      
+      OS_MutSemTake(FileXfer->Mutex);
+      if (FileXfer->StartReq)
+      {
+         FileXfer->StartReq = false;
+         StartFileXfer();
+      }
+      else if (FileXfer->Active && FileXfer->StopReq)
+      {
+         CFE_EVS_SendEvent(RADIO_IF_FILE_XFER_EID, CFE_EVS_EventType_INFORMATION,
+                           "File transfer of %s aborted after %d of %d packets",
+                           FileXfer->Filename, FileXfer->PktsSent, FileXfer->PktsTotal);
+         StopFileXfer();
+      }
+      OS_MutSemGive(FileXfer->Mutex);
+   
+   }
+   else if (!SendNextPacket(Radio))
+   {
+      
+      OS_BinSemTimedWait(Radio->WakeupSem, RADIO_IF_CHILD_IDLE_DELAY);
+   
+   }
+   
    return RetStatus;
-
+   
 } /* End RADIO_IF_ChildTask() */
 
 
@@ -114,205 +473,2332 @@ bool RADIO_IF_ChildTask(CHILDMGR_Class_t *ChildMgr)
 */
 void RADIO_IF_ResetStatus(void)
 {
-
-   return;
-
+   
+   RADIO_IF_Radio_t *Radio;
+   uint8 i;
+   uint8 r;
+   
+   OS_MutSemTake(RadioIf->DutyMutex);
+   TX_DUTY_ResetStatus(&RadioIf->Duty);
+   OS_MutSemGive(RadioIf->DutyMutex);
+   
+   for (r = 0; r < RadioIf->RadioCnt; r++)
+   {
+      
+      Radio = &RadioIf->Radio[r];
+      
+      for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
+      {
+         TX_RING_ResetStatus(&Radio->TxRing[i]);
+      }
+      TX_SCHED_ResetStatus(&Radio->Sched);
+      
+      Radio->TxStats.TxTimeoutCnt  = 0;
+      Radio->TxStats.TxDoneLostCnt = 0;
+      Radio->TxStats.StagedCnt     = 0;
+      Radio->TxStats.DropCnt       = 0;
+      Radio->TxStats.PrevDropCnt   = 0;
+      
+      for (i = 0; i < RADIO_IF_PERF_STAGE_CNT; i++)
+      {
+         TX_HIST_Constructor(&Radio->PerfHist[i]);
+      }
+   }
+   
+   RadioIf->TxStats.DropCnt     = 0;
+   RadioIf->TxStats.PrevDropCnt = 0;
+   
 } /* End RADIO_IF_ResetStatus() */
 
 
 /******************************************************************************
-** Function: RADIO_IF_InitRadio
+** Function: RADIO_IF_PayloadSlot
 **
 */
-bool RADIO_IF_InitRadioCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+uint8 *RADIO_IF_PayloadSlot(uint8 Class)
 {
    
-   bool RetStatus = false;
-   RADIO_TX_Pin_t RadioPin;
+   TX_RING_Slot_t *Slot = NULL;
+   
+   if (Class < TX_SCHED_CLASS_CNT)
+   {
+      Slot = TX_RING_ProducerSlot(&SlotRadio(Class)->TxRing[Class]);
+      RadioIf->SlotHeld[Class] = (Slot != NULL);
+   }
+   
+   return (Slot != NULL) ? Slot->Data : NULL;
+   
+} /* End RADIO_IF_PayloadSlot() */
 
-   RadioPin.Busy = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_BUSY);
-   RadioPin.Nrst = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_NRST);
-   RadioPin.Nss  = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_NSS);
-   RadioPin.Dio1 = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_DIO1);
-   RadioPin.Dio2 = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_DIO2);
-   RadioPin.Dio3 = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_DIO3);
-   RadioPin.TxEn = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_TX_EN);
-   RadioPin.RxEn = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_RX_EN);
+
+/******************************************************************************
+** Function: RADIO_IF_QueuePayload
+**
+** Notes:
+**   1. The ring's producer slot is fetched again rather than trusting a
+**      caller's pointer. It's the slot returned by RADIO_IF_PayloadSlot()
+**      because only the producer advances the ring's head and the class's
+**      radio isn't reselected until the slot is queued.
+**
+**   2. The radio's wakeup semaphore is given so an idle child task starts
+**      transmitting immediately.
+**
+*/
+uint32 RADIO_IF_QueuePayload(uint8 Class, uint16 PayloadLen, uint32 EnqueueMs, uint32 DeadlineMs)
+{
    
-   RetStatus = RADIO_TX_InitRadio(INITBL_GetStrConfig(RadioIf->IniTbl, CFG_RADIO_SPI_DEV_STR),
-                                  INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_SPI_DEV_NUM),
-                                  &RadioPin);
+   RADIO_IF_Radio_t *Radio = NULL;
+   TX_RING_Slot_t   *Slot  = NULL;
+   uint32 Airtime = 0;
    
-   if (RetStatus)
+   if (Class < TX_SCHED_CLASS_CNT && PayloadLen <= RADIO_TX_MAX_PAYLOAD_LEN)
    {
-      RadioIf->Initialized = true;
-      CFE_EVS_SendEvent(RADIO_TX_INIT_RADIO_CMD_EID, CFE_EVS_EventType_INFORMATION,
-                        "Sucessfully initialized the Radio");
+      Radio = SlotRadio(Class);
+      Slot  = TX_RING_ProducerSlot(&Radio->TxRing[Class]);
    }
-   else
+   
+   if (Slot != NULL)
    {
-      RadioIf->Initialized = false;
-      CFE_EVS_SendEvent(RADIO_TX_INIT_RADIO_CMD_EID, CFE_EVS_EventType_ERROR,
-                        "Failed to initialize the Radio");
+      Airtime = TX_TOA_Get(&RadioIf->Toa, PayloadLen);
+      Slot->Len        = PayloadLen;
+      Slot->Airtime    = Airtime;
+      Slot->EnqueueMs  = EnqueueMs;
+      Slot->DeadlineMs = DeadlineMs;
+      TX_RING_Produce(&Radio->TxRing[Class]);
+      RadioIf->SlotHeld[Class] = false;
+      OS_BinSemGive(Radio->WakeupSem);
    }
-
-   return RetStatus;
    
-} /* RADIO_IF_InitRadioCmd() */
+   return Airtime;
+   
+} /* End RADIO_IF_QueuePayload() */
 
 
 /******************************************************************************
-** Function: RADIO_IF_SendRadioTlmCmd
+** Function: RADIO_IF_StaleApid
 **
 ** Notes:
-**   1. See radio_if.h file prologue for data source details.
+**   1. Each radio's queue has a single producer, its child task, and a
+**      single consumer, this function.
+**   2. The lost flag is cleared before every context is invalidated so an
+**      APID lost after it's cleared is reported by the next call.
+**
 */
-bool RADIO_IF_SendRadioTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+bool RADIO_IF_StaleApid(uint16 *Apid)
 {
    
-   LORA_TX_RadioTlm_Payload_t *RadioTlmPayload = &RadioIf->RadioTlm.Payload;
+   RADIO_IF_Radio_t *Radio;
+   uint8 r;
    
-   strncpy(RadioTlmPayload->SpiDevStr, INITBL_GetStrConfig(RadioIf->IniTbl, CFG_RADIO_SPI_DEV_STR), OS_MAX_PATH_LEN - 1);   
-   RadioTlmPayload->SpiDevNum      = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_SPI_DEV_NUM);
-   RadioTlmPayload->SpiSpeed       = RadioIf->SpiSpeed;
-   RadioTlmPayload->RadioPinBusy   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_BUSY);
-   RadioTlmPayload->RadioPinNrst   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_NRST);
-   RadioTlmPayload->RadioPinNss    = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_NSS);
-   RadioTlmPayload->RadioPinDio1   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_DIO1);
-   RadioTlmPayload->RadioPinDio2   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_DIO2);
-   RadioTlmPayload->RadioPinDio3   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_DIO3);
-   RadioTlmPayload->RadioPinTxEn   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_TX_EN);
-   RadioTlmPayload->RadioPinRxEn   = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_PIN_RX_EN);
-
-   RadioTlmPayload->RadioFrequency      = RadioIf->RadioConfig.Frequency;
-   RadioTlmPayload->LoRaSpreadingFactor = RadioIf->RadioConfig.LoRa.SpreadingFactor;
-   RadioTlmPayload->LoRaBandwidth       = RadioIf->RadioConfig.LoRa.Bandwidth;
-   RadioTlmPayload->LoRaCodingRate      = RadioIf->RadioConfig.LoRa.CodingRate;
-   
-   CFE_SB_TimeStampMsg(CFE_MSG_PTR(RadioIf->RadioTlm.TelemetryHeader));
-   CFE_SB_TransmitMsg(CFE_MSG_PTR(RadioIf->RadioTlm.TelemetryHeader), true);
-
-   CFE_EVS_SendEvent(RADIO_TX_SEND_RADIO_TLM_CMD_EID, CFE_EVS_EventType_INFORMATION,
-                     "Sent Radio configuration telemetry message");
-   return true;
+   for (r = 0; r < RadioIf->RadioCnt; r++)
+   {
+      
+      Radio = &RadioIf->Radio[r];
+      
+      if (Radio->StaleApidLost)
+      {
+         Radio->StaleApidLost = false;
+         STORE_RELEASE(&Radio->StaleApidTail, LOAD_ACQUIRE(&Radio->StaleApidHead));
+         *Apid = RADIO_IF_STALE_APID_ALL;
+         return true;
+      }
+      
+      if (Radio->StaleApidTail != LOAD_ACQUIRE(&Radio->StaleApidHead))
+      {
+         *Apid = Radio->StaleApid[Radio->StaleApidTail % RADIO_IF_STALE_APID_CNT];
+         STORE_RELEASE(&Radio->StaleApidTail, Radio->StaleApidTail + 1);
+         return true;
+      }
+      
+   }
    
-} /* RADIO_IF_SendRadioTlmCmd() */
+   return false;
+   
+} /* End RADIO_IF_StaleApid() */
 
 
 /******************************************************************************
-** Function: RADIO_IF_SetLoRaParamsCmd
+** Function: RADIO_IF_Initialized
 **
-** Notes:
-**   1. TODO: Add parameter validity checks
 */
-bool RADIO_IF_SetLoRaParamsCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+bool RADIO_IF_Initialized(void)
 {
    
-   const LORA_TX_SetLoRaParams_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetLoRaParams_t);
-   bool RetStatus = false;
-
-   if (RadioIf->Initialized)
-   {
-      RadioIf->RadioConfig.LoRa.SpreadingFactor = Cmd->SpreadingFactor;
-      RadioIf->RadioConfig.LoRa.Bandwidth       = Cmd->Bandwidth;
-      RadioIf->RadioConfig.LoRa.CodingRate      = Cmd->CodingRate;
-      RADIO_TX_SetLoraParams(RadioIf->RadioConfig.LoRa.SpreadingFactor,
-                             RadioIf->RadioConfig.LoRa.Bandwidth,
-                             RadioIf->RadioConfig.LoRa.CodingRate);
-      CFE_EVS_SendEvent(RADIO_TX_SET_LORA_PARAMS_CMD_EID, CFE_EVS_EventType_INFORMATION,
-                        "Set LoRa paramaters: SF=%d, BW=%d, RC=%d", Cmd->SpreadingFactor,
-                        Cmd->Bandwidth, Cmd->CodingRate);
-                        
-      RetStatus = true;
-   }
-   else
+   uint8 i;
+   
+   for (i = 0; i < RadioIf->RadioCnt; i++)
    {
-      CFE_EVS_SendEvent(RADIO_TX_SET_LORA_PARAMS_CMD_EID, CFE_EVS_EventType_ERROR,
-                        "Set LoRa parameters failed, Radio not initialized");
+      if (RadioIf->Radio[i].Initialized)
+      {
+         return true;
+      }
    }
-
-   return RetStatus;
    
-} /* RADIO_IF_SetLoRaParamsCmd() */
+   return false;
+   
+} /* End RADIO_IF_Initialized() */
 
 
 /******************************************************************************
-** Function: RADIO_IF_SetRadioFrequencyCmd
+** Function: RADIO_IF_TxQueueSpace
 **
-** Notes:
-**   1. TODO: What is a valid frequency range
 */
-bool RADIO_IF_SetRadioFrequencyCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+uint32 RADIO_IF_TxQueueSpace(uint8 Class)
 {
    
-   const LORA_TX_SetRadioFrequency_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetRadioFrequency_t);
-   bool RetStatus = false;
-
-   if (Cmd->Frequency >= 0 && Cmd->Frequency <= 48000)
+   uint32 Space = 0;
+   uint8  Primary = PrimaryRadio();
+   uint8  i;
+   
+   if (Class < TX_SCHED_CLASS_CNT)
    {
-      if (RadioIf->Initialized)
+      for (i = 0; i < RadioIf->RadioCnt; i++)
       {
-         RadioIf->RadioConfig.Frequency = Cmd->Frequency;
-         RADIO_TX_SetRadioFrequency(Cmd->Frequency*1000000UL);
-         CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_INFORMATION,
-                           "Set radio frequency to %d Mhz", Cmd->Frequency);
-         RetStatus = true;
-      }
-      else
-      {
-         CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_ERROR,
-                           "Set radio frequency failed, Radio not initialized");
+         if (i == Primary || (RadioIf->Stripe && RadioIf->Radio[i].Initialized))
+         {
+            Space += TX_RING_Space(&RadioIf->Radio[i].TxRing[Class]);
+         }
       }
-
-   }
-   else
-   {
-      CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_ERROR,
-                           "Set radio frequency failed, invalid frequency %d.",
-                           Cmd->Frequency);
    }
-
-   return RetStatus;
    
-} /* RADIO_IF_SetRadioFrequencyCmd() */
+   return Space;
+   
+} /* End RADIO_IF_TxQueueSpace() */
 
 
 /******************************************************************************
-** Function: RADIO_IF_SetSpiSpeedCmd
+** Function: RADIO_IF_UpdateTxStats
+**
+** Compute the per second transmit statistics
 **
 ** Notes:
-**   1. TODO: What is a valid speed range
+**   1. Each radio's rates are computed from its own counters. The app's
+**      cumulative counters are the sums of the radios' counters and its
+**      LinkUtil is the average utilization of the initialized radios.
+**
 */
-bool RADIO_IF_SetSpiSpeedCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+void RADIO_IF_UpdateTxStats(void)
 {
    
-   const LORA_TX_SetSpiSpeed_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetSpiSpeed_t);
-   bool RetStatus = false;
-
-   if (Cmd->Speed >= 0 && Cmd->Speed <= 8000000)
+   RADIO_IF_TxStats_t *TxStats = &RadioIf->TxStats;
+   RADIO_IF_Radio_t   *Radio;
+   uint32 DropCnt = 0;
+   uint32 RadioDropCnt;
+   uint8  ActiveCnt = 0;
+   uint8  i;
+   uint8  r;
+   
+   TxStats->PktCnt        = 0;
+   TxStats->ByteCnt       = 0;
+   TxStats->AirtimeCnt    = 0;
+   TxStats->TxTimeoutCnt  = 0;
+   TxStats->TxDoneLostCnt = 0;
+   TxStats->StagedCnt     = 0;
+   
+   for (r = 0; r < RadioIf->RadioCnt; r++)
    {
-      if (RadioIf->Initialized)
+      
+      Radio = &RadioIf->Radio[r];
+      
+      RadioDropCnt = 0;
+      for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
       {
-         RadioIf->SpiSpeed = Cmd->Speed;
-         RADIO_TX_SetSpiSpeed(Cmd->Speed);
-         CFE_EVS_SendEvent(RADIO_TX_SET_SPI_SPEED_CMD_EID, CFE_EVS_EventType_INFORMATION,
-                           "Set radio SPI speed to %d", Cmd->Speed);
-         RetStatus = true;
+         RadioDropCnt += Radio->TxRing[i].FullCnt + Radio->Sched.Stats[i].DropCnt;
       }
-      else
+      UpdateRates(&Radio->TxStats, RadioDropCnt, 1);
+      
+      TxStats->PktCnt        += Radio->TxStats.PktCnt;
+      TxStats->ByteCnt       += Radio->TxStats.ByteCnt;
+      TxStats->AirtimeCnt    += Radio->TxStats.AirtimeCnt;
+      TxStats->TxTimeoutCnt  += Radio->TxStats.TxTimeoutCnt;
+      TxStats->TxDoneLostCnt += Radio->TxStats.TxDoneLostCnt;
+      TxStats->StagedCnt     += Radio->TxStats.StagedCnt;
+      DropCnt += RadioDropCnt;
+      
+      if (Radio->Initialized)
       {
-         CFE_EVS_SendEvent(RADIO_TX_SET_SPI_SPEED_CMD_EID, CFE_EVS_EventType_ERROR,
-                           "Set radio SPI speed failed, Radio not initialized");
+         ActiveCnt++;
       }
-
    }
-   else
-   {
-      CFE_EVS_SendEvent(RADIO_TX_SET_SPI_SPEED_CMD_EID, CFE_EVS_EventType_ERROR,
-                           "Set radio SPI speed failed, invalid speed %d.",
-                           Cmd->Speed);
+   
+   UpdateRates(TxStats, DropCnt, (ActiveCnt > 0) ? ActiveCnt : 1);
+   
+} /* End RADIO_IF_UpdateTxStats() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_DutyBudgetRemaining
+**
+*/
+uint32 RADIO_IF_DutyBudgetRemaining(void)
+{
+   
+   uint32 Remaining;
+   
+   OS_MutSemTake(RadioIf->DutyMutex);
+   Remaining = TX_DUTY_Remaining(&RadioIf->Duty, GetTimeMs());
+   OS_MutSemGive(RadioIf->DutyMutex);
+   
+   return Remaining;
+   
+} /* End RADIO_IF_DutyBudgetRemaining() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_AdrDwellTime
+**
+*/
+uint32 RADIO_IF_AdrDwellTime(uint8 Profile)
+{
+   
+   uint32 DwellTime = 0;
+   
+   if (Profile < RadioIf->Adr.ProfileCnt)
+   {
+      DwellTime = TX_ADR_DwellMs(&RadioIf->Adr, Profile, GetTimeMs()) / 1000;
+   }
+   
+   return DwellTime;
+   
+} /* End RADIO_IF_AdrDwellTime() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_InitRadio
+**
+** Notes:
+**   1. The radios are initialized by their child tasks, see InitRadio().
+**   2. The command always resets the radios, a warm start is only used at
+**      startup. A reset is how a radio in an unknown state is recovered.
+**   3. Without a profile the time on air model returns to the default
+**      preamble a previous profile may have changed.
+**
+*/
+bool RADIO_IF_InitRadioCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   uint8 i;
+   
+   for (i = 0; i < RadioIf->RadioCnt; i++)
+   {
+      if (RadioIf->Radio[i].InitReq != RADIO_IF_INIT_NONE)
+      {
+         CFE_EVS_SendEvent(RADIO_TX_INIT_RADIO_CMD_EID, CFE_EVS_EventType_ERROR,
+                           "Init radio command rejected, Radio %d initialization in progress", i);
+         return false;
+      }
+   }
+   
+   if (!RadioIf->RadioConfig.ProfileSet && RadioIf->RadioConfig.PreambleLen != RADIO_TX_PREAMBLE_LEN)
+   {
+      RadioIf->RadioConfig.PreambleLen = RADIO_TX_PREAMBLE_LEN;
+      RadioIf->RadioConfig.LoRaGen++;
+   }
+   
+   for (i = 0; i < RadioIf->RadioCnt; i++)
+   {
+      RadioIf->Radio[i].InitReq = RADIO_IF_INIT_COLD;
+      OS_BinSemGive(RadioIf->Radio[i].WakeupSem);
+   }
+   
+   CFE_EVS_SendEvent(RADIO_TX_INIT_RADIO_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                     "Initializing %d radio(s), each radio's child task reports its result",
+                     RadioIf->RadioCnt);
+   
+   return true;
+   
+} /* RADIO_IF_InitRadioCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SendRadioTlmCmd
+**
+** Notes:
+**   1. See radio_if.h file prologue for data source details.
+**   2. RadioFrequency is the programmed frequency rounded to MHz so it
+**      reflects the current channel when hopping.
+**   3. A message is sent for each radio.
+*/
+bool RADIO_IF_SendRadioTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   LORA_TX_RadioTlm_Payload_t *RadioTlmPayload = &RadioIf->RadioTlm.Payload;
+   const RADIO_TX_Shadow_t    *Shadow;
+   const RadioCfg_t           *Cfg;
+   RADIO_IF_Radio_t           *Radio;
+   uint8 i;
+   
+   for (i = 0; i < RadioIf->RadioCnt; i++)
+   {
+      
+      Radio  = &RadioIf->Radio[i];
+      Cfg    = &RadioCfg[i];
+      Shadow = RADIO_TX_GetShadow(i);
+      
+      RadioTlmPayload->Radio = i;
+      strncpy(RadioTlmPayload->SpiDevStr, INITBL_GetStrConfig(RadioIf->IniTbl, Cfg->SpiDevStr), OS_MAX_PATH_LEN - 1);
+      RadioTlmPayload->SpiDevNum    = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->SpiDevNum);
+      RadioTlmPayload->RadioPinBusy = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinBusy);
+      RadioTlmPayload->RadioPinNrst = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinNrst);
+      RadioTlmPayload->RadioPinNss  = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinNss);
+      RadioTlmPayload->RadioPinDio1 = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinDio1);
+      RadioTlmPayload->RadioPinDio2 = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinDio2);
+      RadioTlmPayload->RadioPinDio3 = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinDio3);
+      RadioTlmPayload->RadioPinTxEn = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinTxEn);
+      RadioTlmPayload->RadioPinRxEn = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinRxEn);
+      
+      RadioTlmPayload->RadioWriteCnt     = Shadow->WriteCnt;
+      RadioTlmPayload->RadioWriteSkipCnt = Shadow->SkipCnt;
+      
+      if (Radio->Initialized && Shadow->Valid)
+      {
+         RadioTlmPayload->RadioProgrammed     = APP_C_FW_BooleanUint8_TRUE;
+         RadioTlmPayload->SpiSpeed            = Shadow->SpiSpeed;
+         RadioTlmPayload->RadioFrequency      = (Shadow->Frequency + 500000) / 1000000;
+         RadioTlmPayload->RfFrequencyHz       = Shadow->Frequency;
+         RadioTlmPayload->LoRaSpreadingFactor = Shadow->SpreadingFactor;
+         RadioTlmPayload->LoRaBandwidth       = Shadow->Bandwidth;
+         RadioTlmPayload->LoRaCodingRate      = Shadow->CodingRate;
+         RadioTlmPayload->TxPower             = Shadow->TxPower;
+         RadioTlmPayload->PreambleLength      = Shadow->PreambleLen;
+         RadioTlmPayload->PayloadLength       = Shadow->PayloadLen;
+      }
+      else
+      {
+         RadioTlmPayload->RadioProgrammed     = APP_C_FW_BooleanUint8_FALSE;
+         RadioTlmPayload->SpiSpeed            = Radio->SpiSpeed;
+         RadioTlmPayload->RadioFrequency      = Radio->Frequency;
+         RadioTlmPayload->RfFrequencyHz       = Radio->Frequency*1000000UL;
+         RadioTlmPayload->LoRaSpreadingFactor = RadioIf->RadioConfig.LoRa.SpreadingFactor;
+         RadioTlmPayload->LoRaBandwidth       = RadioIf->RadioConfig.LoRa.Bandwidth;
+         RadioTlmPayload->LoRaCodingRate      = RadioIf->RadioConfig.LoRa.CodingRate;
+         RadioTlmPayload->TxPower             = 0;
+         RadioTlmPayload->PreambleLength      = RADIO_TX_PREAMBLE_LEN;
+         RadioTlmPayload->PayloadLength       = 0;
+      }
+      
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(RadioIf->RadioTlm.TelemetryHeader));
+      CFE_SB_TransmitMsg(CFE_MSG_PTR(RadioIf->RadioTlm.TelemetryHeader), true);
+   
+   } /* End radio loop */
+   
+   CFE_EVS_SendEvent(RADIO_TX_SEND_RADIO_TLM_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                     "Sent Radio configuration telemetry for %d radios", RadioIf->RadioCnt);
+   return true;
+   
+} /* RADIO_IF_SendRadioTlmCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SendPerfTlm
+**
+** Notes:
+**   1. The histograms are written by the child tasks without a lock. A
+**      sample recorded while the packet is being filled can make a stage's
+**      count and buckets differ by one which is acceptable for telemetry.
+**   2. Each stage reports the merge of every radio's histogram.
+**
+*/
+void RADIO_IF_SendPerfTlm(void)
+{
+   
+   LORA_TX_LatencyHist_t *Tlm[RADIO_IF_PERF_STAGE_CNT];
+   TX_HIST_Class_t Hist;
+   uint8 i;
+   uint8 r;
+   
+   Tlm[RADIO_IF_PERF_DEQUEUE]   = &RadioIf->PerfTlm.Payload.Dequeue;
+   Tlm[RADIO_IF_PERF_ENCODE]    = &RadioIf->PerfTlm.Payload.Encode;
+   Tlm[RADIO_IF_PERF_SPI_WRITE] = &RadioIf->PerfTlm.Payload.SpiWrite;
+   Tlm[RADIO_IF_PERF_TX_DONE]   = &RadioIf->PerfTlm.Payload.TxDoneWait;
+   
+   for (i = 0; i < RADIO_IF_PERF_STAGE_CNT; i++)
+   {
+      TX_HIST_Constructor(&Hist);
+      for (r = 0; r < RadioIf->RadioCnt; r++)
+      {
+         TX_HIST_Merge(&Hist, &RadioIf->Radio[r].PerfHist[i]);
+      }
+      Tlm[i]->Cnt    = Hist.Cnt;
+      Tlm[i]->MeanUs = TX_HIST_MeanUs(&Hist);
+      Tlm[i]->P50Us  = TX_HIST_PercentileUs(&Hist, 50);
+      Tlm[i]->P99Us  = TX_HIST_PercentileUs(&Hist, 99);
+      Tlm[i]->MaxUs  = Hist.MaxUs;
+      memcpy(Tlm[i]->Bucket, Hist.Bucket, sizeof(Tlm[i]->Bucket));
+   }
+   
+   CFE_SB_TimeStampMsg(CFE_MSG_PTR(RadioIf->PerfTlm.TelemetryHeader));
+   CFE_SB_TransmitMsg(CFE_MSG_PTR(RadioIf->PerfTlm.TelemetryHeader), true);
+   
+} /* End RADIO_IF_SendPerfTlm() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SendPerfTlmCmd
+**
+*/
+bool RADIO_IF_SendPerfTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   RADIO_IF_SendPerfTlm();
+   
+   CFE_EVS_SendEvent(RADIO_TX_SEND_PERF_TLM_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                     "Sent radio pipeline latency telemetry message");
+   return true;
+   
+} /* End RADIO_IF_SendPerfTlmCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SetLoRaParamsCmd
+**
+** Notes:
+**   1. The parameters are validated by the time on air model which must
+**      cover every parameter the radio accepts.
+**   2. Manually setting the parameters disables the adaptive data rate
+**      controller so it doesn't override them.
+**   3. Each radio's child task programs the parameters before its next
+**      packet.
+**   4. The selected profile's other settings remain programmed but the
+**      profile is no longer reported as selected.
+*/
+bool RADIO_IF_SetLoRaParamsCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_SetLoRaParams_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetLoRaParams_t);
+   bool RetStatus = false;
+   
+   if (!RADIO_IF_Initialized())
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_LORA_PARAMS_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set LoRa parameters failed, Radio not initialized");
+   }
+   else if (TX_TOA_Compute(&RadioIf->Toa, Cmd->SpreadingFactor, Cmd->Bandwidth, Cmd->CodingRate,
+                           RadioIf->RadioConfig.PreambleLen, 0, TX_TOA_HDR_EXPLICIT) == 0)
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_LORA_PARAMS_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set LoRa parameters failed, invalid parameter: SF=0x%02X, BW=0x%02X, CR=%d",
+                        Cmd->SpreadingFactor, Cmd->Bandwidth, Cmd->CodingRate);
+   }
+   else
+   {
+      if (RadioIf->Adr.Enabled)
+      {
+         RadioIf->Adr.Enabled = false;
+         CFE_EVS_SendEvent(RADIO_TX_SET_LORA_PARAMS_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                           "Adaptive data rate disabled by set LoRa parameters command");
+      }
+      RadioIf->RadioConfig.LoRa.SpreadingFactor = Cmd->SpreadingFactor;
+      RadioIf->RadioConfig.LoRa.Bandwidth       = Cmd->Bandwidth;
+      RadioIf->RadioConfig.LoRa.CodingRate      = Cmd->CodingRate;
+      RadioIf->RadioConfig.ProfileSet = false;
+      RadioIf->RadioConfig.ProfileName[0] = '\0';
+      RadioIf->RadioConfig.LoRaGen++;
+      CFE_EVS_SendEvent(RADIO_TX_SET_LORA_PARAMS_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                        "Set LoRa paramaters: SF=%d, BW=%d, RC=%d", Cmd->SpreadingFactor,
+                        Cmd->Bandwidth, Cmd->CodingRate);
+      
+      RetStatus = true;
+   }
+   
+   return RetStatus;
+   
+} /* RADIO_IF_SetLoRaParamsCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SelectProfileCmd
+**
+** Notes:
+**   1. Profiles are validated and compiled when the table is loaded so the
+**      command only looks up the name.
+**   2. Like setting the LoRa parameters, selecting a profile disables the
+**      adaptive data rate controller. A profile that sets the frequency
+**      also disables frequency hopping and becomes each radio's configured
+**      frequency.
+**   3. The image is copied so a table reload doesn't change the selected
+**      profile. It's written to the image the child tasks aren't using
+**      before LoRaGen is incremented.
+*/
+bool RADIO_IF_SelectProfileCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_SelectProfile_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SelectProfile_t);
+   RADIO_IF_Config *RadioConfig = &RadioIf->RadioConfig;
+   const PROFILE_TBL_Entry_t *Entry;
+   const RADIO_TX_Profile_t  *Profile;
+   char  Name[PROFILE_TBL_NAME_LEN];
+   bool  RetStatus = false;
+   uint8 Image;
+   uint8 i;
+   
+   strncpy(Name, Cmd->Name, PROFILE_TBL_NAME_LEN - 1);
+   Name[PROFILE_TBL_NAME_LEN - 1] = '\0';
+   
+   Entry = PROFILE_TBL_Find(Name);
+   if (Entry == NULL)
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SELECT_PROFILE_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Select profile failed, %s isn't in the profile table", Name);
+   }
+   else
+   {
+      
+      Profile = &Entry->Profile;
+      
+      if (RadioIf->Adr.Enabled)
+      {
+         RadioIf->Adr.Enabled = false;
+         CFE_EVS_SendEvent(RADIO_TX_SELECT_PROFILE_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                           "Adaptive data rate disabled by select profile command");
+      }
+      if (Profile->Frequency != 0)
+      {
+         for (i = 0; i < RadioIf->RadioCnt; i++)
+         {
+            if (RadioIf->Radio[i].Hop.Enabled)
+            {
+               RadioIf->Radio[i].Hop.Enabled = false;
+               CFE_EVS_SendEvent(RADIO_TX_SELECT_PROFILE_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                                 "Frequency hopping disabled on radio %d by select profile command", i);
+            }
+            RadioIf->Radio[i].Frequency = Profile->Frequency / 1000000;
+         }
+      }
+      
+      Image = RadioConfig->ImageCur ^ 1;
+      memcpy(&RadioConfig->Image[Image], &Entry->Image, sizeof(RADIO_TX_Image_t));
+      RadioConfig->ImageCur = Image;
+      strncpy(RadioConfig->ProfileName, Entry->Name, PROFILE_TBL_NAME_LEN);
+      RadioConfig->LoRa.SpreadingFactor = Profile->SpreadingFactor;
+      RadioConfig->LoRa.Bandwidth       = Profile->Bandwidth;
+      RadioConfig->LoRa.CodingRate      = Profile->CodingRate;
+      RadioConfig->PreambleLen          = Profile->PreambleLen;
+      RadioConfig->ProfileSet = true;
+      RadioConfig->LoRaGen++;
+      
+      CFE_EVS_SendEvent(RADIO_TX_SELECT_PROFILE_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                        "Selected profile %s: SF=0x%02X, BW=0x%02X, CR=%d, preamble %d, %d dBm",
+                        Entry->Name, Profile->SpreadingFactor, Profile->Bandwidth, Profile->CodingRate,
+                        Profile->PreambleLen, Profile->TxPower);
+      RetStatus = true;
+   
    }
+   
+   return RetStatus;
+   
+} /* RADIO_IF_SelectProfileCmd() */
+
 
+/******************************************************************************
+** Function: RADIO_IF_SetAdrCmd
+**
+** Notes:
+**   1. The child task switches to the most robust profile that meets the
+**      new margin before its next packet.
+*/
+bool RADIO_IF_SetAdrCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_SetAdr_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetAdr_t);
+   bool RetStatus = false;
+   
+   if (RadioIf->Adr.ProfileCnt == 0)
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_ADR_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set ADR failed, no valid profiles were loaded from the init file");
+   }
+   else
+   {
+      RadioIf->Adr.MarginReq = Cmd->MarginDb;
+      RadioIf->Adr.Enabled   = (Cmd->Enable == APP_C_FW_BooleanUint8_TRUE);
+      CFE_EVS_SendEvent(RADIO_TX_SET_ADR_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                        "Adaptive data rate %s with a %d dB margin",
+                        RadioIf->Adr.Enabled ? "enabled" : "disabled", RadioIf->Adr.MarginReq);
+      RetStatus = true;
+   }
+   
    return RetStatus;
    
-} /* RADIO_IF_SetSpiSpeedCmd() */
+} /* RADIO_IF_SetAdrCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SetHoppingCmd
+**
+** Notes:
+**   1. The channel table is loaded from the init file by the constructor.
+**   2. Applies to every radio. Disabling hopping returns each radio to its
+**      configured frequency.
+*/
+bool RADIO_IF_SetHoppingCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_SetHopping_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetHopping_t);
+   RADIO_IF_Radio_t *Radio;
+   bool  RetStatus = false;
+   uint8 i;
+   
+   if (!RADIO_IF_Initialized())
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_HOPPING_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set hopping failed, Radio not initialized");
+   }
+   else if (RadioIf->Radio[0].Hop.ChanCnt == 0)
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_HOPPING_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set hopping failed, no valid channels were loaded from the init file");
+   }
+   else
+   {
+      for (i = 0; i < RadioIf->RadioCnt; i++)
+      {
+         Radio = &RadioIf->Radio[i];
+         if (Cmd->PktsPerHop > 0)
+         {
+            Radio->Hop.PktsPerHop = Cmd->PktsPerHop;
+         }
+         if (Cmd->Enable == APP_C_FW_BooleanUint8_TRUE)
+         {
+            TX_HOP_Restart(&Radio->Hop);
+            Radio->Hop.Enabled = true;
+         }
+         else if (Radio->Hop.Enabled)
+         {
+            Radio->Hop.Enabled = false;
+            Radio->CfgGen++;
+         }
+      }
+      CFE_EVS_SendEvent(RADIO_TX_SET_HOPPING_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                        "Frequency hopping %s, %d channels, %d packets per hop",
+                        RadioIf->Radio[0].Hop.Enabled ? "enabled" : "disabled", RadioIf->Radio[0].Hop.ChanCnt,
+                        RadioIf->Radio[0].Hop.PktsPerHop);
+      RetStatus = true;
+   }
+   
+   return RetStatus;
+   
+} /* RADIO_IF_SetHoppingCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SetRadioFrequencyCmd
+**
+** Notes:
+**   1. The frequency must be in the SX128x band, TX_HOP_FREQ_MIN to
+**      TX_HOP_FREQ_MAX.
+**   2. Frequency hopping is disabled so the frequency isn't overridden.
+**   3. The radio's child task programs the frequency before its next packet,
+**      see ApplyLoRa().
+*/
+bool RADIO_IF_SetRadioFrequencyCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_SetRadioFrequency_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetRadioFrequency_t);
+   RADIO_IF_Radio_t *Radio;
+   bool RetStatus = false;
+   
+   if (Cmd->Radio >= RadioIf->RadioCnt)
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set radio frequency failed, invalid radio %d. %d radios configured",
+                        Cmd->Radio, RadioIf->RadioCnt);
+   }
+   else if ((uint64)Cmd->Frequency*1000000 >= TX_HOP_FREQ_MIN && (uint64)Cmd->Frequency*1000000 <= TX_HOP_FREQ_MAX)
+   {
+      Radio = &RadioIf->Radio[Cmd->Radio];
+      if (Radio->Initialized)
+      {
+         if (Radio->Hop.Enabled)
+         {
+            Radio->Hop.Enabled = false;
+            CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                              "Frequency hopping disabled on radio %d by set radio frequency command",
+                              Cmd->Radio);
+         }
+         Radio->Frequency = Cmd->Frequency;
+         Radio->CfgGen++;
+         CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                           "Set radio %d frequency to %d Mhz, applied before its next packet",
+                           Cmd->Radio, Cmd->Frequency);
+         RetStatus = true;
+      }
+      else
+      {
+         CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_ERROR,
+                           "Set radio frequency failed, Radio %d not initialized", Cmd->Radio);
+      }
+   
+   }
+   else
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID, CFE_EVS_EventType_ERROR,
+                           "Set radio frequency failed, frequency %u MHz is outside the %lu..%lu MHz band",
+                           (unsigned int)Cmd->Frequency, TX_HOP_FREQ_MIN / 1000000, TX_HOP_FREQ_MAX / 1000000);
+   }
+   
+   return RetStatus;
+   
+} /* RADIO_IF_SetRadioFrequencyCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_SetSpiSpeedCmd
+**
+** Notes:
+**   1. TODO: What is a valid speed range
+**   2. Applies to every radio. Each radio's child task changes the speed
+**      before its next packet, see ApplyLoRa().
+*/
+bool RADIO_IF_SetSpiSpeedCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_SetSpiSpeed_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_SetSpiSpeed_t);
+   bool  RetStatus = false;
+   uint8 i;
+   
+   if (Cmd->Speed >= 0 && Cmd->Speed <= 8000000)
+   {
+      if (RADIO_IF_Initialized())
+      {
+         RadioIf->SpiSpeed = Cmd->Speed;
+         for (i = 0; i < RadioIf->RadioCnt; i++)
+         {
+            RadioIf->Radio[i].SpiSpeed = Cmd->Speed;
+            RadioIf->Radio[i].CfgGen++;
+         }
+         CFE_EVS_SendEvent(RADIO_TX_SET_SPI_SPEED_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                           "Set radio SPI speed to %d", Cmd->Speed);
+         RetStatus = true;
+      }
+      else
+      {
+         CFE_EVS_SendEvent(RADIO_TX_SET_SPI_SPEED_CMD_EID, CFE_EVS_EventType_ERROR,
+                           "Set radio SPI speed failed, Radio not initialized");
+      }
+   
+   }
+   else
+   {
+      CFE_EVS_SendEvent(RADIO_TX_SET_SPI_SPEED_CMD_EID, CFE_EVS_EventType_ERROR,
+                           "Set radio SPI speed failed, invalid speed %d.",
+                           Cmd->Speed);
+   }
+   
+   return RetStatus;
+   
+} /* RADIO_IF_SetSpiSpeedCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_StartFileTransferCmd
+**
+** Notes:
+**   1. The child task opens the file and performs the transfer so the command
+**      only validates the request's context.
+*/
+bool RADIO_IF_StartFileTransferCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_StartFileTransfer_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_StartFileTransfer_t);
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   bool  RetStatus = false;
+   uint8 i;
+   
+   if (RADIO_IF_Initialized())
+   {
+      if (FileXfer->Active || FileXfer->StartReq)
+      {
+         CFE_EVS_SendEvent(RADIO_TX_START_FILE_XFER_CMD_EID, CFE_EVS_EventType_ERROR,
+                           "Start file transfer rejected, transfer of %s in progress",
+                           FileXfer->Filename);
+      }
+      else
+      {
+         strncpy(FileXfer->Filename, Cmd->Filename, OS_MAX_PATH_LEN - 1);
+         FileXfer->Filename[OS_MAX_PATH_LEN - 1] = '\0';
+         FileXfer->Compress = (Cmd->Compress == APP_C_FW_BooleanUint8_TRUE);
+         FileXfer->StopReq  = false;
+         FileXfer->StartReq = true;
+         for (i = 0; i < RadioIf->RadioCnt; i++)
+         {
+            OS_BinSemGive(RadioIf->Radio[i].WakeupSem);
+         }
+         CFE_EVS_SendEvent(RADIO_TX_START_FILE_XFER_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                           "Start %sfile transfer of %s accepted",
+                           FileXfer->Compress ? "compressed " : "", FileXfer->Filename);
+         RetStatus = true;
+      }
+   }
+   else
+   {
+      CFE_EVS_SendEvent(RADIO_TX_START_FILE_XFER_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Start file transfer failed, Radio not initialized");
+   }
+   
+   return RetStatus;
+   
+} /* RADIO_IF_StartFileTransferCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_StopFileTransferCmd
+**
+*/
+bool RADIO_IF_StopFileTransferCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   bool RetStatus = false;
+   
+   if (FileXfer->Active || FileXfer->StartReq)
+   {
+      FileXfer->StopReq = true;
+      CFE_EVS_SendEvent(RADIO_TX_STOP_FILE_XFER_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                        "Stop file transfer of %s requested", FileXfer->Filename);
+      RetStatus = true;
+   }
+   else
+   {
+      CFE_EVS_SendEvent(RADIO_TX_STOP_FILE_XFER_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Stop file transfer failed, no transfer in progress");
+   }
+   
+   return RetStatus;
+   
+} /* RADIO_IF_StopFileTransferCmd() */
+
+
+/******************************************************************************
+** Function: RADIO_IF_EstimateFileTransferCmd
+**
+** Notes:
+**   1. Uses the same packet layout as StartFileXfer() so the estimate
+**      includes the header packet, FEC headers and parity packets.
+**   2. The ETA is the total time on air. The time between packets is small
+**      compared to the time on air because the next block is prepared
+**      while the current block is on the air.
+**   3. A striped transfer's time on air is divided by the number of
+**      radios sending it.
+*/
+bool RADIO_IF_EstimateFileTransferCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   const LORA_TX_EstimateFileTransfer_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, LORA_TX_EstimateFileTransfer_t);
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   const TX_TOA_Active_t *Active = TX_TOA_GetActive(&RadioIf->Toa);
+   uint16 PktHdrLen = FileXfer->FecEnabled ? TX_FEC_HDR_LEN : 0;
+   uint32 DataPkts  = (Cmd->FileSize + FileXfer->DataLen - 1) / FileXfer->DataLen;
+   uint32 PktsTotal = DataPkts + 1;
+   uint32 LastLen   = Cmd->FileSize - (DataPkts > 0 ? (DataPkts - 1) * FileXfer->DataLen : 0);
+   char   HdrStr[RADIO_TX_MAX_PAYLOAD_LEN];
+   uint64 Airtime;
+   uint32 AirtimeMs;
+   uint32 Throughput = 0;
+   uint8  RadioCnt   = FileXferRadioCnt();
+   
+   snprintf(HdrStr, sizeof(HdrStr), "%u FEC %u %u", (unsigned int)DataPkts, FileXfer->Fec.K, FileXfer->Fec.M);
+   Airtime = Active->Toa[FileXfer->FecEnabled ? strlen(HdrStr) : strcspn(HdrStr, " ")];
+   
+   if (DataPkts > 0)
+   {
+      Airtime += (uint64)(DataPkts - 1) * Active->Toa[PktHdrLen + FileXfer->DataLen];
+      Airtime += Active->Toa[PktHdrLen + LastLen];
+   }
+   if (FileXfer->FecEnabled)
+   {
+      PktsTotal += ((DataPkts + FileXfer->Fec.K - 1) / FileXfer->Fec.K) * FileXfer->Fec.M;
+      Airtime   += (uint64)(PktsTotal - DataPkts - 1) * Active->Toa[FileXfer->BlockLen];
+   }
+   
+   Airtime  /= RadioCnt;
+   AirtimeMs = (uint32)((Airtime + 999) / 1000);
+   if (Airtime > 0)
+   {
+      Throughput = (uint32)(((uint64)Cmd->FileSize * 1000000) / Airtime);
+   }
+   
+   CFE_EVS_SendEvent(RADIO_TX_EST_FILE_XFER_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                     "File transfer estimate for %u bytes: %u packets, ETA %u.%03u s, %u bytes/s on %d radio(s). SF=0x%02X, BW=0x%02X, CR=%d",
+                     (unsigned int)Cmd->FileSize, (unsigned int)PktsTotal, 
+                     (unsigned int)(AirtimeMs / 1000), (unsigned int)(AirtimeMs % 1000), (unsigned int)Throughput, RadioCnt,
+                     Active->SpreadingFactor, Active->Bandwidth, Active->CodingRate);
+   
+   return true;
+   
+} /* RADIO_IF_EstimateFileTransferCmd() */
+
+
+/******************************************************************************
+** Function: InitRadio
+**
+** Initialize a radio with its own pins, SPI device and frequency
+**
+** Notes:
+**   1. Called by the radio's child task so a chip reset only delays this
+**      radio's packets and the SPI device is only accessed by one task.
+**   2. The radio isn't initialized while this runs so the producer and
+**      the other radios don't select it.
+**   3. A warm start requests that RADIO_TX_InitRadio() keep a radio that's
+**      still configured with the current LoRa parameters. A selected
+**      profile's image is applied after either kind of start and the
+**      shadow skips it when the radio already has it.
+**
+*/
+static void InitRadio(RADIO_IF_Radio_t *Radio)
+{
+   
+   RADIO_TX_Pin_t    RadioPin;
+   RADIO_TX_Config_t RadioConfig;
+   const RadioCfg_t  *Cfg = &RadioCfg[Radio->Id];
+   const char *SpiDevStr = INITBL_GetStrConfig(RadioIf->IniTbl, Cfg->SpiDevStr);
+   uint32 StartMs = GetTimeMs();
+   
+   RadioConfig.SpiSpeed        = Radio->SpiSpeed;
+   RadioConfig.Frequency       = Radio->Frequency*1000000UL;
+   RadioConfig.SpreadingFactor = RadioIf->RadioConfig.LoRa.SpreadingFactor;
+   RadioConfig.Bandwidth       = RadioIf->RadioConfig.LoRa.Bandwidth;
+   RadioConfig.CodingRate      = RadioIf->RadioConfig.LoRa.CodingRate;
+   RadioConfig.SpiBatch        = (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_SPI_BATCH) != 0);
+   RadioConfig.GpioChip        = (INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_GPIO_EVENTS) != 0) ?
+                                 INITBL_GetStrConfig(RadioIf->IniTbl, CFG_RADIO_GPIO_CHIP) : NULL;
+   RadioConfig.Backend         = RadioIf->Backend;
+   RadioConfig.SimBusyUs       = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_SIM_BUSY_US);
+   RadioConfig.SimLossPct      = INITBL_GetIntConfig(RadioIf->IniTbl, CFG_RADIO_SIM_LOSS_PCT);
+   RadioConfig.SimOutput       = INITBL_GetStrConfig(RadioIf->IniTbl, Cfg->SimOutput);
+   RadioConfig.WarmStart       = (Radio->InitReq == RADIO_IF_INIT_WARM);
+   
+   RadioPin.Busy = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinBusy);
+   RadioPin.Nrst = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinNrst);
+   RadioPin.Nss  = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinNss);
+   RadioPin.Dio1 = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinDio1);
+   RadioPin.Dio2 = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinDio2);
+   RadioPin.Dio3 = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinDio3);
+   RadioPin.TxEn = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinTxEn);
+   RadioPin.RxEn = INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->PinRxEn);
+   
+   Radio->Initialized   = false;
+   Radio->StagedPayload = NULL;
+   Radio->LoRaGen       = RadioIf->RadioConfig.LoRaGen;
+   Radio->CfgGenApplied = Radio->CfgGen;
+   Radio->Initialized   = RADIO_TX_InitRadio(Radio->Id, SpiDevStr,
+                                             INITBL_GetIntConfig(RadioIf->IniTbl, Cfg->SpiDevNum),
+                                             &RadioPin, &RadioConfig);
+   
+   if (Radio->Initialized)
+   {
+      if (RadioIf->RadioConfig.ProfileSet)
+      {
+         RADIO_TX_ApplyImage(Radio->Id, &RadioIf->RadioConfig.Image[RadioIf->RadioConfig.ImageCur]);
+      }
+      TX_HOP_Restart(&Radio->Hop);
+      if (RadioIf->Backend == RADIO_TX_BACKEND_SIM)
+      {
+         CFE_EVS_SendEvent(RADIO_IF_INIT_RADIO_EID, CFE_EVS_EventType_INFORMATION,
+                           "Sucessfully initialized the simulated Radio %d in %u ms, frame output %s",
+                           Radio->Id, (unsigned int)(GetTimeMs() - StartMs), RadioConfig.SimOutput);
+      }
+      else
+      {
+         CFE_EVS_SendEvent(RADIO_IF_INIT_RADIO_EID, CFE_EVS_EventType_INFORMATION,
+                           "Sucessfully initialized Radio %d in %u ms, %s start, BUSY/DIO1 %s",
+                           Radio->Id, (unsigned int)(GetTimeMs() - StartMs),
+                           RADIO_TX_WarmStarted(Radio->Id) ? "warm" : "cold",
+                           RADIO_TX_GpioEventsActive(Radio->Id) ? "line events" : "polled");
+      }
+   }
+   else if (RadioConfig.SpiBatch && RadioConfig.Backend == RADIO_TX_BACKEND_SX128X &&
+            RadioPin.Nss != RADIO_TX_SpiCeGpio(SpiDevStr))
+   {
+      CFE_EVS_SendEvent(RADIO_IF_INIT_RADIO_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to initialize Radio %d, SPI batching requires NSS GPIO %d to be %s's chip select GPIO %d",
+                        Radio->Id, RadioPin.Nss, SpiDevStr, RADIO_TX_SpiCeGpio(SpiDevStr));
+   }
+   else
+   {
+      CFE_EVS_SendEvent(RADIO_IF_INIT_RADIO_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to initialize Radio %d", Radio->Id);
+   }
+   
+   Radio->InitReq = RADIO_IF_INIT_NONE;
+   
+} /* End InitRadio() */
+
+
+/******************************************************************************
+** Function: ApplyAdr
+**
+** Notes:
+**   1. The backlog is the queued airtime of every radio's rings plus the
+**      airtime of the remaining file transfer packets at the current LoRa
+**      parameters. When striping it's divided by the number of initialized
+**      radios because they drain the backlog in parallel.
+**   2. Queued ring payloads are sent with the new profile. The ring's
+**      backlog keeps the airtime estimated when they were queued.
+**   3. Each radio's child task programs the new profile, see ApplyLoRa(),
+**      after ApplyToa() rebuilds the time on air table.
+*/
+static void ApplyAdr(void)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   const TX_ADR_Profile_t *Profile;
+   uint64 Backlog = 0;
+   uint8  ActiveCnt = 0;
+   uint8  i;
+   uint8  r;
+   
+   if (!RadioIf->Adr.Enabled)
+   {
+      return;
+   }
+   
+   for (r = 0; r < RadioIf->RadioCnt; r++)
+   {
+      for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
+      {
+         Backlog += TX_RING_Airtime(&RadioIf->Radio[r].TxRing[i]);
+      }
+      if (RadioIf->Radio[r].Initialized)
+      {
+         ActiveCnt++;
+      }
+   }
+   if (FileXfer->Active && FileXfer->PktsTotal > FileXfer->PktsSent)
+   {
+      Backlog += (uint64)(FileXfer->PktsTotal - FileXfer->PktsSent) * TX_TOA_Get(&RadioIf->Toa, FileXfer->BlockLen);
+   }
+   if (RadioIf->Stripe && ActiveCnt > 1)
+   {
+      Backlog /= ActiveCnt;
+   }
+   if (Backlog > UINT32_MAX)
+   {
+      Backlog = UINT32_MAX;
+   }
+   
+   if (TX_ADR_Select(&RadioIf->Adr, (uint32)Backlog, GetTimeMs()))
+   {
+      
+      Profile = &RadioIf->Adr.Profile[RadioIf->Adr.Cur];
+      
+      RadioIf->RadioConfig.LoRa.SpreadingFactor = Profile->SpreadingFactor;
+      RadioIf->RadioConfig.LoRa.Bandwidth       = Profile->Bandwidth;
+      RadioIf->RadioConfig.LoRa.CodingRate      = Profile->CodingRate;
+      RadioIf->RadioConfig.ProfileSet = false;
+      RadioIf->RadioConfig.ProfileName[0] = '\0';
+      RadioIf->RadioConfig.LoRaGen++;
+      
+      CFE_EVS_SendEvent(RADIO_IF_ADR_EID, CFE_EVS_EventType_INFORMATION,
+                        "ADR selected profile %d: SF=0x%02X, BW=0x%02X, CR=%d, backlog %u ms",
+                        RadioIf->Adr.Cur, Profile->SpreadingFactor, Profile->Bandwidth, Profile->CodingRate,
+                        (unsigned int)(Backlog / 1000));
+   }
+   
+} /* End ApplyAdr() */
+
+
+/******************************************************************************
+** Function: ApplyToa
+**
+** Rebuild the time on air table if the LoRa parameters changed
+**
+** Notes:
+**   1. Only called by the primary radio's child task so the table has a
+**      single writer. Commands only post changes and increment LoRaGen.
+**   2. The table is double buffered so the other tasks' lookups are never
+**      made from a partially built table.
+**
+*/
+static void ApplyToa(void)
+{
+   
+   RADIO_IF_Config *RadioConfig = &RadioIf->RadioConfig;
+   uint32 LoRaGen = RadioConfig->LoRaGen;
+   
+   if (RadioIf->ToaLoRaGen != LoRaGen)
+   {
+      TX_TOA_SetActive(&RadioIf->Toa, RadioConfig->LoRa.SpreadingFactor, RadioConfig->LoRa.Bandwidth,
+                       RadioConfig->LoRa.CodingRate, RadioConfig->PreambleLen);
+      RadioIf->ToaLoRaGen = LoRaGen;
+   }
+   
+} /* End ApplyToa() */
+
+
+/******************************************************************************
+** Function: ApplyLoRa
+**
+** Program the current LoRa parameters and the radio's configuration if they
+** changed since the radio was last programmed
+**
+** Notes:
+**   1. Called by the radio's child task between packets so the radio's SPI
+**      device, batch, shadow and staging state are only accessed by one
+**      task. Commands only post changes and increment a generation.
+**   2. A selected profile is programmed as a whole from its compiled image.
+**   3. The configured frequency is only programmed when hopping is
+**      disabled, otherwise the next hop sets the frequency. The shadow
+**      skips settings that didn't change.
+**   4. A LoRaGen change is applied once the time on air table has been
+**      rebuilt for it so a packet's pacing and TX done timeout always
+**      match the parameters it's sent with.
+**
+*/
+static void ApplyLoRa(RADIO_IF_Radio_t *Radio)
+{
+   
+   uint32 LoRaGen = RadioIf->ToaLoRaGen;
+   uint32 CfgGen  = Radio->CfgGen;
+   
+   if (Radio->CfgGenApplied != CfgGen)
+   {
+      Radio->CfgGenApplied = CfgGen;
+      RADIO_TX_SetSpiSpeed(Radio->Id, Radio->SpiSpeed);
+      if (!Radio->Hop.Enabled)
+      {
+         RADIO_TX_SetRadioFrequency(Radio->Id, Radio->Frequency*1000000UL);
+      }
+   }
+   
+   if (Radio->LoRaGen != LoRaGen)
+   {
+      Radio->LoRaGen = LoRaGen;
+      if (RadioIf->RadioConfig.ProfileSet)
+      {
+         RADIO_TX_ApplyImage(Radio->Id, &RadioIf->RadioConfig.Image[RadioIf->RadioConfig.ImageCur]);
+      }
+      else
+      {
+         RADIO_TX_SetLoraParams(Radio->Id, RadioIf->RadioConfig.LoRa.SpreadingFactor,
+                                RadioIf->RadioConfig.LoRa.Bandwidth,
+                                RadioIf->RadioConfig.LoRa.CodingRate);
+      }
+   }
+   
+} /* End ApplyLoRa() */
+
+
+/******************************************************************************
+** Function: PrimaryRadio
+**
+** Return the first initialized radio or radio 0 if none are initialized
+**
+*/
+static uint8 PrimaryRadio(void)
+{
+   
+   uint8 i;
+   
+   for (i = 0; i < RadioIf->RadioCnt; i++)
+   {
+      if (RadioIf->Radio[i].Initialized)
+      {
+         return i;
+      }
+   }
+   
+   return 0;
+   
+} /* End PrimaryRadio() */
+
+
+/******************************************************************************
+** Function: SlotRadio
+**
+** Return the radio whose ring receives a class's next payload
+**
+** Notes:
+**   1. Without striping every payload is sent by the primary radio. With
+**      striping the initialized radio with the least queued airtime for
+**      the class is selected so the radios share the load.
+**   2. The selection is held from RADIO_IF_PayloadSlot() until
+**      RADIO_IF_QueuePayload() so the payload is queued in the ring whose
+**      slot was filled.
+**
+*/
+static RADIO_IF_Radio_t *SlotRadio(uint8 Class)
+{
+   
+   RADIO_IF_Radio_t *Radio;
+   uint32 Airtime;
+   uint32 MinAirtime = UINT32_MAX;
+   uint8  i;
+   
+   if (!RadioIf->SlotHeld[Class])
+   {
+      
+      RadioIf->SlotRadio[Class] = PrimaryRadio();
+      
+      if (RadioIf->Stripe)
+      {
+         for (i = 0; i < RadioIf->RadioCnt; i++)
+         {
+            Radio = &RadioIf->Radio[i];
+            if (Radio->Initialized && TX_RING_Space(&Radio->TxRing[Class]) > 0)
+            {
+               Airtime = TX_RING_Airtime(&Radio->TxRing[Class]);
+               if (Airtime < MinAirtime)
+               {
+                  MinAirtime = Airtime;
+                  RadioIf->SlotRadio[Class] = i;
+               }
+            }
+         }
+      }
+   }
+   
+   return &RadioIf->Radio[RadioIf->SlotRadio[Class]];
+   
+} /* End SlotRadio() */
+
+
+/******************************************************************************
+** Function: FileXferRadio
+**
+** Return true if a radio sends file transfer blocks
+**
+** Notes:
+**   1. Only FEC transfers are striped. Radios deliver their blocks out of
+**      order and the FEC header's sequence number lets the receiver place
+**      each block. Other transfers are sent by the primary radio.
+**
+*/
+static bool FileXferRadio(const RADIO_IF_Radio_t *Radio)
+{
+   
+   return Radio->Initialized && 
+          ((RadioIf->Stripe && RadioIf->FileXfer.FecEnabled) || Radio->Id == PrimaryRadio());
+   
+} /* End FileXferRadio() */
+
+
+/******************************************************************************
+** Function: FileXferRadioCnt
+**
+** Return the number of radios that send file transfer blocks, at least one
+**
+*/
+static uint8 FileXferRadioCnt(void)
+{
+   
+   uint8 RadioCnt = 0;
+   uint8 i;
+   
+   for (i = 0; i < RadioIf->RadioCnt; i++)
+   {
+      if (FileXferRadio(&RadioIf->Radio[i]))
+      {
+         RadioCnt++;
+      }
+   }
+   
+   return (RadioCnt > 0) ? RadioCnt : 1;
+   
+} /* End FileXferRadioCnt() */
+
+
+/******************************************************************************
+** Function: UpdateRates
+**
+** Compute a transmit statistics set's per second rates from its cumulative
+** counters
+**
+** Notes:
+**   1. AirEfficiency is the payload bytes sent per second of airtime during
+**      the last second. It measures how much of the airtime is spent on
+**      payload rather than preamble, header and CRC overhead.
+**   2. LinkUtil is the last second's airtime relative to the call period
+**      of RadioCnt radios. AirtimeTotal accumulates AirtimeCnt's deltas so
+**      the total airtime doesn't wrap after 71 minutes of microseconds.
+**
+*/
+static void UpdateRates(RADIO_IF_TxStats_t *TxStats, uint32 DropCnt, uint8 RadioCnt)
+{
+   
+   uint32 PktCnt     = TxStats->PktCnt;
+   uint32 ByteCnt    = TxStats->ByteCnt;
+   uint32 AirtimeCnt = TxStats->AirtimeCnt;
+   uint32 Airtime    = AirtimeCnt - TxStats->PrevAirtimeCnt;
+   uint32 RadioAirtime = Airtime / RadioCnt;
+   
+   TxStats->PktRate      = (uint16)(PktCnt - TxStats->PrevPktCnt);
+   TxStats->ByteRate     = ByteCnt - TxStats->PrevByteCnt;
+   TxStats->AirtimeRate  = (uint16)(Airtime / 1000);
+   TxStats->LinkUtil     = (RadioAirtime < 1000000) ? (uint8)((RadioAirtime + 5000) / 10000) : 100;
+   TxStats->AirtimeTotal += Airtime;
+   TxStats->DropRate     = (uint16)(DropCnt - TxStats->PrevDropCnt);
+   TxStats->DropCnt      = DropCnt;
+   if (Airtime > 0)
+   {
+      TxStats->AirEfficiency = (uint32)(((uint64)(ByteCnt - TxStats->PrevByteCnt) * 1000000) / Airtime);
+   }
+   else
+   {
+      TxStats->AirEfficiency = 0;
+   }
+   
+   TxStats->PrevPktCnt     = PktCnt;
+   TxStats->PrevByteCnt    = ByteCnt;
+   TxStats->PrevAirtimeCnt = AirtimeCnt;
+   TxStats->PrevDropCnt    = DropCnt;
+   
+} /* End UpdateRates() */
+
+
+/******************************************************************************
+** Function: GetTimeMs
+**
+*/
+static uint32 GetTimeMs(void)
+{
+   
+   OS_time_t LocalTime;
+   
+   OS_GetLocalTime(&LocalTime);
+   
+   return (uint32)OS_TimeGetTotalMilliseconds(LocalTime);
+   
+} /* End GetTimeMs() */
+
+
+/******************************************************************************
+** Function: GetTimeUs
+**
+** Notes:
+**   1. Uses the PSP's monotonic clock so latencies aren't affected by
+**      local time updates. Only differences are meaningful.
+**
+*/
+static uint32 GetTimeUs(void)
+{
+   
+   OS_time_t LocalTime;
+   
+   CFE_PSP_GetTime(&LocalTime);
+   
+   return (uint32)OS_TimeGetTotalMicroseconds(LocalTime);
+   
+} /* End GetTimeUs() */
+
+
+/******************************************************************************
+** Function: PerfBegin
+**
+** Mark the start of a pipeline stage in the CFE performance log
+**
+** Notes:
+**   1. Returns the stage's start time for PerfEnd().
+**
+*/
+static uint32 PerfBegin(RADIO_IF_Radio_t *Radio, uint8 Stage)
+{
+   
+   CFE_ES_PerfLogEntry(Radio->PerfId[Stage]);
+   
+   return GetTimeUs();
+   
+} /* End PerfBegin() */
+
+
+/******************************************************************************
+** Function: PerfEnd
+**
+** Mark the end of a pipeline stage in the CFE performance log
+**
+** Notes:
+**   1. Record is false when the stage didn't do its work, e.g. there was
+**      nothing to dequeue, so idle polls don't skew the histogram. The
+**      performance log exit is always paired with PerfBegin()'s entry.
+**
+*/
+static void PerfEnd(RADIO_IF_Radio_t *Radio, uint8 Stage, uint32 StartUs, bool Record)
+{
+   
+   if (Record)
+   {
+      TX_HIST_Add(&Radio->PerfHist[Stage], GetTimeUs() - StartUs);
+   }
+   
+   CFE_ES_PerfLogExit(Radio->PerfId[Stage]);
+   
+} /* End PerfEnd() */
+
+
+/******************************************************************************
+** Function: LoadSchedWeights
+**
+** Notes:
+**   1. WeightList is a comma or space separated list with one weight per
+**      transmit class.
+**   2. Returns false and sets every weight to one if the list is invalid.
+**
+*/
+static bool LoadSchedWeights(const char *WeightList, uint32 Weight[TX_SCHED_CLASS_CNT])
+{
+   
+   const char *WeightStr = WeightList;
+   char  *EndPtr;
+   uint8  WeightCnt = 0;
+   uint8  i;
+   
+   while (*WeightStr != '\0')
+   {
+      
+      if (*WeightStr == ',' || *WeightStr == ' ')
+      {
+         WeightStr++;
+         continue;
+      }
+      
+      if (WeightCnt >= TX_SCHED_CLASS_CNT)
+      {
+         break;
+      }
+      
+      Weight[WeightCnt] = strtoul(WeightStr, &EndPtr, 0);
+      if (EndPtr == WeightStr)
+      {
+         break;
+      }
+      WeightStr = EndPtr;
+      WeightCnt++;
+   
+   } /* End while weights */
+   
+   if (WeightCnt != TX_SCHED_CLASS_CNT || *WeightStr != '\0')
+   {
+      for (i = 0; i < TX_SCHED_CLASS_CNT; i++)
+      {
+         Weight[i] = 1;
+      }
+      return false;
+   }
+   
+   return true;
+   
+} /* End LoadSchedWeights() */
+
+
+/******************************************************************************
+** Function: SendNextPacket
+**
+** Send the radio's next packet selected by its transmit scheduler and
+** return false if there's nothing to send.
+**
+** Notes:
+**   1. A class is backlogged when its ring has a payload that hasn't missed
+**      its deadline or when it's the file transfer class and the radio has
+**      a file transfer block. Within a class ring payloads are sent first.
+**   2. When the duty cycle budget doesn't cover the selected packet's time
+**      on air the packet stays queued and the task waits for earlier charges
+**      to expire. The wait is bounded by the idle delay so requests and
+**      higher priority payloads are serviced while the link is throttled.
+**      The budget is shared by the radios so the check and the charge are
+**      made under the duty cycle mutex.
+**   3. A frequency hop is a single precomputed register write made after
+**      the previous packet's TxDone and before the next packet is loaded.
+**      It's batched with the packet's buffer write when SPI batching is
+**      enabled.
+**   4. The packet is charged to the scheduler before it's sent so the
+**      packet staged while it's on the air is the scheduler's next choice.
+**
+*/
+static bool SendNextPacket(RADIO_IF_Radio_t *Radio)
+{
+   
+   const TX_RING_Slot_t *Slot;
+   uint32 TimeMs = GetTimeMs();
+   uint32 Airtime;
+   uint32 DutyWait;
+   uint32 PerfUs;
+   uint8  Class;
+   
+   PerfUs = PerfBegin(Radio, RADIO_IF_PERF_DEQUEUE);
+   Class  = SelectPacket(Radio, TimeMs, &Slot);
+   if (Class == TX_SCHED_NONE)
+   {
+      PerfEnd(Radio, RADIO_IF_PERF_DEQUEUE, PerfUs, false);
+      return false;
+   }
+   
+   Airtime  = TX_TOA_Get(&RadioIf->Toa, (Slot != NULL) ? Slot->Len : Radio->FileBufLen[Radio->FileCur]);
+   OS_MutSemTake(RadioIf->DutyMutex);
+   DutyWait = TX_DUTY_Wait(&RadioIf->Duty, Airtime, TimeMs);
+   if (DutyWait == 0)
+   {
+      TX_DUTY_Charge(&RadioIf->Duty, Airtime, TimeMs);
+   }
+   OS_MutSemGive(RadioIf->DutyMutex);
+   PerfEnd(Radio, RADIO_IF_PERF_DEQUEUE, PerfUs, (DutyWait == 0));
+   if (DutyWait > 0)
+   {
+      OS_BinSemTimedWait(Radio->WakeupSem, (DutyWait < RADIO_IF_CHILD_IDLE_DELAY) ? DutyWait : RADIO_IF_CHILD_IDLE_DELAY);
+      OS_MutSemTake(RadioIf->DutyMutex);
+      TX_DUTY_Throttled(&RadioIf->Duty, GetTimeMs() - TimeMs, !Radio->DutyDeferred);
+      OS_MutSemGive(RadioIf->DutyMutex);
+      Radio->DutyDeferred = true;
+      return true;
+   }
+   Radio->DutyDeferred = false;
+   
+   RADIO_TX_BatchBegin(Radio->Id);
+   if (TX_HOP_Next(&Radio->Hop))
+   {
+      RADIO_TX_SetRfFrequencyReg(Radio->Id, Radio->Hop.FreqReg[Radio->Hop.Cur]);
+   }
+   
+   TX_SCHED_Charge(&Radio->Sched, Class, Airtime);
+   
+   if (Slot != NULL)
+   {
+      TX_SCHED_Latency(&Radio->Sched, Class, TimeMs - Slot->EnqueueMs);
+      SendRingPayload(Radio, Class, Slot, Airtime);
+   }
+   else
+   {
+      SendFileBlock(Radio, Airtime);
+   }
+   
+   return true;
+   
+} /* End SendNextPacket() */
+
+
+/******************************************************************************
+** Function: SelectPacket
+**
+** Select the class of the radio's next packet
+**
+** Notes:
+**   1. Slot is the class's ring payload or NULL when the file transfer
+**      was selected. The file transfer's payload is the radio's current
+**      block.
+**   2. Returns TX_SCHED_NONE when nothing is waiting to be sent.
+**
+*/
+static uint8 SelectPacket(RADIO_IF_Radio_t *Radio, uint32 TimeMs, const TX_RING_Slot_t **Slot)
+{
+   
+   const TX_RING_Slot_t *RingSlot[TX_SCHED_CLASS_CNT];
+   uint8  Backlog = 0;
+   uint8  Class;
+   
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      RingSlot[Class] = Radio->Initialized ? NextRingSlot(Radio, Class, TimeMs) : NULL;
+      if (RingSlot[Class] != NULL)
+      {
+         Backlog |= (1 << Class);
+      }
+   }
+   if (FileBlockReady(Radio))
+   {
+      Backlog |= (1 << RadioIf->FileXfer.Class);
+   }
+   
+   Class = TX_SCHED_Select(&Radio->Sched, Backlog);
+   *Slot = (Class == TX_SCHED_NONE) ? NULL : RingSlot[Class];
+   
+   return Class;
+   
+} /* End SelectPacket() */
+
+
+/******************************************************************************
+** Function: NextRingSlot
+**
+** Return a class's oldest ring payload that hasn't missed its deadline
+**
+** Notes:
+**   1. Payloads that missed their deadline are discarded so stale telemetry
+**      doesn't use airtime.
+**
+*/
+static const TX_RING_Slot_t *NextRingSlot(RADIO_IF_Radio_t *Radio, uint8 Class, uint32 TimeMs)
+{
+   
+   TX_RING_Class_t *TxRing = &Radio->TxRing[Class];
+   const TX_RING_Slot_t *Slot;
+   
+   while ((Slot = TX_RING_ConsumerSlot(TxRing)) != NULL)
+   {
+      if (Slot->DeadlineMs == 0 || (TimeMs - Slot->EnqueueMs) <= Slot->DeadlineMs)
+      {
+         break;
+      }
+      if (Radio->StagedPayload == Slot->Data)
+      {
+         Radio->StagedPayload = NULL;
+         RADIO_TX_DiscardStaged(Radio->Id);
+      }
+      QueueStaleApids(Radio, Slot);
+      TX_RING_Consume(TxRing);
+      TX_SCHED_Drop(&Radio->Sched, Class);
+   }
+   
+   return Slot;
+   
+} /* End NextRingSlot() */
+
+
+/******************************************************************************
+** Function: QueueStaleApids
+**
+** Queue the APIDs of a discarded header compressed frame's entries for the
+** producer
+**
+** Notes:
+**   1. The compressor advanced the APIDs' contexts when the entries were
+**      packed so their next packets must be full entries, see
+**      RADIO_IF_StaleApid().
+**   2. Ring payloads are frames built by TLM_FWD. Frames without header
+**      compression are ignored.
+**
+*/
+static void QueueStaleApids(RADIO_IF_Radio_t *Radio, const TX_RING_Slot_t *Slot)
+{
+   
+   uint32 Head = Radio->StaleApidHead;
+   uint16 Pos  = TX_FRAME_HDR_LEN;
+   uint16 EntryLen, Apid;
+   
+   if (Slot->Len < TX_FRAME_HDR_LEN || Slot->Data[0] != TX_FRAME_HDR(TX_FRAME_TYPE_SB_MSG_HC))
+   {
+      return;
+   }
+   
+   while ((Pos + TX_FRAME_MSG_HDR_LEN) <= Slot->Len)
+   {
+      
+      EntryLen = Slot->Data[Pos];
+      Pos += TX_FRAME_MSG_HDR_LEN;
+      if (EntryLen > (Slot->Len - Pos))
+      {
+         break;
+      }
+      
+      Apid = TX_HDRC_EntryApid(&Slot->Data[Pos], EntryLen);
+      Pos += EntryLen;
+      
+      if (Apid != TX_HDRC_APID_NONE)
+      {
+         if ((Head - LOAD_ACQUIRE(&Radio->StaleApidTail)) < RADIO_IF_STALE_APID_CNT)
+         {
+            Radio->StaleApid[Head % RADIO_IF_STALE_APID_CNT] = Apid;
+            Head++;
+         }
+         else
+         {
+            Radio->StaleApidLost = true;
+         }
+      }
+   
+   }
+   
+   STORE_RELEASE(&Radio->StaleApidHead, Head);
+   
+} /* End QueueStaleApids() */
+
+
+/******************************************************************************
+** Function: SendRingPayload
+**
+** Send a ring payload
+**
+** Notes:
+**   1. The slot is returned to the producer as soon as the payload has been
+**      written to the radio so the producer can refill it while the packet
+**      is on the air.
+*/
+static void SendRingPayload(RADIO_IF_Radio_t *Radio, uint8 Class, const TX_RING_Slot_t *Slot, uint32 TimeOnAir)
+{
+   
+   uint16 PayloadLen = Slot->Len;
+   
+   StartTx(Radio, Slot->Data, PayloadLen, TimeOnAir);
+   
+   TX_RING_Consume(&Radio->TxRing[Class]);
+   
+   WaitForTxDone(Radio, PayloadLen, TimeOnAir);
+   
+} /* End SendRingPayload() */
+
+
+/******************************************************************************
+** Function: StartTx
+**
+** Start a transmission
+**
+** Notes:
+**   1. If the payload was staged while the previous packet was on the air
+**      only the transmission is started.
+**   2. TimeOnAir (us) sets the radio's TX timeout, it's the same time on
+**      air WaitForTxDone() uses.
+**
+*/
+static void StartTx(RADIO_IF_Radio_t *Radio, const uint8 *Payload, uint16 PayloadLen, uint32 TimeOnAir)
+{
+   
+   uint32 PerfUs;
+   
+   /* Discard a TxDone that arrived after a previous wait timed out */
+   OS_BinSemTimedWait(Radio->TxDoneSem, 0);
+   Radio->TxTimeout = false;
+   
+   PerfUs = PerfBegin(Radio, RADIO_IF_PERF_SPI_WRITE);
+   if (Radio->StagedPayload == Payload && Radio->StagedLen == PayloadLen)
+   {
+      RADIO_TX_SendStaged(Radio->Id, TimeOnAir);
+      Radio->TxStats.StagedCnt++;
+   }
+   else
+   {
+      RADIO_TX_SendPayload(Radio->Id, Payload, PayloadLen, TimeOnAir);
+   }
+   PerfEnd(Radio, RADIO_IF_PERF_SPI_WRITE, PerfUs, true);
+   Radio->StagedPayload = NULL;
+   
+} /* End StartTx() */
+
+
+/******************************************************************************
+** Function: StageNextPacket
+**
+** Write the radio's next packet while the current packet is on the air
+**
+** Notes:
+**   1. The scheduler's choice can change before TxDone, e.g. a strict
+**      priority payload arrives, in which case StartTx() discards the staged
+**      payload and writes the selected one.
+**   2. Nothing is staged when the two packets don't fit in the radio's data
+**      buffer.
+**
+*/
+static void StageNextPacket(RADIO_IF_Radio_t *Radio)
+{
+   
+   const TX_RING_Slot_t *Slot;
+   const uint8 *Payload;
+   uint16 PayloadLen;
+   uint32 PerfUs;
+   uint8  Class;
+   
+   Class = SelectPacket(Radio, GetTimeMs(), &Slot);
+   if (Class == TX_SCHED_NONE)
+   {
+      return;
+   }
+   
+   if (Slot != NULL)
+   {
+      Payload    = Slot->Data;
+      PayloadLen = Slot->Len;
+   }
+   else
+   {
+      Payload    = Radio->FileBuf[Radio->FileCur];
+      PayloadLen = Radio->FileBufLen[Radio->FileCur];
+   }
+   
+   PerfUs = PerfBegin(Radio, RADIO_IF_PERF_SPI_WRITE);
+   if (RADIO_TX_StagePayload(Radio->Id, Payload, PayloadLen))
+   {
+      Radio->StagedPayload = Payload;
+      Radio->StagedLen     = PayloadLen;
+      PerfEnd(Radio, RADIO_IF_PERF_SPI_WRITE, PerfUs, true);
+   }
+   else
+   {
+      PerfEnd(Radio, RADIO_IF_PERF_SPI_WRITE, PerfUs, false);
+   }
+   
+} /* End StageNextPacket() */
+
+
+/******************************************************************************
+** Function: StartFileXfer
+**
+** Notes:
+**   1. The first packet contains the number of file data packets as an ASCII
+**      string. This preserves the Stanford Lora_tx protocol. The packet is
+**      built in Hdr and it's the first block filled by a radio.
+**   2. A compressed transfer's packet count isn't known until the file has
+**      been compressed so its first packet is "LZ " followed by the file
+**      size in ASCII. Each of its data packets is a TX_LZ block and
+**      PktsTotal is the packet count when no block compresses.
+**   3. When FEC is enabled " FEC <K> <M>" is appended to the first packet
+**      and PktsTotal includes the parity packets.
+**   4. Must be called with the file transfer mutex held.
+*/
+static void StartFileXfer(void)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   os_fstat_t FileStat;
+   int32 SysStatus;
+   int   HdrLen;
+   
+   SysStatus = OS_stat(FileXfer->Filename, &FileStat);
+   if (SysStatus == OS_SUCCESS)
+   {
+      SysStatus = OS_OpenCreate(&FileXfer->FileHandle, FileXfer->Filename, OS_FILE_FLAG_NONE, OS_READ_ONLY);
+   }
+   
+   if (SysStatus == OS_SUCCESS)
+   {
+      
+      FileXfer->FileSize  = OS_FILESTAT_SIZE(FileStat);
+      FileXfer->PktsSent  = 0;
+      FileXfer->PayloadBytes = 0;
+      
+      if (FileXfer->Compress && FileXfer->DataLen > 1)
+      {
+         FileXfer->PktsTotal = (FileXfer->FileSize + FileXfer->DataLen - 2) / (FileXfer->DataLen - 1);
+         FileXfer->LzInLen   = 0;
+         TX_LZ_Constructor(&FileXfer->Lz);
+         HdrLen = snprintf((char *)FileXfer->Hdr, RADIO_TX_MAX_PAYLOAD_LEN, "LZ %u", (unsigned int)FileXfer->FileSize);
+      }
+      else
+      {
+         FileXfer->Compress  = false;
+         FileXfer->PktsTotal = (FileXfer->FileSize + FileXfer->DataLen - 1) / FileXfer->DataLen;
+         HdrLen = snprintf((char *)FileXfer->Hdr, RADIO_TX_MAX_PAYLOAD_LEN, "%u", (unsigned int)FileXfer->PktsTotal);
+      }
+      
+      if (FileXfer->FecEnabled)
+      {
+         TX_FEC_Reset(&FileXfer->Fec);
+         FileXfer->PktsTotal += ((FileXfer->PktsTotal + FileXfer->Fec.K - 1) / FileXfer->Fec.K) * FileXfer->Fec.M;
+         HdrLen += snprintf((char *)&FileXfer->Hdr[HdrLen], RADIO_TX_MAX_PAYLOAD_LEN - HdrLen, " FEC %u %u",
+                            FileXfer->Fec.K, FileXfer->Fec.M);
+      }
+      FileXfer->HdrLen = HdrLen;
+      
+      FileXfer->Gen++;
+      FileXfer->Eof         = false;
+      FileXfer->ReadStatus  = 0;
+      FileXfer->Outstanding = 0;
+      FileXfer->HdrPending  = true;
+      FileXfer->Active      = true;
+      
+      CFE_EVS_SendEvent(RADIO_IF_FILE_XFER_EID, CFE_EVS_EventType_INFORMATION,
+                        "Started transfer of %s: %d bytes in %d packets on %d radio(s)",
+                        FileXfer->Filename, FileXfer->FileSize, FileXfer->PktsTotal, FileXferRadioCnt());
+   }
+   else
+   {
+      CFE_EVS_SendEvent(RADIO_IF_FILE_XFER_EID, CFE_EVS_EventType_ERROR,
+                        "File transfer failed to open %s, status = %d",
+                        FileXfer->Filename, SysStatus);
+   }
+   
+} /* End StartFileXfer() */
+
+
+/******************************************************************************
+** Function: FileBlockReady
+**
+** Return true if the radio has a file transfer block to send
+**
+** Notes:
+**   1. Blocks of a stopped or previous transfer are discarded, including a
+**      block staged in the radio.
+**   2. A radio with an empty current block fills it if the radio sends
+**      file transfer blocks. A radio keeps sending blocks it has already
+**      filled so every filled block is accounted for.
+**
+*/
+static bool FileBlockReady(RADIO_IF_Radio_t *Radio)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   int32  FillLen;
+   uint32 PerfUs;
+   
+   if (!FileXfer->Active || Radio->FileGen != FileXfer->Gen)
+   {
+      if (Radio->StagedPayload == Radio->FileBuf[0] || Radio->StagedPayload == Radio->FileBuf[1])
+      {
+         Radio->StagedPayload = NULL;
+         RADIO_TX_DiscardStaged(Radio->Id);
+      }
+      Radio->FileBufLen[0] = 0;
+      Radio->FileBufLen[1] = 0;
+      Radio->FileGen = FileXfer->Gen;
+      
+      if (!FileXfer->Active)
+      {
+         return false;
+      }
+   }
+   
+   if (Radio->FileBufLen[Radio->FileCur] == 0 && !FileXfer->Eof && FileXferRadio(Radio))
+   {
+      PerfUs  = PerfBegin(Radio, RADIO_IF_PERF_ENCODE);
+      FillLen = NextFileBlock(Radio, Radio->FileCur);
+      PerfEnd(Radio, RADIO_IF_PERF_ENCODE, PerfUs, (FillLen > 0));
+   }
+   
+   return (Radio->FileBufLen[Radio->FileCur] > 0);
+   
+} /* End FileBlockReady() */
+
+
+/******************************************************************************
+** Function: NextFileBlock
+**
+** Fill one of the radio's block buffers with the transfer's next block and
+** return its length
+**
+** Notes:
+**   1. Blocks are filled in file order under the file transfer mutex so
+**      striped radios can share the file and encoder state.
+**   2. No data block is filled while the header packet is outstanding so
+**      the header is the first packet on the air.
+**   3. Returns zero when there's nothing to fill or a negative OSAL status
+**      if a read failed. The end of the file or a read error ends the
+**      transfer once the outstanding blocks have been sent.
+**
+*/
+static int32 NextFileBlock(RADIO_IF_Radio_t *Radio, uint8 Buf)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   int32 FillLen = 0;
+   
+   OS_MutSemTake(FileXfer->Mutex);
+   
+   if (FileXfer->Active && !FileXfer->Eof && Radio->FileGen == FileXfer->Gen &&
+       !(FileXfer->HdrPending && FileXfer->Outstanding > 0))
+   {
+      
+      if (FileXfer->HdrPending)
+      {
+         memcpy(Radio->FileBuf[Buf], FileXfer->Hdr, FileXfer->HdrLen);
+         FillLen = FileXfer->HdrLen;
+         Radio->FileHdr[Buf] = true;
+      }
+      else
+      {
+         FillLen = FillFileBlock(Radio->FileBuf[Buf]);
+         Radio->FileHdr[Buf] = false;
+      }
+      
+      if (FillLen > 0)
+      {
+         FileXfer->Outstanding++;
+      }
+      else
+      {
+         FileXfer->Eof = true;
+         FileXfer->ReadStatus = FillLen;
+         FileXferDone();
+      }
+   }
+   
+   OS_MutSemGive(FileXfer->Mutex);
+   
+   Radio->FileBufLen[Buf] = (FillLen > 0) ? FillLen : 0;
+   
+   return FillLen;
+   
+} /* End NextFileBlock() */
+
+
+/******************************************************************************
+** Function: SendFileBlock
+**
+** Transmit the radio's current block and fill its next block while the
+** current block is on the air
+**
+** Notes:
+**   1. The next block becomes the current block before pending on TxDone
+**      so it can be staged in the radio.
+**   2. A block is only counted if its transfer is still active. The
+**      transfer's generation is saved before staging the next packet can
+**      move the radio to a new transfer.
+**
+*/
+static void SendFileBlock(RADIO_IF_Radio_t *Radio, uint32 TimeOnAir)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   uint8  Cur  = Radio->FileCur;
+   uint8  Next = Cur ^ 1;
+   uint16 PayloadLen = Radio->FileBufLen[Cur];
+   uint32 FileGen    = Radio->FileGen;
+   int32  FillLen;
+   uint32 PerfUs;
+   
+   StartTx(Radio, Radio->FileBuf[Cur], PayloadLen, TimeOnAir);
+   Radio->FileBufLen[Cur] = 0;
+   
+   PerfUs  = PerfBegin(Radio, RADIO_IF_PERF_ENCODE);
+   FillLen = NextFileBlock(Radio, Next);
+   PerfEnd(Radio, RADIO_IF_PERF_ENCODE, PerfUs, (FillLen > 0));
+   Radio->FileCur = Next;
+   
+   WaitForTxDone(Radio, PayloadLen, TimeOnAir);
+   
+   OS_MutSemTake(FileXfer->Mutex);
+   if (FileXfer->Active && FileGen == FileXfer->Gen)
+   {
+      if (Radio->FileHdr[Cur])
+      {
+         FileXfer->HdrPending = false;
+      }
+      else
+      {
+         FileXfer->PktsSent++;
+         FileXfer->PayloadBytes += PayloadLen;
+      }
+      FileXfer->Outstanding--;
+      FileXferDone();
+   }
+   OS_MutSemGive(FileXfer->Mutex);
+   
+} /* End SendFileBlock() */
+
+
+/******************************************************************************
+** Function: FileXferDone
+**
+** End the transfer when every block has been filled and sent
+**
+** Notes:
+**   1. Must be called with the file transfer mutex held.
+**
+*/
+static void FileXferDone(void)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   
+   if (FileXfer->Active && FileXfer->Eof && FileXfer->Outstanding == 0)
+   {
+      if (FileXfer->ReadStatus == 0)
+      {
+         CFE_EVS_SendEvent(RADIO_IF_FILE_XFER_EID, CFE_EVS_EventType_INFORMATION,
+                           "Completed transfer of %s: %d packets sent, %d file bytes in %d payload bytes",
+                           FileXfer->Filename, FileXfer->PktsSent, FileXfer->FileSize, FileXfer->PayloadBytes);
+      }
+      else
+      {
+         CFE_EVS_SendEvent(RADIO_IF_FILE_XFER_EID, CFE_EVS_EventType_ERROR,
+                           "File transfer of %s failed reading packet %d, status = %d",
+                           FileXfer->Filename, FileXfer->PktsSent + 1, FileXfer->ReadStatus);
+      }
+      StopFileXfer();
+   }
+   
+} /* End FileXferDone() */
+
+
+/******************************************************************************
+** Function: StopFileXfer
+**
+** Notes:
+**   1. Must be called with the file transfer mutex held. Each radio
+**      discards its blocks of the stopped transfer, see FileBlockReady().
+**
+*/
+static void StopFileXfer(void)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   
+   OS_close(FileXfer->FileHandle);
+   FileXfer->FileHandle = OS_OBJECT_ID_UNDEFINED;
+   
+   FileXfer->StopReq = false;
+   FileXfer->Active  = false;
+   
+} /* End StopFileXfer() */
+
+
+/******************************************************************************
+** Function: FillFileBlock
+**
+** Fill a transmit buffer with the next file transfer packet and return its
+** length.
+**
+** Notes:
+**   1. Returns zero at the end of the transfer or a negative OSAL status if
+**      a read failed.
+**   2. With FEC the file data is written after the FEC header. The end of
+**      the file closes the last group so its parity is sent before the
+**      transfer completes.
+*/
+static int32 FillFileBlock(uint8 *Buf)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   int32 DataLen;
+   
+   if (!FileXfer->FecEnabled)
+   {
+      return FileXfer->Compress ? CompressFileBlock(Buf, FileXfer->DataLen) : ReadFile(Buf, FileXfer->DataLen);
+   }
+   
+   if (FileXfer->Fec.ParityPending)
+   {
+      return TX_FEC_NextParity(&FileXfer->Fec, Buf);
+   }
+   
+   DataLen = FileXfer->Compress ? CompressFileBlock(&Buf[TX_FEC_HDR_LEN], FileXfer->DataLen) :
+                                  ReadFile(&Buf[TX_FEC_HDR_LEN], FileXfer->DataLen);
+   if (DataLen > 0)
+   {
+      DataLen = TX_FEC_EncodeData(&FileXfer->Fec, Buf, DataLen);
+   }
+   else if (DataLen == 0 && TX_FEC_EndGroup(&FileXfer->Fec))
+   {
+      DataLen = TX_FEC_NextParity(&FileXfer->Fec, Buf);
+   }
+   
+   return DataLen;
+   
+} /* End FillFileBlock() */
+
+
+/******************************************************************************
+** Function: CompressFileBlock
+**
+** Top off the compression input window from the file and compress as much
+** of it as fits in a Len byte block.
+**
+*/
+static int32 CompressFileBlock(uint8 *Buf, uint16 Len)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   int32  ReadLen = 0;
+   uint16 InUsed;
+   uint16 BlockLen;
+   
+   if (FileXfer->LzInLen < TX_LZ_WINDOW_LEN)
+   {
+      ReadLen = ReadFile(&FileXfer->LzIn[FileXfer->LzInLen], TX_LZ_WINDOW_LEN - FileXfer->LzInLen);
+      if (ReadLen < 0)
+      {
+         return ReadLen;
+      }
+      FileXfer->LzInLen += ReadLen;
+   }
+   
+   if (FileXfer->LzInLen == 0)
+   {
+      return 0;
+   }
+   
+   BlockLen = TX_LZ_CompressBlock(&FileXfer->Lz, FileXfer->LzIn, FileXfer->LzInLen, 
+                                  Buf, Len, &InUsed);
+   
+   FileXfer->LzInLen -= InUsed;
+   memmove(FileXfer->LzIn, &FileXfer->LzIn[InUsed], FileXfer->LzInLen);
+   
+   return BlockLen;
+   
+} /* End CompressFileBlock() */
+
+
+/******************************************************************************
+** Function: ReadFile
+**
+** Read up to Len bytes from the file directly into Buf.
+**
+** Notes:
+**   1. Returns the number of bytes read, zero at the end of the file or a
+**      negative OSAL status if the read failed.
+**   2. A short read from OSAL isn't treated as the end of file so the loop
+**      fills Len bytes whenever the file has them.
+*/
+static int32 ReadFile(uint8 *Buf, uint16 Len)
+{
+   
+   RADIO_IF_FileXfer_t *FileXfer = &RadioIf->FileXfer;
+   int32 BufLen = 0;
+   int32 ReadLen;
+   
+   do
+   {
+      ReadLen = OS_read(FileXfer->FileHandle, &Buf[BufLen], Len - BufLen);
+      if (ReadLen > 0)
+      {
+         BufLen += ReadLen;
+      }
+   } while (ReadLen > 0 && BufLen < Len);
+   
+   return (ReadLen < 0) ? ReadLen : BufLen;
+   
+} /* End ReadFile() */
+
+
+/******************************************************************************
+** Function: TxDoneCallback
+**
+** Notes:
+**   1. Executes in the radio driver's IRQ handler thread.
+*/
+static void TxDoneCallback(uint8 Radio, bool TxTimeout)
+{
+   
+   if (Radio < RadioIf->RadioCnt)
+   {
+      RadioIf->Radio[Radio].TxTimeout = TxTimeout;
+      OS_BinSemGive(RadioIf->Radio[Radio].TxDoneSem);
+   }
+   
+} /* End TxDoneCallback() */
+
+
+/******************************************************************************
+** Function: WaitForTxDone
+**
+** Pend on the TxDone interrupt for the packet that is on the radio's air
+**
+** Notes:
+**   1. The timeout is a safety net for a lost interrupt and it is much
+**      longer than a packet's time on air. The next packet is sent as soon
+**      as the interrupt arrives.
+**   2. The next packet is staged in the radio before pending so its SPI
+**      write overlaps this packet's time on air.
+*/
+static void WaitForTxDone(RADIO_IF_Radio_t *Radio, uint16 PayloadLen, uint32 TimeOnAir)
+{
+   
+   int32  SysStatus;
+   uint32 Timeout = (TimeOnAir / 1000) + 1 + RADIO_IF_TX_DONE_MARGIN;
+   uint32 PerfUs;
+   
+   StageNextPacket(Radio);
+   
+   PerfUs    = PerfBegin(Radio, RADIO_IF_PERF_TX_DONE);
+   SysStatus = OS_BinSemTimedWait(Radio->TxDoneSem, Timeout);
+   PerfEnd(Radio, RADIO_IF_PERF_TX_DONE, PerfUs, (SysStatus == OS_SUCCESS));
+   
+   if (SysStatus == OS_SUCCESS)
+   {
+      if (Radio->TxTimeout)
+      {
+         Radio->TxStats.TxTimeoutCnt++;
+         CFE_EVS_SendEvent(RADIO_IF_TX_DONE_EID, CFE_EVS_EventType_ERROR,
+                           "Radio %d TX timeout, %d timeouts since reset", Radio->Id, Radio->TxStats.TxTimeoutCnt);
+      }
+      else
+      {
+         Radio->TxStats.PktCnt++;
+         Radio->TxStats.ByteCnt    += PayloadLen;
+         Radio->TxStats.AirtimeCnt += TimeOnAir;
+      }
+   }
+   else
+   {
+      Radio->TxStats.TxDoneLostCnt++;
+      CFE_EVS_SendEvent(RADIO_IF_TX_DONE_EID, CFE_EVS_EventType_ERROR,
+                        "Radio %d TxDone interrupt not received within %d ms, status = %d",
+                        Radio->Id, Timeout, SysStatus);
+   }
+   
+} /* End WaitForTxDone() */
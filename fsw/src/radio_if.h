@@ -22,11 +22,25 @@
 **       one object.
 **    2. Default radio configurations are defined in the app's JSON init file.
 **       If a configuration can be changed via commmand then the configuration
-**       is defined in this object's class data. The radio telemetry message
-**       data is populated using the IniTbl and this class's configuration
-**       settings. Ideally the telemetry message should be populated using the
-**       Radio object's configuration data because it is the 'truth'. However,
-**       this impacts legacy code more than desired for the initial demo.   
+**       is defined in this object's class data. The radio telemetry message's
+**       device and pin fields are loaded from the IniTbl when the message is
+**       sent. Once a radio is initialized its settings are read from
+**       radio_tx's shadow registers which are the 'truth', otherwise they're
+**       this class's configuration settings.
+**    3. Up to RADIO_IF_MAX_RADIOS radios are supported. Each radio has its
+**       own child task, transmit rings, scheduler and hop sequence. The
+**       LoRa parameters, adaptive data rate controller, duty cycle budget
+**       and file transfer encoder are shared. When striping is enabled the
+**       producer spreads payloads across the radios' rings and every radio
+**       sends blocks of an FEC file transfer, otherwise everything is sent
+**       on the first initialized radio.
+**    4. A named profile from the profile table sets every radio's operating
+**       point with one command. Each child task programs the profile's
+**       compiled commands in one batch between packets.
+**    5. Radios are initialized by their child tasks so the command pipe
+**       isn't blocked by a chip reset and a radio's SPI device is only used
+**       by one task. The radios can be initialized at startup and a warm
+**       start keeps a radio that's still configured after an app restart.
 **
 */
 
@@ -38,12 +52,54 @@
 */
 
 #include "app_cfg.h"
+#include "radio_tx.h"
+#include "tx_ring.h"
+#include "tx_lz.h"
+#include "tx_fec.h"
+#include "tx_toa.h"
+#include "tx_adr.h"
+#include "tx_sched.h"
+#include "tx_duty.h"
+#include "tx_hop.h"
+#include "tx_hist.h"
+#include "tx_frame.h"
+#include "tx_hdrc.h"
+#include "profile_tbl.h"
 
 
 /***********************/
 /** Macro Definitions **/
 /***********************/
 
+#define RADIO_IF_MAX_RADIOS        RADIO_TX_MAX_RADIOS
+
+#define RADIO_IF_CHILD_IDLE_DELAY  100  /* ms, child task poll period when there's nothing to transmit */
+#define RADIO_IF_TX_DONE_MARGIN    100  /* ms, added to a packet's time on air when pending on TxDone, longer than RADIO_TX_TIMEOUT_MARGIN */
+#define RADIO_IF_TX_DONE_SEM_NAME  "LORA_TX_TXDONE"   /* Radio number is appended */
+#define RADIO_IF_WAKEUP_SEM_NAME   "LORA_TX_WAKEUP"   /* Radio number is appended */
+#define RADIO_IF_FILE_MUT_NAME     "LORA_TX_FILE"
+#define RADIO_IF_DUTY_MUT_NAME     "LORA_TX_DUTY"
+
+#define RADIO_IF_STALE_APID_CNT    32                 /* APIDs of discarded frames waiting for the producer */
+#define RADIO_IF_STALE_APID_ALL    TX_HDRC_APID_NONE  /* Stale APIDs were lost, every context is stale */
+
+/*
+** Radio initialization requests serviced by each radio's child task
+*/
+#define RADIO_IF_INIT_NONE         0
+#define RADIO_IF_INIT_COLD         1  /* Reset and configure the radio */
+#define RADIO_IF_INIT_WARM         2  /* Keep the radio if it's still configured, see RADIO_TX_InitRadio() */
+
+/*
+** Transmit pipeline stages measured with CFE perf log markers and latency
+** histograms. The order matches PerfTlm's payload.
+*/
+#define RADIO_IF_PERF_DEQUEUE      0  /* Select the next packet and check the duty cycle budget */
+#define RADIO_IF_PERF_ENCODE       1  /* Read, compress and FEC encode a file transfer block */
+#define RADIO_IF_PERF_SPI_WRITE    2  /* Write a payload to the radio and start transmitting */
+#define RADIO_IF_PERF_TX_DONE      3  /* Pend on the TxDone interrupt */
+#define RADIO_IF_PERF_STAGE_CNT    4
+
 
 /*
 ** Event Message IDs
@@ -56,6 +112,17 @@
 #define RADIO_TX_SET_SPI_SPEED_CMD_EID       (RADIO_IF_BASE_EID + 4)
 #define RADIO_TX_SET_RADIO_FREQUENCY_CMD_EID (RADIO_IF_BASE_EID + 5)
 #define RADIO_TX_SET_LORA_PARAMS_CMD_EID     (RADIO_IF_BASE_EID + 6)
+#define RADIO_TX_START_FILE_XFER_CMD_EID     (RADIO_IF_BASE_EID + 7)
+#define RADIO_TX_STOP_FILE_XFER_CMD_EID      (RADIO_IF_BASE_EID + 8)
+#define RADIO_IF_FILE_XFER_EID               (RADIO_IF_BASE_EID + 9)
+#define RADIO_IF_TX_DONE_EID                 (RADIO_IF_BASE_EID + 10)
+#define RADIO_TX_EST_FILE_XFER_CMD_EID       (RADIO_IF_BASE_EID + 11)
+#define RADIO_TX_SET_ADR_CMD_EID             (RADIO_IF_BASE_EID + 12)
+#define RADIO_IF_ADR_EID                     (RADIO_IF_BASE_EID + 13)
+#define RADIO_TX_SET_HOPPING_CMD_EID         (RADIO_IF_BASE_EID + 14)
+#define RADIO_TX_SEND_PERF_TLM_CMD_EID       (RADIO_IF_BASE_EID + 15)
+#define RADIO_TX_SELECT_PROFILE_CMD_EID      (RADIO_IF_BASE_EID + 16)
+#define RADIO_IF_INIT_RADIO_EID              (RADIO_IF_BASE_EID + 17)
 
 /**********************/
 /** Type Definitions **/
@@ -63,14 +130,151 @@
 
 // Command and Telemetry packets are defined in lora_tx.xml
 
+/*
+** When a profile is selected LoRa holds its modulation and a LoRaGen change
+** programs Image[ImageCur] instead of LoRa. The images are double buffered
+** so selecting a profile doesn't overwrite an image a child task may be
+** programming.
+*/
 typedef struct
 {
-   uint32  Frequency;
    LORA_TX_SetLoRaParams_CmdPayload_t LoRa;
+   uint16  PreambleLen;   /* Programmed preamble, only a profile or a radio initialization changes it */
+   uint32  LoRaGen;       /* Incremented when LoRa changes, each radio applies the change before its next packet */
+   
+   bool    ProfileSet;
+   char    ProfileName[PROFILE_TBL_NAME_LEN];
+   uint8   ImageCur;
+   RADIO_TX_Image_t Image[2];
    
 } RADIO_IF_Config;
 
 
+/*
+** File transfers are requested by the command task and performed by the
+** child tasks. The file and encoder state are guarded by Mutex so the
+** radios sending a striped transfer fill their blocks in file order. Each
+** radio double buffers its blocks so the next block is read from the file
+** while the current block is on the air. Compressed transfers stage file
+** data in LzIn and each block holds as much of it as compresses into
+** BlockLen bytes. When FEC is enabled each block is wrapped in a TX_FEC data
+** packet and every group of data packets is followed by its parity packets.
+*/
+typedef struct
+{
+   
+   volatile bool StartReq;
+   volatile bool StopReq;
+   volatile bool Active;
+   
+   char      Filename[OS_MAX_PATH_LEN];
+   osal_id_t FileHandle;
+   uint32    FileSize;
+   uint16    BlockLen;
+   
+   bool      Compress;
+   uint32    PayloadBytes;    /* File data payload bytes sent */
+   uint16    LzInLen;
+   uint8     LzIn[TX_LZ_WINDOW_LEN];
+   TX_LZ_Class_t Lz;
+   
+   bool      FecEnabled;
+   uint16    DataLen;         /* File data bytes per packet */
+   TX_FEC_Class_t Fec;
+   
+   uint8     Class;           /* Transmit scheduler class */
+   bool      HdrPending;
+   uint16    HdrLen;
+   uint8     Hdr[RADIO_TX_MAX_PAYLOAD_LEN];
+   uint32    PktsTotal;
+   uint32    PktsSent;
+   
+   osal_id_t Mutex;
+   uint32    Gen;             /* Incremented by each start so radios discard blocks of a previous transfer */
+   bool      Eof;             /* Every block has been filled */
+   int32     ReadStatus;      /* Negative OSAL status of a failed read */
+   uint32    Outstanding;     /* Blocks filled and not yet sent */
+   
+} RADIO_IF_FileXfer_t;
+
+
+/*
+** Transmit statistics. Counters are only written by the radio's child task.
+** The rates, AirtimeTotal and DropCnt are computed by the app's 1Hz status
+** path.
+*/
+typedef struct
+{
+   
+   uint32  PktCnt;          /* Packets confirmed by a TxDone interrupt */
+   uint32  ByteCnt;         /* Payload bytes in confirmed packets      */
+   uint32  AirtimeCnt;      /* us, time on air of confirmed packets    */
+   uint32  TxTimeoutCnt;    /* Radio reported a TX timeout             */
+   uint32  TxDoneLostCnt;   /* TxDone interrupt never arrived          */
+   uint32  StagedCnt;       /* Packets staged while the previous packet was on the air */
+   
+   uint32  PrevPktCnt;
+   uint32  PrevByteCnt;
+   uint32  PrevAirtimeCnt;
+   uint32  PrevDropCnt;
+   uint16  PktRate;         /* Packets per second                      */
+   uint32  ByteRate;        /* Payload bytes per second                */
+   uint16  AirtimeRate;     /* ms of airtime per second                */
+   uint8   LinkUtil;        /* Percentage of the last second on the air */
+   uint32  AirEfficiency;   /* Payload bytes per second of airtime     */
+   uint64  AirtimeTotal;    /* us, AirtimeCnt without wrapping         */
+   uint32  DropCnt;         /* Ring full rejections and deadline drops since reset */
+   uint16  DropRate;        /* Drops per second                        */
+   
+} RADIO_IF_TxStats_t;
+
+
+/*
+** A radio and the transmit state owned by its child task
+*/
+typedef struct
+{
+   
+   uint8              Id;
+   CHILDMGR_Class_t  *ChildMgr;
+   bool               Initialized;
+   volatile uint8     InitReq;         /* RADIO_IF_INIT_x, cleared by the child task when the initialization completes */
+   uint32             Frequency;       /* MHz, configured frequency */
+   uint32             LoRaGen;         /* RadioConfig.LoRaGen programmed in the radio */
+   uint32             SpiSpeed;        /* Hz, configured SPI speed */
+   uint32             CfgGen;          /* Incremented when a command changes Frequency, SpiSpeed or hopping */
+   uint32             CfgGenApplied;   /* CfgGen programmed in the radio */
+   
+   TX_HOP_Class_t     Hop;             /* Hops are performed by the child task */
+   bool               DutyDeferred;    /* Packet waiting for the shared duty cycle budget */
+   
+   osal_id_t          TxDoneSem;
+   volatile bool      TxTimeout;
+   RADIO_IF_TxStats_t TxStats;
+   
+   osal_id_t          WakeupSem;
+   TX_SCHED_Class_t   Sched;
+   TX_RING_Class_t    TxRing[TX_SCHED_CLASS_CNT];
+   const uint8       *StagedPayload;  /* Payload staged in the radio's data buffer, NULL if none */
+   uint16             StagedLen;
+   
+   uint16             StaleApid[RADIO_IF_STALE_APID_CNT];  /* APIDs in discarded header compressed frames */
+   uint32             StaleApidHead;   /* Written by the child task */
+   uint32             StaleApidTail;   /* Written by the producer */
+   volatile bool      StaleApidLost;   /* Set by the child task when StaleApid is full */
+   
+   uint32             FileGen;         /* FileXfer.Gen of the blocks in FileBuf */
+   uint8              FileCur;
+   bool               FileHdr[2];      /* Block is the transfer's header packet */
+   uint16             FileBufLen[2];
+   uint8              FileBuf[2][RADIO_TX_MAX_PAYLOAD_LEN];
+   
+   uint32             PerfId[RADIO_IF_PERF_STAGE_CNT];
+   TX_HIST_Class_t    PerfHist[RADIO_IF_PERF_STAGE_CNT];  /* Written by the child task */
+   
+} RADIO_IF_Radio_t;
+
+
 /******************************************************************************
 ** TX_DEMO_Class
 */
@@ -88,15 +292,33 @@ typedef struct
    */
    
    LORA_TX_RadioTlm_t  RadioTlm;
+   LORA_TX_PerfTlm_t   PerfTlm;
 
    /*
    ** Class State Data
    */
    
-   bool   Initialized;
+   uint8  RadioCnt;
+   bool   Stripe;
+   uint8  Backend;
    uint32 SpiSpeed;
    
    RADIO_IF_Config RadioConfig;
+   TX_TOA_Class_t  Toa;            /* Rebuilt by the primary radio's child task when LoRaGen changes */
+   uint32          ToaLoRaGen;     /* RadioConfig.LoRaGen of the active time on air table */
+   TX_ADR_Class_t  Adr;            /* Profile selection is performed by the first radio's child task */
+   PROFILE_TBL_Class_t ProfileTbl;
+   
+   TX_DUTY_Class_t     Duty;       /* Every radio's packets are charged to one budget */
+   osal_id_t           DutyMutex;  /* Held by a child task from its wait check to its charge */
+   
+   RADIO_IF_FileXfer_t FileXfer;
+   RADIO_IF_TxStats_t  TxStats;    /* Sum of the radios' statistics */
+   
+   bool   SlotHeld[TX_SCHED_CLASS_CNT];   /* Producer slot returned and not yet queued */
+   uint8  SlotRadio[TX_SCHED_CLASS_CNT];  /* Radio whose ring holds the producer slot */
+   
+   RADIO_IF_Radio_t Radio[RADIO_IF_MAX_RADIOS];
    
 } RADIO_IF_Class_t;
 
@@ -114,14 +336,29 @@ typedef struct
 **
 ** Notes:
 **   1. This must be called prior to any other function.
+**   2. ChildMgr holds a child task manager per radio. The child tasks must
+**      be created after this call because each task finds its radio by
+**      its ChildMgr.
 **
 */
-void RADIO_IF_Constructor(RADIO_IF_Class_t *RadioIfPtr, INITBL_Class_t *IniTbl);
+void RADIO_IF_Constructor(RADIO_IF_Class_t *RadioIfPtr, INITBL_Class_t *IniTbl,
+                          CHILDMGR_Class_t ChildMgr[RADIO_IF_MAX_RADIOS]);
 
 
 /******************************************************************************
 ** Function: RADIO_IF_ChildTask
 **
+** Notes:
+**   1. Each radio has a child task that's identified by its ChildMgr.
+**      Performs at most one packet transmission per call so stop requests
+**      are serviced between packets.
+**   2. The transmit scheduler selects the class that sends the packet. Within
+**      a class ring payloads are sent before file transfer blocks.
+**   3. Adaptive data rate profile changes are applied before each packet.
+**   4. A packet is deferred while the duty cycle budget shared by the
+**      radios doesn't cover its time on air.
+**   5. When frequency hopping is enabled the radio hops between packets.
+**
 */
 bool RADIO_IF_ChildTask(CHILDMGR_Class_t *ChildMgr);
 
@@ -139,11 +376,121 @@ bool RADIO_IF_ChildTask(CHILDMGR_Class_t *ChildMgr);
 void RADIO_IF_ResetStatus(void);
 
 
+/******************************************************************************
+** Function: RADIO_IF_PayloadSlot
+**
+** Return a buffer in a transmit scheduler class's ring where the next
+** payload can be built in place
+**
+** Notes:
+**   1. The transmit rings have a single producer so this must only be
+**      called from the app's main task.
+**   2. The buffer holds RADIO_TX_MAX_PAYLOAD_LEN bytes. It's written to the
+**      radio by the child task without being copied once the payload is
+**      queued by RADIO_IF_QueuePayload().
+**   3. Returns NULL if the class's ring is full. Calling this function
+**      again before the payload is queued returns the same buffer.
+**   4. When striping, the buffer is taken from the ring of the initialized
+**      radio with the least queued airtime in the class.
+**
+*/
+uint8 *RADIO_IF_PayloadSlot(uint8 Class);
+
+
+/******************************************************************************
+** Function: RADIO_IF_QueuePayload
+**
+** Queue the payload built in the class's RADIO_IF_PayloadSlot() buffer for
+** transmission by the child task
+**
+** Notes:
+**   1. EnqueueMs is when the payload's oldest data was queued on the local
+**      ms clock. When DeadlineMs is nonzero the payload is discarded rather
+**      than sent if it's still queued DeadlineMs after EnqueueMs.
+**   2. Returns the payload's time on air in microseconds, zero if the
+**      class has no payload slot or the payload is too long.
+**
+*/
+uint32 RADIO_IF_QueuePayload(uint8 Class, uint16 PayloadLen, uint32 EnqueueMs, uint32 DeadlineMs);
+
+
+/******************************************************************************
+** Function: RADIO_IF_StaleApid
+**
+** Return true and the next APID whose header compression context is stale
+** because a frame with one of its entries was discarded
+**
+** Notes:
+**   1. Called by the producer, which owns the compressor, before it packs
+**      messages so the APID's next packet is sent as a full entry.
+**   2. Apid is RADIO_IF_STALE_APID_ALL when APIDs were lost because a
+**      radio's queue was full.
+**
+*/
+bool RADIO_IF_StaleApid(uint16 *Apid);
+
+
+/******************************************************************************
+** Function: RADIO_IF_Initialized
+**
+** Return true if at least one radio is initialized
+**
+*/
+bool RADIO_IF_Initialized(void);
+
+
+/******************************************************************************
+** Function: RADIO_IF_TxQueueSpace
+**
+** Return the number of free slots in a class's transmit rings
+**
+** Notes:
+**   1. When striping, the free slots of every initialized radio's ring are
+**      counted.
+**
+*/
+uint32 RADIO_IF_TxQueueSpace(uint8 Class);
+
+
+/******************************************************************************
+** Function: RADIO_IF_UpdateTxStats
+**
+** Compute the per second transmit statistics
+**
+** Notes:
+**   1. Must be called once per second.
+**
+*/
+void RADIO_IF_UpdateTxStats(void);
+
+
+/******************************************************************************
+** Function: RADIO_IF_DutyBudgetRemaining
+**
+** Return the duty cycle airtime (ms) currently available to the radios
+**
+*/
+uint32 RADIO_IF_DutyBudgetRemaining(void);
+
+
+/******************************************************************************
+** Function: RADIO_IF_AdrDwellTime
+**
+** Return the seconds spent in an adaptive data rate profile
+**
+*/
+uint32 RADIO_IF_AdrDwellTime(uint8 Profile);
+
+
 /******************************************************************************
 ** Function: RADIO_IF_InitRadio
 **
 ** Notes:
 **   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. Requests every configured radio's child task to reset and
+**      initialize its radio and returns without waiting. Each task sends an
+**      event with its radio's result. Fails if an initialization is still
+**      in progress.
 */
 bool RADIO_IF_InitRadioCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 
@@ -154,24 +501,86 @@ bool RADIO_IF_InitRadioCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 ** Notes:
 **   1. Must match CMDMGR_CmdFuncPtr_t function signature
 **   2. See file prologue for data source details.
+**   3. Sends a radio telemetry message per configured radio.
 */
 bool RADIO_IF_SendRadioTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 
 
+/******************************************************************************
+** Function: RADIO_IF_SendPerfTlm
+**
+** Send the transmit pipeline latency histogram telemetry packet
+**
+** Notes:
+**   1. Latencies are in microseconds. Percentiles are the upper bound of the
+**      log2 bucket that contains them, limited to the maximum latency.
+**   2. The histograms are cleared by RADIO_IF_ResetStatus().
+**   3. The radios' histograms are combined.
+**
+*/
+void RADIO_IF_SendPerfTlm(void);
+
+
+/******************************************************************************
+** Function: RADIO_IF_SendPerfTlmCmd
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**
+*/
+bool RADIO_IF_SendPerfTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
 /******************************************************************************
 ** Function: RADIO_IF_SetLoRaParamsCmd
 **
 ** Notes:
 **   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. The parameters apply to every radio. Each child task programs them
+**      before its next packet.
 */
 bool RADIO_IF_SetLoRaParamsCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 
 
+/******************************************************************************
+** Function: RADIO_IF_SelectProfileCmd
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. The profile applies to every radio. Each child task programs it in
+**      one batch before its next packet.
+*/
+bool RADIO_IF_SelectProfileCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RADIO_IF_SetAdrCmd
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. The child task applies the controller's profile changes between
+**      packets.
+*/
+bool RADIO_IF_SetAdrCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RADIO_IF_SetHoppingCmd
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. The child tasks hop to their first channel before the next packet.
+**      Disabling hopping returns the radios to their configured frequency.
+*/
+bool RADIO_IF_SetHoppingCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
 /******************************************************************************
 ** Function: RADIO_IF_SetRadioFrequencyCmd
 **
 ** Notes:
 **   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. Disables the radio's frequency hopping.
 */
 bool RADIO_IF_SetRadioFrequencyCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 
@@ -181,8 +590,44 @@ bool RADIO_IF_SetRadioFrequencyCmd(void *ObjDataPtr, const CFE_MSG_Message_t *Ms
 **
 ** Notes:
 **   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. Applies to every initialized radio.
 */
 bool RADIO_IF_SetSpiSpeedCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 
 
+/******************************************************************************
+** Function: RADIO_IF_StartFileTransferCmd
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. The file is opened and transmitted by the child tasks. The first
+**      packet contains the number of file data packets as an ASCII string. 
+*/
+bool RADIO_IF_StartFileTransferCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RADIO_IF_StopFileTransferCmd
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+*/
+bool RADIO_IF_StopFileTransferCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RADIO_IF_EstimateFileTransferCmd
+**
+** Report the airtime, ETA and throughput of a file transfer using the
+** current LoRa parameters
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. Assumes the file doesn't compress.
+**   3. A striped transfer's ETA is divided by the number of initialized
+**      radios.
+*/
+bool RADIO_IF_EstimateFileTransferCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
 #endif /* _radio_if_ */
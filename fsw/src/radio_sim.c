@@ -0,0 +1,437 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the simulated SX128x radio class
+**
+**  Notes:
+**    1. See radio_sim.h for the simulator's behavior.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "radio_sim.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define XTAL_FREQ_HZ  52000000ULL   /* RF frequency step is XTAL/2^18 */
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static uint64_t GetTimeNs(void);
+static void SleepUntilNs(uint64_t TimeNs);
+static void Command(RADIO_SIM_Class_t *RadioSim);
+static bool FrameLost(RADIO_SIM_Class_t *RadioSim);
+static void *TxTask(void *Arg);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_Constructor
+**
+*/
+bool RADIO_SIM_Constructor(RADIO_SIM_Class_t *RadioSim, const RADIO_SIM_Config_t *Config,
+                           RADIO_SIM_TxDoneFunc_t TxDoneFunc)
+{
+   
+   memset(RadioSim, 0, sizeof(RADIO_SIM_Class_t));
+   
+   RadioSim->Radio      = Config->Radio;
+   RadioSim->BusyNs     = (uint64_t)Config->BusyUs * 1000;
+   RadioSim->LossPct    = (Config->LossPct > 100) ? 100 : Config->LossPct;
+   RadioSim->Rand       = (Config->Seed != 0) ? Config->Seed : 1;
+   RadioSim->TxDoneFunc = TxDoneFunc;
+   RadioSim->OutFd      = -1;
+   RadioSim->PayloadLen  = RADIO_TX_MAX_PAYLOAD_LEN;
+   RadioSim->PreambleLen = RADIO_TX_PREAMBLE_LEN;
+   
+   TX_TOA_Constructor(&RadioSim->Toa, true);
+   
+   if (Config->OutputPath != NULL && Config->OutputPath[0] != '\0')
+   {
+      RadioSim->OutFd = open(Config->OutputPath, O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK, 0644);
+      if (RadioSim->OutFd < 0)
+      {
+         return false;
+      }
+   }
+   
+   pthread_mutex_init(&RadioSim->Mutex, NULL);
+   pthread_cond_init(&RadioSim->Cond, NULL);
+   RadioSim->Run = true;
+   if (pthread_create(&RadioSim->Thread, NULL, TxTask, RadioSim) != 0)
+   {
+      RadioSim->Run = false;
+      pthread_cond_destroy(&RadioSim->Cond);
+      pthread_mutex_destroy(&RadioSim->Mutex);
+      if (RadioSim->OutFd >= 0)
+      {
+         close(RadioSim->OutFd);
+         RadioSim->OutFd = -1;
+      }
+      return false;
+   }
+   
+   return true;
+   
+} /* End RADIO_SIM_Constructor() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_Destructor
+**
+*/
+void RADIO_SIM_Destructor(RADIO_SIM_Class_t *RadioSim)
+{
+   
+   if (RadioSim->Run)
+   {
+      pthread_mutex_lock(&RadioSim->Mutex);
+      RadioSim->Run = false;
+      pthread_cond_signal(&RadioSim->Cond);
+      pthread_mutex_unlock(&RadioSim->Mutex);
+   
+      pthread_join(RadioSim->Thread, NULL);
+      pthread_cond_destroy(&RadioSim->Cond);
+      pthread_mutex_destroy(&RadioSim->Mutex);
+   }
+   
+   if (RadioSim->OutFd >= 0)
+   {
+      close(RadioSim->OutFd);
+      RadioSim->OutFd = -1;
+   }
+   
+} /* End RADIO_SIM_Destructor() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetModulation
+**
+*/
+void RADIO_SIM_SetModulation(RADIO_SIM_Class_t *RadioSim, uint8_t SpreadingFactor,
+                             uint8_t Bandwidth, uint8_t CodingRate)
+{
+   
+   Command(RadioSim);
+   
+   RadioSim->SpreadingFactor = SpreadingFactor;
+   RadioSim->Bandwidth       = Bandwidth;
+   RadioSim->CodingRate      = CodingRate;
+   
+} /* End RADIO_SIM_SetModulation() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetRfFrequencyReg
+**
+*/
+void RADIO_SIM_SetRfFrequencyReg(RADIO_SIM_Class_t *RadioSim, uint32_t FreqReg)
+{
+   
+   Command(RadioSim);
+   
+   RadioSim->FreqReg = FreqReg;
+   
+} /* End RADIO_SIM_SetRfFrequencyReg() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetPreambleLen
+**
+** Notes:
+**   1. The preamble length is passed to the time on air model when a
+**      frame's airtime is computed so only its field changes.
+**
+*/
+void RADIO_SIM_SetPreambleLen(RADIO_SIM_Class_t *RadioSim, uint16_t PreambleLen)
+{
+   
+   Command(RadioSim);
+   
+   RadioSim->PreambleLen = PreambleLen;
+   
+} /* End RADIO_SIM_SetPreambleLen() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetPayloadLen
+**
+*/
+void RADIO_SIM_SetPayloadLen(RADIO_SIM_Class_t *RadioSim, uint8_t PayloadLen)
+{
+   
+   Command(RadioSim);
+   
+   RadioSim->PayloadLen = PayloadLen;
+   
+} /* End RADIO_SIM_SetPayloadLen() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetTxBase
+**
+*/
+void RADIO_SIM_SetTxBase(RADIO_SIM_Class_t *RadioSim, uint8_t TxBase)
+{
+   
+   Command(RadioSim);
+   
+   RadioSim->TxBase = TxBase;
+   
+} /* End RADIO_SIM_SetTxBase() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_WriteBuffer
+**
+*/
+void RADIO_SIM_WriteBuffer(RADIO_SIM_Class_t *RadioSim, uint8_t Offset,
+                           const uint8_t *Data, uint8_t Len)
+{
+   
+   uint16_t First = RADIO_SIM_BUF_LEN - Offset;
+   
+   Command(RadioSim);
+   
+   if (Len <= First)
+   {
+      memcpy(&RadioSim->Buf[Offset], Data, Len);
+   }
+   else
+   {
+      memcpy(&RadioSim->Buf[Offset], Data, First);
+      memcpy(RadioSim->Buf, &Data[First], Len - First);
+   }
+   
+} /* End RADIO_SIM_WriteBuffer() */
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetTx
+**
+** Notes:
+**   1. The frame is copied from the data buffer when the transmission
+**      starts so the next payload can be staged while it's on the air.
+**
+*/
+bool RADIO_SIM_SetTx(RADIO_SIM_Class_t *RadioSim)
+{
+   
+   RADIO_SIM_FrameHdr_t *FrameHdr = &RadioSim->FrameHdr;
+   uint16_t First = RADIO_SIM_BUF_LEN - RadioSim->TxBase;
+   uint8_t  Len   = RadioSim->PayloadLen;
+   uint64_t TimeNs;
+   bool     RetStatus = false;
+   
+   Command(RadioSim);
+   
+   pthread_mutex_lock(&RadioSim->Mutex);
+   
+   if (!RadioSim->TxActive)
+   {
+   
+      if (Len <= First)
+      {
+         memcpy(RadioSim->Frame, &RadioSim->Buf[RadioSim->TxBase], Len);
+      }
+      else
+      {
+         memcpy(RadioSim->Frame, &RadioSim->Buf[RadioSim->TxBase], First);
+         memcpy(&RadioSim->Frame[First], RadioSim->Buf, Len - First);
+      }
+   
+      TimeNs = GetTimeNs();
+      FrameHdr->Sync            = RADIO_SIM_FRAME_SYNC;
+      FrameHdr->TimeUs          = (uint32_t)(TimeNs / 1000);
+      FrameHdr->FreqHz          = (uint32_t)(((uint64_t)RadioSim->FreqReg * XTAL_FREQ_HZ + (1 << 17)) >> 18);
+      FrameHdr->AirtimeUs       = TX_TOA_Compute(&RadioSim->Toa, RadioSim->SpreadingFactor, RadioSim->Bandwidth,
+                                                 RadioSim->CodingRate, RadioSim->PreambleLen, Len,
+                                                 TX_TOA_HDR_EXPLICIT);
+      FrameHdr->SpreadingFactor = RadioSim->SpreadingFactor;
+      FrameHdr->Bandwidth       = RadioSim->Bandwidth;
+      FrameHdr->CodingRate      = RadioSim->CodingRate;
+      FrameHdr->PayloadLen      = Len;
+   
+      RadioSim->TxEndNs  = TimeNs + (uint64_t)FrameHdr->AirtimeUs * 1000;
+      RadioSim->TxActive = true;
+      pthread_cond_signal(&RadioSim->Cond);
+   
+      RetStatus = true;
+   
+   }
+   
+   pthread_mutex_unlock(&RadioSim->Mutex);
+   
+   return RetStatus;
+   
+} /* End RADIO_SIM_SetTx() */
+
+
+/******************************************************************************
+** Function: Command
+**
+** Wait for the previous command's BUSY period and start this command's
+**
+*/
+static void Command(RADIO_SIM_Class_t *RadioSim)
+{
+   
+   SleepUntilNs(RadioSim->BusyEndNs);
+   RadioSim->BusyEndNs = GetTimeNs() + RadioSim->BusyNs;
+   
+} /* End Command() */
+
+
+/******************************************************************************
+** Function: FrameLost
+**
+** Notes:
+**   1. Uses a xorshift generator so a seed reproduces a loss pattern.
+**
+*/
+static bool FrameLost(RADIO_SIM_Class_t *RadioSim)
+{
+   
+   uint32_t X = RadioSim->Rand;
+   
+   if (RadioSim->LossPct == 0)
+   {
+      return false;
+   }
+   
+   X ^= X << 13;
+   X ^= X >> 17;
+   X ^= X << 5;
+   RadioSim->Rand = X;
+   
+   return ((X % 100) < RadioSim->LossPct);
+   
+} /* End FrameLost() */
+
+
+/******************************************************************************
+** Function: TxTask
+**
+** Complete each transmission at the end of its time on air
+**
+** Notes:
+**   1. The mutex isn't held while sleeping or calling TxDone so SetTx can
+**      be called from the TxDone callback.
+**
+*/
+static void *TxTask(void *Arg)
+{
+   
+   RADIO_SIM_Class_t *RadioSim = (RADIO_SIM_Class_t *)Arg;
+   uint64_t TxEndNs;
+   ssize_t  HdrLen;
+   ssize_t  FrameLen;
+   
+   pthread_mutex_lock(&RadioSim->Mutex);
+   
+   while (RadioSim->Run)
+   {
+   
+      if (!RadioSim->TxActive)
+      {
+         pthread_cond_wait(&RadioSim->Cond, &RadioSim->Mutex);
+         continue;
+      }
+   
+      TxEndNs = RadioSim->TxEndNs;
+      pthread_mutex_unlock(&RadioSim->Mutex);
+   
+      SleepUntilNs(TxEndNs);
+   
+      RadioSim->TxCnt++;
+      if (FrameLost(RadioSim))
+      {
+         RadioSim->LostCnt++;
+      }
+      else if (RadioSim->OutFd >= 0)
+      {
+         HdrLen   = write(RadioSim->OutFd, &RadioSim->FrameHdr, sizeof(RADIO_SIM_FrameHdr_t));
+         FrameLen = (HdrLen == sizeof(RADIO_SIM_FrameHdr_t)) ?
+                    write(RadioSim->OutFd, RadioSim->Frame, RadioSim->FrameHdr.PayloadLen) : -1;
+         if (FrameLen != RadioSim->FrameHdr.PayloadLen)
+         {
+            RadioSim->OutputErrCnt++;
+         }
+      }
+   
+      pthread_mutex_lock(&RadioSim->Mutex);
+      RadioSim->TxActive = false;
+      pthread_mutex_unlock(&RadioSim->Mutex);
+   
+      if (RadioSim->TxDoneFunc != NULL)
+      {
+         RadioSim->TxDoneFunc(RadioSim->Radio, false);
+      }
+   
+      pthread_mutex_lock(&RadioSim->Mutex);
+   
+   } /* End while run */
+   
+   pthread_mutex_unlock(&RadioSim->Mutex);
+   
+   return NULL;
+   
+} /* End TxTask() */
+
+
+/******************************************************************************
+** Function: GetTimeNs
+**
+*/
+static uint64_t GetTimeNs(void)
+{
+   
+   struct timespec Now;
+   
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+   
+   return (uint64_t)Now.tv_sec * 1000000000ULL + (uint64_t)Now.tv_nsec;
+   
+} /* End GetTimeNs() */
+
+
+/******************************************************************************
+** Function: SleepUntilNs
+**
+*/
+static void SleepUntilNs(uint64_t TimeNs)
+{
+   
+   struct timespec Until;
+   
+   Until.tv_sec  = TimeNs / 1000000000ULL;
+   Until.tv_nsec = TimeNs % 1000000000ULL;
+   
+   while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Until, NULL) == EINTR);
+   
+} /* End SleepUntilNs() */
@@ -0,0 +1,252 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the simulated SX128x radio class
+**
+**  Notes:
+**    1. Stands in for the SX128x driver so the transmit path can run
+**       without a radio. The simulator models the chip's 256 byte data
+**       buffer and TX base address, BUSY latency, time on air and the
+**       TxDone interrupt.
+**    2. Each command waits for the previous command's BUSY period to end
+**       and then starts its own. SetTx starts a transmission that ends
+**       after the packet's time on air for the programmed modulation.
+**    3. A transmission thread pends on the end of each transmission, writes
+**       the frame to the output file unless the frame is lost and invokes
+**       the TxDone callback from its own thread like the driver's IRQ
+**       handler. Lost frames still generate TxDone because a transmitter
+**       can't detect a lost frame.
+**    4. The output is a sequence of RADIO_SIM_FrameHdr_t headers, each
+**       followed by PayloadLen payload bytes, in host byte order. The
+**       output can be a regular file or a named pipe. It's written without
+**       blocking so a slow reader can't change the transmit timing and a
+**       frame that can't be written is counted as an output error.
+**    5. This header shouldn't include cFS header files so the simulator can
+**       be used by host tools.
+**
+*/
+
+#ifndef _radio_sim_
+#define _radio_sim_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "tx_toa.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define RADIO_SIM_BUF_LEN     256          /* SX128x data buffer */
+#define RADIO_SIM_FRAME_SYNC  0x4C4F5241   /* "LORA" */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/*
+** Called from the simulator's transmission thread when a transmission
+** completes. Radio is the configured radio number and the TxTimeout
+** argument is always false.
+*/
+typedef void (*RADIO_SIM_TxDoneFunc_t)(uint8_t Radio, bool TxTimeout);
+
+
+typedef struct
+{
+
+   uint8_t   Radio;        /* Passed to the TxDone callback */
+   uint32_t  BusyUs;       /* BUSY time after each command */
+   uint8_t   LossPct;      /* Percentage of frames not written to the output */
+   uint32_t  Seed;         /* Frame loss pseudo random seed */
+   const char *OutputPath; /* Frame output file or named pipe, NULL or "" disables */
+   
+} RADIO_SIM_Config_t;
+
+
+typedef struct
+{
+
+   uint32_t  Sync;         /* RADIO_SIM_FRAME_SYNC */
+   uint32_t  TimeUs;       /* Transmission start, monotonic clock */
+   uint32_t  FreqHz;
+   uint32_t  AirtimeUs;
+   uint8_t   SpreadingFactor;
+   uint8_t   Bandwidth;
+   uint8_t   CodingRate;
+   uint8_t   PayloadLen;
+   
+} RADIO_SIM_FrameHdr_t;
+
+
+/******************************************************************************
+** RADIO_SIM_Class
+*/
+typedef struct
+{
+
+   uint8_t   Radio;
+   uint64_t  BusyNs;
+   uint8_t   LossPct;
+   uint32_t  Rand;
+   int       OutFd;
+   
+   RADIO_SIM_TxDoneFunc_t TxDoneFunc;
+   TX_TOA_Class_t Toa;
+   
+   /*
+   ** Chip state
+   */
+   
+   uint8_t   SpreadingFactor;
+   uint8_t   Bandwidth;
+   uint8_t   CodingRate;
+   uint16_t  PreambleLen;
+   uint32_t  FreqReg;
+   uint8_t   PayloadLen;
+   uint8_t   TxBase;
+   uint8_t   Buf[RADIO_SIM_BUF_LEN];
+   uint64_t  BusyEndNs;
+   
+   /*
+   ** Transmission thread
+   */
+   
+   pthread_t       Thread;
+   pthread_mutex_t Mutex;
+   pthread_cond_t  Cond;
+   bool            Run;
+   bool            TxActive;
+   uint64_t        TxEndNs;
+   RADIO_SIM_FrameHdr_t FrameHdr;
+   uint8_t         Frame[RADIO_SIM_BUF_LEN];
+   
+   /*
+   ** Statistics
+   */
+   
+   uint32_t  TxCnt;
+   uint32_t  LostCnt;
+   uint32_t  OutputErrCnt;
+   
+} RADIO_SIM_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: RADIO_SIM_Constructor
+**
+** Notes:
+**   1. Opens the output and starts the transmission thread. Returns false
+**      if either fails, e.g. a named pipe without a reader.
+**   2. The chip starts with the same packet configuration as the driver:
+**      RADIO_TX_PREAMBLE_LEN preamble symbols, explicit header and CRC.
+**
+*/
+bool RADIO_SIM_Constructor(RADIO_SIM_Class_t *RadioSim, const RADIO_SIM_Config_t *Config,
+                           RADIO_SIM_TxDoneFunc_t TxDoneFunc);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_Destructor
+**
+** Stop the transmission thread and close the output
+**
+** Notes:
+**   1. A transmission in progress is abandoned without a TxDone.
+**
+*/
+void RADIO_SIM_Destructor(RADIO_SIM_Class_t *RadioSim);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetModulation
+**
+** Notes:
+**   1. Parameters are SX128x register codes.
+**
+*/
+void RADIO_SIM_SetModulation(RADIO_SIM_Class_t *RadioSim, uint8_t SpreadingFactor,
+                             uint8_t Bandwidth, uint8_t CodingRate);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetRfFrequencyReg
+**
+*/
+void RADIO_SIM_SetRfFrequencyReg(RADIO_SIM_Class_t *RadioSim, uint32_t FreqReg);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetPreambleLen
+**
+** Set the packet parameters' preamble length in symbols
+**
+*/
+void RADIO_SIM_SetPreambleLen(RADIO_SIM_Class_t *RadioSim, uint16_t PreambleLen);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetPayloadLen
+**
+** Set the packet parameters' payload length
+**
+*/
+void RADIO_SIM_SetPayloadLen(RADIO_SIM_Class_t *RadioSim, uint8_t PayloadLen);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetTxBase
+**
+*/
+void RADIO_SIM_SetTxBase(RADIO_SIM_Class_t *RadioSim, uint8_t TxBase);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_WriteBuffer
+**
+** Notes:
+**   1. Wraps at the end of the data buffer like the chip.
+**
+*/
+void RADIO_SIM_WriteBuffer(RADIO_SIM_Class_t *RadioSim, uint8_t Offset,
+                           const uint8_t *Data, uint8_t Len);
+
+
+/******************************************************************************
+** Function: RADIO_SIM_SetTx
+**
+** Start transmitting PayloadLen bytes from the TX base address
+**
+** Notes:
+**   1. Returns false if a transmission is in progress.
+**
+*/
+bool RADIO_SIM_SetTx(RADIO_SIM_Class_t *RadioSim);
+
+
+#endif /* _radio_sim_ */
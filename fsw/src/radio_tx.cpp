@@ -29,25 +29,171 @@
 ** Include Files:
 */
 
+#include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include <linux/gpio.h>
+#include <atomic>
+#include <thread>
 #include "SX128x_Linux.hpp"
 extern "C"
 {
    #include "radio_tx.h"
+   #include "radio_sim.h"
 }
 
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define XTAL_FREQ_HZ    52000000ULL   /* SX128x crystal, RF frequency step is XTAL/2^18 */
+
+#define GPIO_SPIN_NS         10000   /* Spin on BUSY this long before blocking on an edge event */
+#define GPIO_BUSY_POLL_MS    10      /* Bounds a BUSY wait if an edge is missed */
+#define GPIO_IRQ_POLL_MS     100     /* IRQ thread checks for a stop request at this period */
+
+#define STAGE_BUF_LEN   256   /* SX128x data buffer */
+
+#define BATCH_MAX_OPS   12    /* SPI transfers, a buffer write uses two and each command after the first adds a BUSY gap */
+#define BATCH_BUF_LEN   64    /* Opcodes and arguments, payloads aren't copied */
+#define BATCH_BUSY_US   50    /* Worst case BUSY after a batched command in STDBY, FS or TX, with margin */
+
+#define REG_SF_CONFIG   0x0925   /* Written by the driver's SetModulationParams() */
+
+#define CHIP_MODE_STDBY_RC    2    /* GetStatus() chip modes the radio idles in */
+#define CHIP_MODE_STDBY_XOSC  3
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/*
+** Opcodes queued for a single SPI_IOC_MESSAGE() ioctl. Each opcode is its
+** own transfer with cs_change set so the chip sees a separate NSS frame per
+** command. A buffer write's payload is a second transfer that points at the
+** caller's buffer and shares the opcode's NSS frame. Commands are separated
+** by a zero length transfer that waits BATCH_BUSY_US, see BatchAdd(). SpiFd
+** is -1 when batching is disabled.
+*/
+typedef struct
+{
+   int      SpiFd = -1;
+   bool     Open;
+   uint8_t  OpCnt;
+   uint16_t BufLen;
+   uint32_t SpiSpeed;
+   uint8_t  Buf[BATCH_BUF_LEN];
+   struct spi_ioc_transfer Xfer[BATCH_MAX_OPS];
+
+} Batch_t;
+
+
+/*
+** Driver with BUSY waits that block on a GPIO character device line event
+** instead of polling. BusyFd is -1 when the driver's polled wait is used.
+*/
+class SX128x_LinuxEvt : public SX128x_Linux
+{
+public:
+   
+   SX128x_LinuxEvt(const std::string &SpiDev, uint16_t SpiDevNum, PinConfig Pins, int BusyLineFd) :
+      SX128x_Linux(SpiDev, SpiDevNum, Pins), BusyFd(BusyLineFd) {}
+   
+   void HalWaitOnBusy() override;
+
+private:
+   
+   int BusyFd;
+
+};
+
+/*
+** Payload staging in the radio's data buffer. TxBase and TxLen describe the
+** last packet sent and the staged payload follows it.
+*/
+typedef struct
+{
+   uint8_t  TxBase;
+   uint8_t  TxLen;
+   bool     Staged;
+   uint8_t  StagedBase;
+   uint8_t  StagedLen;
+
+} Stage_t;
+
+/*
+** GPIO character device line event state. The line event file descriptors
+** are -1 when events aren't used.
+*/
+typedef struct
+{
+   int   BusyFd = -1;
+   int   Dio1Fd = -1;
+   std::atomic<bool> IrqRun{false};
+   std::thread       IrqThread;
+
+} Gpio_t;
+
+
+/*
+** Radio instance. Everything that describes one chip and its driver so
+** radios on different SPI devices and pins operate independently.
+*/
+typedef struct
+{
+   uint8_t  Id;
+   SX128x_Linux *Radio = NULL;
+   bool     DriverIrq = false;   /* The driver's polled IRQ handler is running */
+   SX128x::PacketParams_t PacketParams;
+   Batch_t  Batch;
+   RADIO_TX_Shadow_t Shadow;
+   Stage_t  Stage;
+   Gpio_t   Gpio;
+   bool     SimBackend = false;
+   bool     WarmStarted;
+   RADIO_SIM_Class_t RadioSim;
+
+} RadioInst_t;
+
+
 /**********************/
 /** Global File Data **/
 /**********************/
 
-// Pins based on hardware configuration
-SX128x_Linux *Radio = NULL;
+static RadioInst_t RadioInst[RADIO_TX_MAX_RADIOS];
+
+/* SetTxParams ramp time codes are the table index shifted into bits 7:5 */
+static const uint16_t RampTimeUs[] = {2, 4, 6, 8, 10, 12, 16, 20};
+
+static RADIO_TX_TxDoneFunc_t TxDoneFunc = NULL;
 
 
 /*******************************/
 /** Local Function Prototypes **/
 /*******************************/
 
+static bool InitSim(RadioInst_t *Inst, const RADIO_TX_Config_t *RadioConfig);
+static void SimTxDone(uint8_t Radio, bool TxTimeout);
+static bool ShadowSkip(RadioInst_t *Inst, bool Same);
+static bool RadioConfigured(RadioInst_t *Inst, const RADIO_TX_Config_t *RadioConfig);
+static uint8_t SfConfigReg(uint8_t SpreadingFactor);
+static void DriverClose(RadioInst_t *Inst);
+static void GpioClose(RadioInst_t *Inst);
+static int  GpioLineEvent(int ChipFd, uint8_t Line, uint32_t EventFlags);
+static bool GpioLineValue(int LineFd);
+static void GpioDrainEvents(int LineFd);
+static void GpioIrqTask(RadioInst_t *Inst);
+static bool BatchOpenSpi(RadioInst_t *Inst, const char *SpiDevStr, uint32_t SpiSpeed);
+static bool BatchAdd(RadioInst_t *Inst, uint8_t Opcode, const uint8_t *Arg, uint16_t ArgLen,
+                     const uint8_t *Data, uint16_t DataLen);
+static void ImageAddOp(RADIO_TX_Image_t *Image, uint8_t Opcode, const uint8_t *Arg, uint8_t ArgLen);
+
 /******************************************************************************
 ** Function: RADIO_TX_InitRadio
 **
@@ -55,13 +201,92 @@ SX128x_Linux *Radio = NULL;
 **
 ** Notes:
 **   1. This must be called prior to any other function.
+**   2. The shadow is cleared first because the driver resets the chip, so
+**      the configuration sequence always writes every shadowed setting.
+**   3. The batch SPI device is opened last so a failure to open it fails
+**      the initialization rather than silently falling back to unbatched
+**      transfers.
+**   4. The GPIO lines are requested before the driver is created. If either
+**      line can't be requested the driver gets both pins and polls them.
+**   5. The simulated backend replaces the driver. It doesn't use the SPI
+**      device or pins so batching and GPIO events are disabled.
+**   6. The driver's callbacks capture the instance so each radio's TxDone
+**      is reported with its own radio number.
+**   7. The driver's constructor doesn't touch the chip, its Init() resets
+**      it. A warm start skips Init() and the chip level settings when
+**      RadioConfigured() shows this app configured the radio since its last
+**      reset. The settings without a readback are written and the IRQs
+**      left by the previous run are cleared. The chip is in STDBY so none
+**      of this disturbs it, and the shadow ends up the same as a cold start.
+**   8. A previous driver is stopped and deleted before the new one is
+**      created so its IRQ handler can't report TxDone for the new driver
+**      or access the same SPI device and pins.
+**   9. Batching is refused when the driver's NSS GPIO isn't the SPI
+**      device's hardware chip select because batched commands would never
+**      be framed by the radio's NSS.
 **
 */
-bool RADIO_TX_InitRadio(const char *SpiDevStr, uint8_t SpiDevNum, const RADIO_TX_Pin_t *RadioPin)
+bool RADIO_TX_InitRadio(uint8_t Radio, const char *SpiDevStr, uint8_t SpiDevNum, 
+                        const RADIO_TX_Pin_t *RadioPin,
+                        const RADIO_TX_Config_t *RadioConfig)
 {
    bool RetStatus = false;
    
+   RadioInst_t *Inst;
    SX128x_Linux::PinConfig PinConfig;
+   int ChipFd;
+   
+   if (Radio >= RADIO_TX_MAX_RADIOS)
+   {
+      return false;
+   }
+   
+   Inst = &RadioInst[Radio];
+   Inst->Id = Radio;
+   Inst->WarmStarted = false;
+   
+   memset(&Inst->Shadow, 0, sizeof(RADIO_TX_Shadow_t));
+   memset(&Inst->Stage, 0, sizeof(Stage_t));
+   
+   Inst->Batch.Open  = false;
+   Inst->Batch.OpCnt = 0;
+   if (Inst->Batch.SpiFd >= 0)
+   {
+      close(Inst->Batch.SpiFd);
+      Inst->Batch.SpiFd = -1;
+   }
+   
+   DriverClose(Inst);
+   if (Inst->SimBackend)
+   {
+      RADIO_SIM_Destructor(&Inst->RadioSim);
+      Inst->SimBackend = false;
+   }
+   
+   if (RadioConfig->Backend == RADIO_TX_BACKEND_SIM)
+   {
+      return InitSim(Inst, RadioConfig);
+   }
+   
+   if (RadioConfig->SpiBatch && RadioPin->Nss != RADIO_TX_SpiCeGpio(SpiDevStr))
+   {
+      return false;
+   }
+   
+   if (RadioConfig->GpioChip != NULL && RadioConfig->GpioChip[0] != '\0')
+   {
+      ChipFd = open(RadioConfig->GpioChip, O_RDONLY);
+      if (ChipFd >= 0)
+      {
+         Inst->Gpio.BusyFd = GpioLineEvent(ChipFd, RadioPin->Busy, GPIOEVENT_REQUEST_FALLING_EDGE);
+         Inst->Gpio.Dio1Fd = GpioLineEvent(ChipFd, RadioPin->Dio1, GPIOEVENT_REQUEST_RISING_EDGE);
+         close(ChipFd);
+      }
+      if (Inst->Gpio.BusyFd < 0 || Inst->Gpio.Dio1Fd < 0)
+      {
+         GpioClose(Inst);
+      }
+   }
    
    PinConfig.busy  = RadioPin->Busy;
    PinConfig.nrst  = RadioPin->Nrst;
@@ -71,14 +296,84 @@ bool RADIO_TX_InitRadio(const char *SpiDevStr, uint8_t SpiDevNum, const RADIO_TX
    PinConfig.dio3  = RadioPin->Dio3;
    PinConfig.tx_en = RadioPin->TxEn;
    PinConfig.rx_en = RadioPin->RxEn;
+   if (Inst->Gpio.BusyFd >= 0)
+   {
+      /* The line events own BUSY and DIO1 */
+      PinConfig.busy = -1;
+      PinConfig.dio1 = -1;
+   }
    
    try
    {
-      Radio = new SX128x_Linux(SpiDevStr, SpiDevNum, PinConfig);
-      RetStatus = true;
+      
+      Inst->Radio = new SX128x_LinuxEvt(SpiDevStr, SpiDevNum, PinConfig, Inst->Gpio.BusyFd);
+      
+      Inst->Radio->SetSpiSpeed(RadioConfig->SpiSpeed);
+      Inst->Shadow.SpiSpeed = RadioConfig->SpiSpeed;
+      
+      Inst->WarmStarted = RadioConfig->WarmStart && RadioConfigured(Inst, RadioConfig);
+      if (Inst->WarmStarted)
+      {
+         Inst->Radio->ClearIrqStatus(SX128x::IRQ_RADIO_ALL);
+      }
+      else
+      {
+         Inst->Radio->Init();
+         Inst->Radio->SetStandby(SX128x::STDBY_XOSC);
+         Inst->Radio->SetRegulatorMode(static_cast<SX128x::RadioRegulatorModes_t>(0));
+         Inst->Radio->SetLNAGainSetting(SX128x::LNA_HIGH_SENSITIVITY_MODE);
+         Inst->Radio->SetPacketType(SX128x::PACKET_TYPE_LORA);
+      }
+      Inst->Radio->SetTxParams(0, SX128x::RADIO_RAMP_20_US);
+      Inst->Shadow.TxPower    = 0;
+      Inst->Shadow.TxRampTime = SX128x::RADIO_RAMP_20_US;
+      Inst->Radio->SetBufferBaseAddresses(0x00, 0x00);
+      
+      Inst->PacketParams.PacketType = SX128x::PACKET_TYPE_LORA;
+      Inst->PacketParams.Params.LoRa.PreambleLength = RADIO_TX_PREAMBLE_LEN;
+      Inst->PacketParams.Params.LoRa.HeaderType     = SX128x::LORA_PACKET_VARIABLE_LENGTH;
+      Inst->PacketParams.Params.LoRa.PayloadLength  = RADIO_TX_MAX_PAYLOAD_LEN;
+      Inst->PacketParams.Params.LoRa.Crc            = SX128x::LORA_CRC_ON;
+      Inst->PacketParams.Params.LoRa.InvertIQ       = SX128x::LORA_IQ_NORMAL;
+
+      RADIO_TX_SetLoraParams(Inst->Id, RadioConfig->SpreadingFactor,
+                             RadioConfig->Bandwidth,
+                             RadioConfig->CodingRate);
+      Inst->Radio->SetPacketParams(Inst->PacketParams);
+      Inst->Shadow.PreambleLen = Inst->PacketParams.Params.LoRa.PreambleLength;
+      Inst->Shadow.HeaderType  = Inst->PacketParams.Params.LoRa.HeaderType;
+      Inst->Shadow.PayloadLen  = Inst->PacketParams.Params.LoRa.PayloadLength;
+      Inst->Shadow.Crc         = Inst->PacketParams.Params.LoRa.Crc;
+      Inst->Shadow.InvertIQ    = Inst->PacketParams.Params.LoRa.InvertIQ;
+      RADIO_TX_SetRadioFrequency(Inst->Id, RadioConfig->Frequency);
+      
+      Inst->Radio->callbacks.txDone = [Inst]{
+         if (TxDoneFunc != NULL) TxDoneFunc(Inst->Id, false);
+      };
+      Inst->Radio->callbacks.txTimeout = [Inst]{
+         if (TxDoneFunc != NULL) TxDoneFunc(Inst->Id, true);
+      };
+      
+      uint16_t IrqMask = SX128x::IRQ_TX_DONE | SX128x::IRQ_RX_TX_TIMEOUT;
+      Inst->Radio->SetDioIrqParams(IrqMask, IrqMask, SX128x::IRQ_RADIO_NONE, SX128x::IRQ_RADIO_NONE);
+      if (Inst->Gpio.Dio1Fd >= 0)
+      {
+         Inst->Gpio.IrqRun    = true;
+         Inst->Gpio.IrqThread = std::thread(GpioIrqTask, Inst);
+      }
+      else
+      {
+         Inst->Radio->StartIrqHandler();
+         Inst->DriverIrq = true;
+      }
+      
+      RetStatus = RadioConfig->SpiBatch ? BatchOpenSpi(Inst, SpiDevStr, RadioConfig->SpiSpeed) : true;
+      Inst->Shadow.Valid = RetStatus;
+   
    }
    catch (...)
    {
+      DriverClose(Inst);
       RetStatus = false;
    }
    
@@ -87,29 +382,63 @@ bool RADIO_TX_InitRadio(const char *SpiDevStr, uint8_t SpiDevNum, const RADIO_TX
 } /* End RADIO_TX_InitRadio() */
 
 
+/******************************************************************************
+** Function: RADIO_TX_SetTxDoneCallback
+**
+** Register the function that is called when a transmission completes
+**
+*/
+void RADIO_TX_SetTxDoneCallback(RADIO_TX_TxDoneFunc_t NewTxDoneFunc)
+{
+   
+   TxDoneFunc = NewTxDoneFunc;
+   
+} /* End RADIO_TX_SetTxDoneCallback() */
+
+
 /******************************************************************************
 ** Function: RADIO_TX_SetLoraParams
 **
 ** Set the radio Lora parameters
 **
 ** Notes:
-**   None
+**   1. Not batched. The driver follows SetModulationParams with spreading
+**      factor dependent register writes, one of them read-modify-write.
 **
 */
-bool RADIO_TX_SetLoraParams(uint8_t SpreadingFactor,
+bool RADIO_TX_SetLoraParams(uint8_t Radio, uint8_t SpreadingFactor,
                             uint8_t Bandwidth,
                             uint8_t CodingRate)
 {
    
+   RadioInst_t *Inst = &RadioInst[Radio];
    SX128x::ModulationParams_t ModulationParams;
    
-   ModulationParams.PacketType                  = SX128x::PACKET_TYPE_LORA;
-   ModulationParams.Params.LoRa.CodingRate      = (SX128x::RadioLoRaCodingRates_t)CodingRate;
-   ModulationParams.Params.LoRa.Bandwidth       = (SX128x::RadioLoRaBandwidths_t)Bandwidth;
-   ModulationParams.Params.LoRa.SpreadingFactor = (SX128x::RadioLoRaSpreadingFactors_t)SpreadingFactor;
-
-   Radio->SetModulationParams(ModulationParams);
-
+   if (ShadowSkip(Inst, Inst->Shadow.SpreadingFactor == SpreadingFactor &&
+                  Inst->Shadow.Bandwidth       == Bandwidth       &&
+                  Inst->Shadow.CodingRate      == CodingRate))
+   {
+      return true;
+   }
+   
+   if (Inst->SimBackend)
+   {
+      RADIO_SIM_SetModulation(&Inst->RadioSim, SpreadingFactor, Bandwidth, CodingRate);
+   }
+   else
+   {
+      ModulationParams.PacketType                  = SX128x::PACKET_TYPE_LORA;
+      ModulationParams.Params.LoRa.CodingRate      = (SX128x::RadioLoRaCodingRates_t)CodingRate;
+      ModulationParams.Params.LoRa.Bandwidth       = (SX128x::RadioLoRaBandwidths_t)Bandwidth;
+      ModulationParams.Params.LoRa.SpreadingFactor = (SX128x::RadioLoRaSpreadingFactors_t)SpreadingFactor;
+      
+      RADIO_TX_BatchSubmit(Inst->Id);
+      Inst->Radio->SetModulationParams(ModulationParams);
+   }
+   Inst->Shadow.SpreadingFactor = SpreadingFactor;
+   Inst->Shadow.Bandwidth       = Bandwidth;
+   Inst->Shadow.CodingRate      = CodingRate;
+   
    return true;
    
 } /* RADIO_TX_SetLoraParams() */
@@ -123,10 +452,23 @@ bool RADIO_TX_SetLoraParams(uint8_t SpreadingFactor,
 **   1. Assumes Radio has been initialized and speed value has been validated 
 **
 */
-bool RADIO_TX_SetSpiSpeed(uint32_t SpiSpeed)
+bool RADIO_TX_SetSpiSpeed(uint8_t Radio, uint32_t SpiSpeed)
 {
    
-   Radio->SetSpiSpeed(SpiSpeed);
+   RadioInst_t *Inst = &RadioInst[Radio];
+   
+   if (ShadowSkip(Inst, Inst->Shadow.SpiSpeed == SpiSpeed))
+   {
+      return true;
+   }
+   
+   if (!Inst->SimBackend)
+   {
+      RADIO_TX_BatchSubmit(Inst->Id);
+      Inst->Radio->SetSpiSpeed(SpiSpeed);
+   }
+   Inst->Batch.SpiSpeed  = SpiSpeed;
+   Inst->Shadow.SpiSpeed = SpiSpeed;
    
    return true;
    
@@ -142,177 +484,1048 @@ bool RADIO_TX_SetSpiSpeed(uint32_t SpiSpeed)
 ** Notes:
 **   1. Assumes Radio has been initialized and frequency (Hz) value has been
 **      validated 
+**   2. The register value is truncated the same way as the driver's
+**      SetRfFrequency()
 **
 */
-bool RADIO_TX_SetRadioFrequency(uint32_t Frequency)
+bool RADIO_TX_SetRadioFrequency(uint8_t Radio, uint32_t Frequency)
 {
    
-   Radio->SetRfFrequency(Frequency);
-   
-   return true;
+   return RADIO_TX_SetRfFrequencyReg(Radio, (uint32_t)(((uint64_t)Frequency << 18) / XTAL_FREQ_HZ));
    
 } /* End RADIO_TX_SetRadioFrequency() */
 
 
-/* Pete's initial command list
-#define GPIO_CTRL_SET_FREQ_EID     (GPIO_CTRL_BASE_EID + 4)
-#define GPIO_CTRL_SET_TCXOEN_EID   (GPIO_CTRL_BASE_EID + 5)
-#define GPIO_CTRL_SET_HSM_EID      (GPIO_CTRL_BASE_EID + 6)
-#define GPIO_CTRL_SET_POWER_EID    (GPIO_CTRL_BASE_EID + 7)
-#define GPIO_CTRL_SET_MOD_EID      (GPIO_CTRL_BASE_EID + 8)
-#define GPIO_CTRL_SET_BW_EID       (GPIO_CTRL_BASE_EID + 9)
-#define GPIO_CTRL_SET_SF_EID       (GPIO_CTRL_BASE_EID + 10)
-#define GPIO_CTRL_SET_CR_EID       (GPIO_CTRL_BASE_EID + 11)
-#define GPIO_CTRL_SET_CRC_EID      (GPIO_CTRL_BASE_EID + 12)
-#define GPIO_CTRL_SET_LDRO_EID     (GPIO_CTRL_BASE_EID + 13)
-#define GPIO_CTRL_SET_NODE_EID     (GPIO_CTRL_BASE_EID + 14)
-#define GPIO_CTRL_SET_DEST_EID     (GPIO_CTRL_BASE_EID + 15)
-#define GPIO_CTRL_SET_TXPA_EID     (GPIO_CTRL_BASE_EID + 14)
-#define GPIO_CTRL_SET_RXLNA_EID    (GPIO_CTRL_BASE_EID + 15)
+/******************************************************************************
+** Function: RADIO_TX_SetRfFrequencyReg
+**
+** Set the radio frequency using a precomputed RF frequency register value
+**
+** Notes:
+**   1. Assumes Radio has been initialized and the register value has been
+**      validated
+**   2. Queued when a batch is open
+**
 */
-/*******
-int main(int argc, char **argv) {
-	if (argc < 3) {
-		printf("Usage: Lora_tx <freq in MHz> <file to send>\n");
-		return 1;
-	}
-
-	// Pins based on hardware configuration
-	SX128x_Linux Radio("/dev/spidev0.0", 0, {27, 26, 20, 16, -1, -1, 24, 25});
-
-	// Assume we're running on a high-end Raspberry Pi,
-	// so we set the SPI clock speed to the maximum value supported by the chip
-	Radio.SetSpiSpeed(8000000);
-
-
-	Radio.Init();
-	puts("Init done");
-	Radio.SetStandby(SX128x::STDBY_XOSC);
-	puts("SetStandby done");
-	Radio.SetRegulatorMode(static_cast<SX128x::RadioRegulatorModes_t>(0));
-	puts("SetRegulatorMode done");
-	Radio.SetLNAGainSetting(SX128x::LNA_HIGH_SENSITIVITY_MODE);
-	puts("SetLNAGainSetting done");
-	Radio.SetTxParams(0, SX128x::RADIO_RAMP_20_US);
-	puts("SetTxParams done");
-
-	Radio.SetBufferBaseAddresses(0x00, 0x00);
-	puts("SetBufferBaseAddresses done");
-
-
-	SX128x::ModulationParams_t ModulationParams;
-	SX128x::PacketParams_t PacketParams;
-
-    // Modulation Parameters
-    ModulationParams.PacketType = SX128x::PACKET_TYPE_LORA;
-    ModulationParams.Params.LoRa.CodingRate = SX128x::LORA_CR_4_8;
-    ModulationParams.Params.LoRa.Bandwidth = SX128x::LORA_BW_1600;
-    ModulationParams.Params.LoRa.SpreadingFactor = SX128x::LORA_SF7;
-
-    PacketParams.PacketType = SX128x::PACKET_TYPE_LORA;
-
-    // Packet Parameters
-    auto &l = PacketParams.Params.LoRa;
-    // l.PayloadLength = PACKET_SIZE;
-    l.HeaderType = SX128x::LORA_PACKET_VARIABLE_LENGTH;
-    l.PreambleLength = 12;
-    l.Crc = SX128x::LORA_CRC_ON;
-    l.InvertIQ = SX128x::LORA_IQ_NORMAL;
-
-    Radio.SetPacketType(SX128x::PACKET_TYPE_LORA);
+bool RADIO_TX_SetRfFrequencyReg(uint8_t Radio, uint32_t FreqReg)
+{
+   
+   RadioInst_t *Inst = &RadioInst[Radio];
+   uint8_t Buf[3];
+   
+   if (ShadowSkip(Inst, Inst->Shadow.FreqReg == FreqReg))
+   {
+      return true;
+   }
+   
+   Buf[0] = (uint8_t)(FreqReg >> 16);
+   Buf[1] = (uint8_t)(FreqReg >> 8);
+   Buf[2] = (uint8_t)FreqReg;
+   
+   if (Inst->SimBackend)
+   {
+      RADIO_SIM_SetRfFrequencyReg(&Inst->RadioSim, FreqReg);
+   }
+   else if (!BatchAdd(Inst, SX128x::RADIO_SET_RFFREQUENCY, Buf, sizeof(Buf), NULL, 0))
+   {
+      Inst->Radio->WriteCommand(SX128x::RADIO_SET_RFFREQUENCY, Buf, sizeof(Buf));
+   }
+   Inst->Shadow.FreqReg   = FreqReg;
+   Inst->Shadow.Frequency = (uint32_t)(((uint64_t)FreqReg * XTAL_FREQ_HZ + (1 << 17)) >> 18);
 
-	puts("SetPacketType done");
-	Radio.SetModulationParams(ModulationParams);
-	puts("SetModulationParams done");
-	Radio.SetPacketParams(PacketParams);
-	puts("SetPacketParams done");
+   return true;
 
-	auto freq = strtol(argv[1], nullptr, 10);
-	Radio.SetRfFrequency(freq * 1000000UL);
-	puts("SetRfFrequency done");
+} /* End RADIO_TX_SetRfFrequencyReg() */
 
-	std::cout << "Firmware version: " << Radio.GetFirmwareVersion() << "\n";
 
-    // TX done interrupt handler
-	Radio.callbacks.txDone = []{
-		puts("Done!");
-	};
+/******************************************************************************
+** Function: RADIO_TX_CompileProfile
+**
+** Compile a profile into the commands that program it
+**
+** Notes:
+**   1. The commands match the driver's SetModulationParams(), including
+**      its spreading factor dependent register write, followed by
+**      SetPacketParams, SetRfFrequency and SetTxParams. The driver's
+**      read-modify-write of the frequency error compensation register is
+**      omitted because it sets the same bit for every spreading factor and
+**      InitRadio() has already set it.
+**   2. The preamble uses the smallest exponent that represents it exactly.
+**
+*/
+bool RADIO_TX_CompileProfile(const RADIO_TX_Profile_t *Profile, RADIO_TX_Image_t *Image)
+{
+   
+   uint8_t  Arg[7];
+   uint8_t  Exp;
+   uint8_t  Ramp;
+   
+   memset(Image, 0, sizeof(RADIO_TX_Image_t));
+   
+   if (Profile->TxPower < -18 || Profile->TxPower > 13)
+   {
+      return false;
+   }
+   
+   for (Ramp = 0; Ramp < (sizeof(RampTimeUs)/sizeof(RampTimeUs[0])); Ramp++)
+   {
+      if (RampTimeUs[Ramp] == Profile->TxRampUs) break;
+   }
+   if (Ramp == (sizeof(RampTimeUs)/sizeof(RampTimeUs[0])))
+   {
+      return false;
+   }
+   
+   for (Exp = 0; Exp < 16; Exp++)
+   {
+      if ((Profile->PreambleLen >> Exp) < 16 && ((uint32_t)(Profile->PreambleLen >> Exp) << Exp) == Profile->PreambleLen) break;
+   }
+   if (Profile->PreambleLen == 0 || Exp == 16)
+   {
+      return false;
+   }
+   
+   Image->SpreadingFactor = Profile->SpreadingFactor;
+   Image->Bandwidth       = Profile->Bandwidth;
+   Image->CodingRate      = Profile->CodingRate;
+   Image->PreambleLen     = (uint8_t)((Exp << 4) | (Profile->PreambleLen >> Exp));
+   Image->PreambleSym     = Profile->PreambleLen;
+   Image->InvertIQ        = Profile->InvertIQ ? SX128x::LORA_IQ_INVERTED : SX128x::LORA_IQ_NORMAL;
+   Image->TxPower         = Profile->TxPower;
+   Image->TxRampTime      = (uint8_t)(Ramp << 5);
+   if (Profile->Frequency != 0)
+   {
+      Image->FreqReg = (uint32_t)(((uint64_t)Profile->Frequency << 18) / XTAL_FREQ_HZ);
+   }
+   
+   Arg[0] = Image->SpreadingFactor;
+   Arg[1] = Image->Bandwidth;
+   Arg[2] = Image->CodingRate;
+   ImageAddOp(Image, SX128x::RADIO_SET_MODULATIONPARAMS, Arg, 3);
+   
+   Arg[0] = (uint8_t)(REG_SF_CONFIG >> 8);
+   Arg[1] = (uint8_t)REG_SF_CONFIG;
+   Arg[2] = SfConfigReg(Image->SpreadingFactor);
+   ImageAddOp(Image, SX128x::RADIO_WRITE_REGISTER, Arg, 3);
+   
+   Arg[0] = Image->PreambleLen;
+   Arg[1] = SX128x::LORA_PACKET_VARIABLE_LENGTH;
+   Arg[2] = RADIO_TX_MAX_PAYLOAD_LEN;
+   Arg[3] = SX128x::LORA_CRC_ON;
+   Arg[4] = Image->InvertIQ;
+   Arg[5] = 0;
+   Arg[6] = 0;
+   Image->PayloadLenIdx = (uint8_t)(Image->BufLen + 3);
+   ImageAddOp(Image, SX128x::RADIO_SET_PACKETPARAMS, Arg, 7);
+   
+   if (Image->FreqReg != 0)
+   {
+      Arg[0] = (uint8_t)(Image->FreqReg >> 16);
+      Arg[1] = (uint8_t)(Image->FreqReg >> 8);
+      Arg[2] = (uint8_t)Image->FreqReg;
+      ImageAddOp(Image, SX128x::RADIO_SET_RFFREQUENCY, Arg, 3);
+   }
+   
+   Arg[0] = (uint8_t)(Image->TxPower + 18);
+   Arg[1] = Image->TxRampTime;
+   ImageAddOp(Image, SX128x::RADIO_SET_TXPARAMS, Arg, 2);
+   
+   return true;
+   
+} /* End RADIO_TX_CompileProfile() */
 
-	auto IrqMask = SX128x::IRQ_TX_DONE | SX128x::IRQ_RX_TX_TIMEOUT;
-	Radio.SetDioIrqParams(IrqMask, IrqMask, SX128x::IRQ_RADIO_NONE, SX128x::IRQ_RADIO_NONE);
-	puts("SetDioIrqParams done");
 
-	Radio.StartIrqHandler();
-	puts("StartIrqHandler done");
+/******************************************************************************
+** Function: RADIO_TX_ApplyImage
+**
+** Program a compiled profile in a single batch
+**
+** Notes:
+**   1. The commands are copied so the payload length can be patched and
+**      the unbatched driver path can take non-const arguments.
+**   2. Every command is a configuration command with a short BUSY period
+**      that the batch's BUSY gap covers, see BatchAdd().
+**
+*/
+bool RADIO_TX_ApplyImage(uint8_t Radio, const RADIO_TX_Image_t *Image)
+{
+   
+   RadioInst_t *Inst = &RadioInst[Radio];
+   bool     RetStatus = true;
+   uint8_t  Buf[RADIO_TX_IMAGE_BUF_LEN];
+   uint8_t *Op;
+   uint8_t  i;
+   
+   if (ShadowSkip(Inst, Inst->Shadow.SpreadingFactor == Image->SpreadingFactor &&
+                  Inst->Shadow.Bandwidth       == Image->Bandwidth       &&
+                  Inst->Shadow.CodingRate      == Image->CodingRate      &&
+                  Inst->Shadow.PreambleLen     == Image->PreambleLen     &&
+                  Inst->Shadow.InvertIQ        == Image->InvertIQ        &&
+                  Inst->Shadow.TxPower         == Image->TxPower         &&
+                  Inst->Shadow.TxRampTime      == Image->TxRampTime      &&
+                  (Image->FreqReg == 0 || Inst->Shadow.FreqReg == Image->FreqReg)))
+   {
+      return true;
+   }
+   
+   if (Inst->SimBackend)
+   {
+      RADIO_SIM_SetModulation(&Inst->RadioSim, Image->SpreadingFactor, Image->Bandwidth, Image->CodingRate);
+      RADIO_SIM_SetPreambleLen(&Inst->RadioSim, Image->PreambleSym);
+      if (Image->FreqReg != 0)
+      {
+         RADIO_SIM_SetRfFrequencyReg(&Inst->RadioSim, Image->FreqReg);
+      }
+   }
+   else
+   {
+      memcpy(Buf, Image->Buf, Image->BufLen);
+      Buf[Image->PayloadLenIdx] = Inst->Shadow.PayloadLen;
+      
+      RADIO_TX_BatchBegin(Inst->Id);
+      for (i = 0, Op = Buf; i < Image->OpCnt; Op += Image->OpLen[i++])
+      {
+         if (!BatchAdd(Inst, Op[0], &Op[1], Image->OpLen[i] - 1, NULL, 0))
+         {
+            Inst->Radio->WriteCommand((SX128x::RadioCommands_t)Op[0], &Op[1], Image->OpLen[i] - 1);
+         }
+      }
+      RetStatus = RADIO_TX_BatchSubmit(Inst->Id);
+   }
+   
+   Inst->PacketParams.Params.LoRa.PreambleLength = Image->PreambleLen;
+   Inst->PacketParams.Params.LoRa.InvertIQ       = (SX128x::RadioLoRaIQModes_t)Image->InvertIQ;
+   
+   Inst->Shadow.SpreadingFactor = Image->SpreadingFactor;
+   Inst->Shadow.Bandwidth       = Image->Bandwidth;
+   Inst->Shadow.CodingRate      = Image->CodingRate;
+   Inst->Shadow.PreambleLen     = Image->PreambleLen;
+   Inst->Shadow.InvertIQ        = Image->InvertIQ;
+   Inst->Shadow.TxPower         = Image->TxPower;
+   Inst->Shadow.TxRampTime      = Image->TxRampTime;
+   if (Image->FreqReg != 0)
+   {
+      Inst->Shadow.FreqReg   = Image->FreqReg;
+      Inst->Shadow.Frequency = (uint32_t)(((uint64_t)Image->FreqReg * XTAL_FREQ_HZ + (1 << 17)) >> 18);
+   }
+   
+   return RetStatus;
+   
+} /* End RADIO_TX_ApplyImage() */
 
 
-	auto pkt_ToA = Radio.GetTimeOnAir();
+/******************************************************************************
+** Function: RADIO_TX_SendPayload
+**
+** Load a payload into the radio's data buffer and start the transmission
+**
+** Notes:
+**   1. Assumes Radio has been initialized, the radio isn't transmitting and
+**      the payload length has been validated
+**   2. The radio is idle so the whole data buffer is free. Any staged
+**      payload is discarded and this payload is staged and sent.
+**
+*/
+bool RADIO_TX_SendPayload(uint8_t Radio, const uint8_t *Payload, uint8_t PayloadLen, uint32_t TimeOnAir)
+{
+   
+   RadioInst_t *Inst = &RadioInst[Radio];
+   
+   Inst->Stage.Staged = false;
+   Inst->Stage.TxLen  = 0;
+   
+   return (RADIO_TX_StagePayload(Inst->Id, Payload, PayloadLen) && RADIO_TX_SendStaged(Inst->Id, TimeOnAir));
+   
+} /* End RADIO_TX_SendPayload() */
 
-    // Open file
-    std::ifstream fileToSend(argv[2], std::ios::binary);
 
-    // Get size and number of packets
-    fileToSend.seekg(0, std::ios::end);
-    unsigned int fileSize = fileToSend.tellg();
-    unsigned int numPackets = (fileSize + PACKET_SIZE - 1) / PACKET_SIZE;
+/******************************************************************************
+** Function: RADIO_TX_StagePayload
+**
+** Write a payload to the radio's data buffer without starting a transmission
+**
+** Notes:
+**   1. The payload is written at the next base address after the packet
+**      that is on the air so the transmission isn't disturbed. The buffer
+**      wraps at 256 bytes so both packets must fit.
+**   2. The payload is written from the caller's buffer so no intermediate
+**      copy is made. The driver's API isn't const correct.
+**   3. The packet parameters aren't written here because they apply to the
+**      packet on the air.
+**
+*/
+bool RADIO_TX_StagePayload(uint8_t Radio, const uint8_t *Payload, uint8_t PayloadLen)
+{
+   
+   RadioInst_t *Inst = &RadioInst[Radio];
+   bool    RetStatus = false;
+   uint8_t Base;
+   
+   if (!Inst->Stage.Staged && ((uint16_t)Inst->Stage.TxLen + PayloadLen) <= STAGE_BUF_LEN)
+   {
+      
+      Base = (uint8_t)(Inst->Stage.TxBase + Inst->Stage.TxLen);
+      
+      RADIO_TX_BatchBegin(Inst->Id);
+      if (BatchAdd(Inst, SX128x::RADIO_WRITE_BUFFER, &Base, 1, Payload, PayloadLen))
+      {
+         RetStatus = RADIO_TX_BatchSubmit(Inst->Id);
+      }
+      else if (Inst->SimBackend)
+      {
+         RADIO_SIM_WriteBuffer(&Inst->RadioSim, Base, Payload, PayloadLen);
+         RetStatus = true;
+      }
+      else
+      {
+         Inst->Radio->WriteBuffer(Base, const_cast<uint8_t *>(Payload), PayloadLen);
+         RetStatus = true;
+      }
+      
+      if (RetStatus)
+      {
+         Inst->Stage.Staged     = true;
+         Inst->Stage.StagedBase = Base;
+         Inst->Stage.StagedLen  = PayloadLen;
+      }
+   }
+   
+   return RetStatus;
+   
+} /* End RADIO_TX_StagePayload() */
 
-    // Seek back to start
-    fileToSend.seekg(0, std::ios::beg);
 
+/******************************************************************************
+** Function: RADIO_TX_SendStaged
+**
+** Start transmitting the staged payload
+**
+** Notes:
+**   1. Only the packet parameters (when the length changed), the TX base
+**      address (when it changed) and SetTx are sent so the time between
+**      packets doesn't include the payload write.
+**   2. When batching, the packet parameters and base address join any open
+**      batch and are submitted in one ioctl. SetTx always goes through the
+**      driver because the driver's IRQ handler only reports TxDone when it
+**      started the transmission. The driver waits on BUSY before SetTx so
+**      this is the only BUSY wait per packet.
+**   3. The TX timeout is derived from the packet's time on air so long
+**      packets, e.g. SF12 at 203 kHz, aren't aborted. Its margin is shorter
+**      than the caller's TxDone wait so the radio reports the timeout.
+**
+*/
+bool RADIO_TX_SendStaged(uint8_t Radio, uint32_t TimeOnAir)
+{
+   
+   RadioInst_t *Inst = &RadioInst[Radio];
+   bool     RetStatus = true;
+   uint32_t TimeoutMs = (TimeOnAir / 1000) + 1 + RADIO_TX_TIMEOUT_MARGIN;
+   SX128x::TickTime_t TxTimeout;
+   uint8_t  Buf[7];
+   
+   if (!Inst->Stage.Staged)
+   {
+      return false;
+   }
+   
+   RADIO_TX_BatchBegin(Inst->Id);
+   
+   if (Inst->Shadow.PayloadLen != Inst->Stage.StagedLen)
+   {
+      Inst->PacketParams.Params.LoRa.PayloadLength = Inst->Stage.StagedLen;
+      Inst->Shadow.PayloadLen = Inst->Stage.StagedLen;
+      Buf[0] = Inst->PacketParams.Params.LoRa.PreambleLength;
+      Buf[1] = Inst->PacketParams.Params.LoRa.HeaderType;
+      Buf[2] = Inst->PacketParams.Params.LoRa.PayloadLength;
+      Buf[3] = Inst->PacketParams.Params.LoRa.Crc;
+      Buf[4] = Inst->PacketParams.Params.LoRa.InvertIQ;
+      Buf[5] = 0;
+      Buf[6] = 0;
+      if (Inst->SimBackend)
+      {
+         RADIO_SIM_SetPayloadLen(&Inst->RadioSim, Inst->Stage.StagedLen);
+      }
+      else if (!BatchAdd(Inst, SX128x::RADIO_SET_PACKETPARAMS, Buf, sizeof(Buf), NULL, 0))
+      {
+         Inst->Radio->SetPacketParams(Inst->PacketParams);
+      }
+   }
+   
+   if (Inst->Shadow.TxBaseAddr != Inst->Stage.StagedBase)
+   {
+      Inst->Shadow.TxBaseAddr = Inst->Stage.StagedBase;
+      Buf[0] = Inst->Stage.StagedBase;
+      Buf[1] = 0;
+      if (Inst->SimBackend)
+      {
+         RADIO_SIM_SetTxBase(&Inst->RadioSim, Inst->Stage.StagedBase);
+      }
+      else if (!BatchAdd(Inst, SX128x::RADIO_SET_BUFFERBASEADDRESS, Buf, 2, NULL, 0))
+      {
+         Inst->Radio->SetBufferBaseAddresses(Inst->Stage.StagedBase, 0x00);
+      }
+   }
+   
+   if (Inst->SimBackend)
+   {
+      RetStatus = RADIO_SIM_SetTx(&Inst->RadioSim);
+   }
+   else
+   {
+      RetStatus = RADIO_TX_BatchSubmit(Inst->Id);
+      if (RetStatus)
+      {
+         TxTimeout.Step    = SX128x::RADIO_TICK_SIZE_1000_US;
+         TxTimeout.NbSteps = (uint16_t)((TimeoutMs > RADIO_TX_TIMEOUT_MAX) ? RADIO_TX_TIMEOUT_MAX : TimeoutMs);
+         Inst->Radio->SetTx(TxTimeout);
+      }
+   }
+   
+   Inst->Stage.Staged = false;
+   Inst->Stage.TxBase = Inst->Stage.StagedBase;
+   Inst->Stage.TxLen  = Inst->Stage.StagedLen;
+   
+   return RetStatus;
+   
+} /* End RADIO_TX_SendStaged() */
 
-    printf("Sending %d packets (%d bytes)...\n", numPackets, fileSize);
 
-    // Send packet with file size
-    char numPacketsText[10];
-    sprintf(numPacketsText, "%d", numPackets);
-    unsigned int packetsTextLen = strlen(numPacketsText);
+/******************************************************************************
+** Function: RADIO_TX_DiscardStaged
+**
+*/
+void RADIO_TX_DiscardStaged(uint8_t Radio)
+{
+   
+   RadioInst[Radio].Stage.Staged = false;
+   
+} /* End RADIO_TX_DiscardStaged() */
 
-    printf("Sending num bytes...");
-    Radio.SendPayload((uint8_t*)numPacketsText, packetsTextLen, {SX128x::RADIO_TICK_SIZE_1000_US, 1000});
-    usleep((pkt_ToA + 20) * 1000);
 
-    // Send all packets
-    uint8_t buf[PACKET_SIZE];
-    unsigned int index = 0;
-    unsigned int totalPackets = 0;
+/******************************************************************************
+** Function: RADIO_TX_BatchBegin
+**
+** Open a batch so subsequent batchable commands are queued
+**
+** Notes:
+**   1. No effect when batching is disabled or a batch is already open.
+**
+*/
+void RADIO_TX_BatchBegin(uint8_t Radio)
+{
+   
+   RadioInst_t *Inst = &RadioInst[Radio];
+   
+   if (Inst->Batch.SpiFd >= 0 && !Inst->Batch.Open)
+   {
+      Inst->Batch.Open   = true;
+      Inst->Batch.OpCnt  = 0;
+      Inst->Batch.BufLen = 0;
+   }
+   
+} /* End RADIO_TX_BatchBegin() */
 
-    while (fileToSend) {
-        char c = fileToSend.get();
-        buf[index] = c;
-        index++;
 
-        if (index >= PACKET_SIZE) {
-            // Reset index and send package 
-            index = 0;
-            Radio.SendPayload(buf, PACKET_SIZE, {SX128x::RADIO_TICK_SIZE_1000_US, 1000});
-            printf("Sening packet %d...", totalPackets);
+/******************************************************************************
+** Function: RADIO_TX_BatchSubmit
+**
+** Send the queued commands in a single SPI_IOC_MESSAGE() ioctl and close
+** the batch
+**
+** Notes:
+**   1. The chip only needs BUSY low before a command, so the driver's BUSY
+**      wait is made once before the first transfer. Later commands are
+**      preceded by an explicit BUSY gap instead of relying on the spidev
+**      cs_change delay. Batches are also submitted while a packet is on the
+**      air, e.g. a staged buffer write, so the chip isn't assumed to be in
+**      STDBY.
+**   2. Returns true when there is nothing to submit.
+**
+*/
+bool RADIO_TX_BatchSubmit(uint8_t Radio)
+{
+   
+   RadioInst_t *Inst = &RadioInst[Radio];
+   bool RetStatus = true;
+   
+   if (Inst->Batch.Open)
+   {
+      
+      Inst->Batch.Open = false;
+      
+      if (Inst->Batch.OpCnt > 0)
+      {
+         Inst->Batch.Xfer[Inst->Batch.OpCnt-1].cs_change = 0;
+         Inst->Radio->HalWaitOnBusy();
+         RetStatus = (ioctl(Inst->Batch.SpiFd, SPI_IOC_MESSAGE(Inst->Batch.OpCnt), Inst->Batch.Xfer) >= 0);
+         Inst->Batch.OpCnt  = 0;
+         Inst->Batch.BufLen = 0;
+      }
+   
+   }
+   
+   return RetStatus;
+   
+} /* End RADIO_TX_BatchSubmit() */
+
 
-            printf("\n\n\nPACKET %d:\n", totalPackets);
-            for (int i = 0; i < PACKET_SIZE; i++) {
-                printf("%c", buf[i]);
-            }
-            printf("\n"); 
+/******************************************************************************
+** Function: RADIO_TX_GetShadow
+**
+*/
+const RADIO_TX_Shadow_t *RADIO_TX_GetShadow(uint8_t Radio)
+{
+   
+   return &RadioInst[Radio].Shadow;
+   
+} /* End RADIO_TX_GetShadow() */
+
+
+/******************************************************************************
+** Function: RADIO_TX_GpioEventsActive
+**
+*/
+bool RADIO_TX_GpioEventsActive(uint8_t Radio)
+{
+   
+   return (RadioInst[Radio].Gpio.BusyFd >= 0);
+   
+} /* End RADIO_TX_GpioEventsActive() */
 
-            usleep((pkt_ToA + 20) * 1000);
-            totalPackets++;
-        }
-    }
 
-    // Send partial last packet
-    Radio.SendPayload(buf, index, {SX128x::RADIO_TICK_SIZE_1000_US, 1000});
-    printf("Sent packet %d (partial last packet)...", totalPackets);
-    usleep((pkt_ToA + 20) * 1000);
+/******************************************************************************
+** Function: RADIO_TX_WarmStarted
+**
+*/
+bool RADIO_TX_WarmStarted(uint8_t Radio)
+{
+   
+   return RadioInst[Radio].WarmStarted;
+   
+} /* End RADIO_TX_WarmStarted() */
 
-    printf("\n\n\nPACKET %d:\n", totalPackets);
-    for (int i = 0; i < PACKET_SIZE; i++) {
-        printf("%c", buf[i]);
-    }
 
+/******************************************************************************
+** Function: RADIO_TX_SpiCeGpio
+**
+*/
+int RADIO_TX_SpiCeGpio(const char *SpiDevStr)
+{
+   
+   static const int8_t CeGpio[2][3] = { {8, 7, -1}, {18, 17, 16} };
+   unsigned int Bus, Cs;
+   
+   if (SpiDevStr == NULL || sscanf(SpiDevStr, "/dev/spidev%u.%u", &Bus, &Cs) != 2 || Bus > 1 || Cs > 2)
+   {
+      return -1;
+   }
+   
+   return CeGpio[Bus][Cs];
+   
+} /* End RADIO_TX_SpiCeGpio() */
 
-    fileToSend.close();
 
-    printf("Exiting...\n");
-    Radio.StopIrqHandler();
-    return EXIT_SUCCESS;
-}
-**********/
+/******************************************************************************
+** Function: SX128x_LinuxEvt::HalWaitOnBusy
+**
+** Wait for the radio's BUSY line to go low
+**
+** Notes:
+**   1. Most commands keep BUSY high for a few microseconds so the wait
+**      spins for GPIO_SPIN_NS before blocking. A blocking wait costs a
+**      context switch which is longer than these short BUSY periods.
+**   2. Queued edges are drained before the level is read so an edge that
+**      occurs after the read wakes the poll().
+**
+*/
+void SX128x_LinuxEvt::HalWaitOnBusy()
+{
+   
+   struct timespec Start;
+   struct timespec Now;
+   struct pollfd   PollFd;
+   
+   if (BusyFd < 0)
+   {
+      SX128x_Linux::HalWaitOnBusy();
+      return;
+   }
+   
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+   do
+   {
+      if (!GpioLineValue(BusyFd))
+      {
+         return;
+      }
+      clock_gettime(CLOCK_MONOTONIC, &Now);
+   } while (((Now.tv_sec - Start.tv_sec) * 1000000000L + (Now.tv_nsec - Start.tv_nsec)) < GPIO_SPIN_NS);
+   
+   PollFd.fd     = BusyFd;
+   PollFd.events = POLLIN;
+   for (;;)
+   {
+      GpioDrainEvents(BusyFd);
+      if (!GpioLineValue(BusyFd))
+      {
+         break;
+      }
+      poll(&PollFd, 1, GPIO_BUSY_POLL_MS);
+   }
+   
+} /* End SX128x_LinuxEvt::HalWaitOnBusy() */
+
+
+/******************************************************************************
+** Function: GpioIrqTask
+**
+** Replaces the driver's polled IRQ handler when DIO1 line events are used
+**
+** Notes:
+**   1. Runs in its own thread like the driver's handler so the callbacks
+**      have the same context.
+**   2. DIO1 stays high until the IRQ is cleared so the level is checked
+**      before blocking in case the edge preceded the drain.
+**
+*/
+static void GpioIrqTask(RadioInst_t *Inst)
+{
+   
+   struct pollfd PollFd;
+   
+   PollFd.fd     = Inst->Gpio.Dio1Fd;
+   PollFd.events = POLLIN;
+   
+   while (Inst->Gpio.IrqRun)
+   {
+      GpioDrainEvents(Inst->Gpio.Dio1Fd);
+      if (GpioLineValue(Inst->Gpio.Dio1Fd))
+      {
+         Inst->Radio->ProcessIrqs();
+      }
+      else
+      {
+         poll(&PollFd, 1, GPIO_IRQ_POLL_MS);
+      }
+   }
+   
+} /* End GpioIrqTask() */
+
+
+/******************************************************************************
+** Function: GpioLineEvent
+**
+** Request a GPIO line's edge events and return the line's file descriptor
+**
+** Notes:
+**   1. The descriptor is non-blocking so queued events can be drained.
+**   2. Returns -1 if the line can't be requested, e.g. it's in use.
+**
+*/
+static int GpioLineEvent(int ChipFd, uint8_t Line, uint32_t EventFlags)
+{
+   
+   struct gpioevent_request Req;
+   
+   memset(&Req, 0, sizeof(Req));
+   Req.lineoffset  = Line;
+   Req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+   Req.eventflags  = EventFlags;
+   strncpy(Req.consumer_label, "lora_tx", sizeof(Req.consumer_label) - 1);
+   
+   if (ioctl(ChipFd, GPIO_GET_LINEEVENT_IOCTL, &Req) < 0)
+   {
+      return -1;
+   }
+   fcntl(Req.fd, F_SETFL, fcntl(Req.fd, F_GETFL) | O_NONBLOCK);
+   
+   return Req.fd;
+   
+} /* End GpioLineEvent() */
+
+
+/******************************************************************************
+** Function: GpioLineValue
+**
+*/
+static bool GpioLineValue(int LineFd)
+{
+   
+   struct gpiohandle_data Data;
+   
+   Data.values[0] = 0;
+   ioctl(LineFd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &Data);
+   
+   return (Data.values[0] != 0);
+   
+} /* End GpioLineValue() */
+
+
+/******************************************************************************
+** Function: GpioDrainEvents
+**
+*/
+static void GpioDrainEvents(int LineFd)
+{
+   
+   struct gpioevent_data Event;
+   
+   while (read(LineFd, &Event, sizeof(Event)) == sizeof(Event));
+   
+} /* End GpioDrainEvents() */
+
+
+/******************************************************************************
+** Function: DriverClose
+**
+** Stop and delete the radio's driver and release its GPIO lines
+**
+** Notes:
+**   1. Both IRQ handlers call into the driver so they're stopped before
+**      it's deleted.
+**
+*/
+static void DriverClose(RadioInst_t *Inst)
+{
+   
+   if (Inst->DriverIrq)
+   {
+      Inst->Radio->StopIrqHandler();
+      Inst->DriverIrq = false;
+   }
+   GpioClose(Inst);
+   
+   delete Inst->Radio;
+   Inst->Radio = NULL;
+   
+} /* End DriverClose() */
+
+
+/******************************************************************************
+** Function: GpioClose
+**
+** Stop the IRQ thread and release the GPIO lines
+**
+*/
+static void GpioClose(RadioInst_t *Inst)
+{
+   
+   if (Inst->Gpio.IrqThread.joinable())
+   {
+      Inst->Gpio.IrqRun = false;
+      Inst->Gpio.IrqThread.join();
+   }
+   if (Inst->Gpio.BusyFd >= 0)
+   {
+      close(Inst->Gpio.BusyFd);
+      Inst->Gpio.BusyFd = -1;
+   }
+   if (Inst->Gpio.Dio1Fd >= 0)
+   {
+      close(Inst->Gpio.Dio1Fd);
+      Inst->Gpio.Dio1Fd = -1;
+   }
+   
+} /* End GpioClose() */
+
+
+/******************************************************************************
+** Function: InitSim
+**
+** Initialize the simulated backend
+**
+** Notes:
+**   1. Mirrors the driver's configuration sequence. The simulator starts
+**      with the driver's packet configuration so only the modulation,
+**      frequency and payload length are sent.
+**
+*/
+static bool InitSim(RadioInst_t *Inst, const RADIO_TX_Config_t *RadioConfig)
+{
+   
+   RADIO_SIM_Config_t SimConfig;
+   
+   SimConfig.Radio      = Inst->Id;
+   SimConfig.BusyUs     = RadioConfig->SimBusyUs;
+   SimConfig.LossPct    = RadioConfig->SimLossPct;
+   SimConfig.Seed       = 1;
+   SimConfig.OutputPath = RadioConfig->SimOutput;
+   
+   Inst->SimBackend = RADIO_SIM_Constructor(&Inst->RadioSim, &SimConfig, SimTxDone);
+   
+   if (Inst->SimBackend)
+   {
+      
+      Inst->PacketParams.PacketType = SX128x::PACKET_TYPE_LORA;
+      Inst->PacketParams.Params.LoRa.PreambleLength = RADIO_TX_PREAMBLE_LEN;
+      Inst->PacketParams.Params.LoRa.HeaderType     = SX128x::LORA_PACKET_VARIABLE_LENGTH;
+      Inst->PacketParams.Params.LoRa.PayloadLength  = RADIO_TX_MAX_PAYLOAD_LEN;
+      Inst->PacketParams.Params.LoRa.Crc            = SX128x::LORA_CRC_ON;
+      Inst->PacketParams.Params.LoRa.InvertIQ       = SX128x::LORA_IQ_NORMAL;
+      
+      Inst->Shadow.SpiSpeed    = RadioConfig->SpiSpeed;
+      Inst->Shadow.TxPower     = 0;
+      Inst->Shadow.TxRampTime  = SX128x::RADIO_RAMP_20_US;
+      Inst->Shadow.PreambleLen = Inst->PacketParams.Params.LoRa.PreambleLength;
+      Inst->Shadow.HeaderType  = Inst->PacketParams.Params.LoRa.HeaderType;
+      Inst->Shadow.Crc         = Inst->PacketParams.Params.LoRa.Crc;
+      Inst->Shadow.InvertIQ    = Inst->PacketParams.Params.LoRa.InvertIQ;
+      
+      RADIO_TX_SetLoraParams(Inst->Id, RadioConfig->SpreadingFactor,
+                             RadioConfig->Bandwidth,
+                             RadioConfig->CodingRate);
+      RADIO_SIM_SetPayloadLen(&Inst->RadioSim, RADIO_TX_MAX_PAYLOAD_LEN);
+      Inst->Shadow.PayloadLen = RADIO_TX_MAX_PAYLOAD_LEN;
+      RADIO_TX_SetRadioFrequency(Inst->Id, RadioConfig->Frequency);
+      
+      Inst->Shadow.Valid = true;
+   }
+   
+   return Inst->SimBackend;
+   
+} /* End InitSim() */
+
+
+/******************************************************************************
+** Function: SimTxDone
+**
+*/
+static void SimTxDone(uint8_t Radio, bool TxTimeout)
+{
+   
+   if (TxDoneFunc != NULL) TxDoneFunc(Radio, TxTimeout);
+   
+} /* End SimTxDone() */
+
+
+/******************************************************************************
+** Function: ShadowSkip
+**
+** Return true if a shadowed write can be skipped and count the outcome
+**
+** Notes:
+**   1. Nothing is skipped until the radio has been initialized because the
+**      shadow doesn't describe the chip before then.
+**
+*/
+static bool ShadowSkip(RadioInst_t *Inst, bool Same)
+{
+   
+   if (Inst->Shadow.Valid && Same)
+   {
+      Inst->Shadow.SkipCnt++;
+      return true;
+   }
+   
+   Inst->Shadow.WriteCnt++;
+   return false;
+   
+} /* End ShadowSkip() */
+
+
+/******************************************************************************
+** Function: RadioConfigured
+**
+** Return true if the radio's registers show it's already configured with
+** RadioConfig's modulation
+**
+** Notes:
+**   1. A reset leaves the chip in GFSK so a LoRa packet type means the
+**      chip level settings have been written since its last reset. The
+**      spreading factor register is written by SetModulationParams() so it
+**      must match the configuration that will be programmed.
+**   2. The chip must be idle in STDBY. A radio that is transmitting or in
+**      another mode is reset. An absent chip reads as all zeros or ones
+**      and fails the mode check.
+**
+*/
+static bool RadioConfigured(RadioInst_t *Inst, const RADIO_TX_Config_t *RadioConfig)
+{
+   
+   SX128x::RadioStatus_t Status = Inst->Radio->GetStatus();
+   
+   if (Status.Fields.ChipMode != CHIP_MODE_STDBY_RC && Status.Fields.ChipMode != CHIP_MODE_STDBY_XOSC)
+   {
+      return false;
+   }
+   
+   return (Inst->Radio->GetPacketType() == SX128x::PACKET_TYPE_LORA &&
+           Inst->Radio->ReadRegister(REG_SF_CONFIG) == SfConfigReg(RadioConfig->SpreadingFactor));
+   
+} /* End RadioConfigured() */
+
+
+/******************************************************************************
+** Function: SfConfigReg
+**
+** Return the spreading factor dependent register value written with the
+** modulation parameters
+**
+*/
+static uint8_t SfConfigReg(uint8_t SpreadingFactor)
+{
+   
+   uint8_t RegValue;
+   
+   if (SpreadingFactor <= 0x60)
+   {
+      RegValue = 0x1E;
+   }
+   else if (SpreadingFactor <= 0x80)
+   {
+      RegValue = 0x37;
+   }
+   else
+   {
+      RegValue = 0x32;
+   }
+   
+   return RegValue;
+   
+} /* End SfConfigReg() */
+
+
+/******************************************************************************
+** Function: BatchOpenSpi
+**
+** Open the spidev device used for batched transfers
+**
+** Notes:
+**   1. Batched transfers use the spidev hardware chip select so the radio's
+**      NSS must be wired to the device's CE line.
+**
+*/
+static bool BatchOpenSpi(RadioInst_t *Inst, const char *SpiDevStr, uint32_t SpiSpeed)
+{
+   
+   uint8_t Mode = SPI_MODE_0;
+   uint8_t Bits = 8;
+   
+   Inst->Batch.SpiFd = open(SpiDevStr, O_RDWR);
+   if (Inst->Batch.SpiFd >= 0)
+   {
+      if (ioctl(Inst->Batch.SpiFd, SPI_IOC_WR_MODE, &Mode) < 0 ||
+          ioctl(Inst->Batch.SpiFd, SPI_IOC_WR_BITS_PER_WORD, &Bits) < 0)
+      {
+         close(Inst->Batch.SpiFd);
+         Inst->Batch.SpiFd = -1;
+      }
+   }
+   Inst->Batch.SpiSpeed = SpiSpeed;
+   
+   return (Inst->Batch.SpiFd >= 0);
+   
+} /* End BatchOpenSpi() */
+
+
+/******************************************************************************
+** Function: BatchAdd
+**
+** Queue a command in the open batch
+**
+** Notes:
+**   1. Returns false when no batch is open so the caller issues the command
+**      through the driver.
+**   2. A full batch is submitted and a new one opened so a command is never
+**      dropped.
+**   3. Data is sent from the caller's buffer as a second transfer. The
+**      opcode's transfer clears cs_change so NSS stays asserted and
+**      WriteBuffer's offset and payload form one SPI frame. Data must stay
+**      valid until the batch is submitted.
+**   4. A command after the first is preceded by a zero length transfer
+**      with a BATCH_BUSY_US delay. The previous command's frame has ended
+**      so the chip is processing it, and the spidev uapi can't lengthen
+**      the NSS high time, so the next command isn't clocked until the
+**      delay expires.
+**
+*/
+static bool BatchAdd(RadioInst_t *Inst, uint8_t Opcode, const uint8_t *Arg, uint16_t ArgLen,
+                     const uint8_t *Data, uint16_t DataLen)
+{
+   
+   uint16_t Len    = 1 + ArgLen;
+   uint8_t  XferCnt = (DataLen > 0) ? 3 : 2;
+   struct spi_ioc_transfer *Xfer;
+   
+   if (!Inst->Batch.Open)
+   {
+      return false;
+   }
+   
+   if ((Inst->Batch.OpCnt + XferCnt) > BATCH_MAX_OPS || (Inst->Batch.BufLen + Len) > BATCH_BUF_LEN)
+   {
+      RADIO_TX_BatchSubmit(Inst->Id);
+      RADIO_TX_BatchBegin(Inst->Id);
+   }
+   
+   if (Inst->Batch.OpCnt > 0)
+   {
+      Xfer = &Inst->Batch.Xfer[Inst->Batch.OpCnt++];
+      memset(Xfer, 0, sizeof(struct spi_ioc_transfer));
+      Xfer->speed_hz      = Inst->Batch.SpiSpeed;
+      Xfer->bits_per_word = 8;
+      Xfer->delay_usecs   = BATCH_BUSY_US;
+   }
+   
+   Inst->Batch.Buf[Inst->Batch.BufLen] = Opcode;
+   memcpy(&Inst->Batch.Buf[Inst->Batch.BufLen + 1], Arg, ArgLen);
+   
+   Xfer = &Inst->Batch.Xfer[Inst->Batch.OpCnt++];
+   memset(Xfer, 0, sizeof(struct spi_ioc_transfer));
+   Xfer->tx_buf        = (unsigned long)&Inst->Batch.Buf[Inst->Batch.BufLen];
+   Xfer->len           = Len;
+   Xfer->speed_hz      = Inst->Batch.SpiSpeed;
+   Xfer->bits_per_word = 8;
+   Xfer->cs_change     = (DataLen > 0) ? 0 : 1;
+   
+   if (DataLen > 0)
+   {
+      Xfer = &Inst->Batch.Xfer[Inst->Batch.OpCnt++];
+      memset(Xfer, 0, sizeof(struct spi_ioc_transfer));
+      Xfer->tx_buf        = (unsigned long)Data;
+      Xfer->len           = DataLen;
+      Xfer->speed_hz      = Inst->Batch.SpiSpeed;
+      Xfer->bits_per_word = 8;
+      Xfer->cs_change     = 1;
+   }
+   
+   Inst->Batch.BufLen += Len;
+   
+   return true;
+   
+} /* End BatchAdd() */
+
+
+/******************************************************************************
+** Function: ImageAddOp
+**
+** Append a command to a compiled profile
+**
+*/
+static void ImageAddOp(RADIO_TX_Image_t *Image, uint8_t Opcode, const uint8_t *Arg, uint8_t ArgLen)
+{
+   
+   Image->Buf[Image->BufLen] = Opcode;
+   memcpy(&Image->Buf[Image->BufLen + 1], Arg, ArgLen);
+   Image->OpLen[Image->OpCnt++] = (uint8_t)(1 + ArgLen);
+   Image->BufLen += (uint8_t)(1 + ArgLen);
+   
+} /* End ImageAddOp() */
+
+
+/* Pete's initial command list
+#define GPIO_CTRL_SET_FREQ_EID     (GPIO_CTRL_BASE_EID + 4)
+#define GPIO_CTRL_SET_TCXOEN_EID   (GPIO_CTRL_BASE_EID + 5)
+#define GPIO_CTRL_SET_HSM_EID      (GPIO_CTRL_BASE_EID + 6)
+#define GPIO_CTRL_SET_POWER_EID    (GPIO_CTRL_BASE_EID + 7)
+#define GPIO_CTRL_SET_MOD_EID      (GPIO_CTRL_BASE_EID + 8)
+#define GPIO_CTRL_SET_BW_EID       (GPIO_CTRL_BASE_EID + 9)
+#define GPIO_CTRL_SET_SF_EID       (GPIO_CTRL_BASE_EID + 10)
+#define GPIO_CTRL_SET_CR_EID       (GPIO_CTRL_BASE_EID + 11)
+#define GPIO_CTRL_SET_CRC_EID      (GPIO_CTRL_BASE_EID + 12)
+#define GPIO_CTRL_SET_LDRO_EID     (GPIO_CTRL_BASE_EID + 13)
+#define GPIO_CTRL_SET_NODE_EID     (GPIO_CTRL_BASE_EID + 14)
+#define GPIO_CTRL_SET_DEST_EID     (GPIO_CTRL_BASE_EID + 15)
+#define GPIO_CTRL_SET_TXPA_EID     (GPIO_CTRL_BASE_EID + 14)
+#define GPIO_CTRL_SET_RXLNA_EID    (GPIO_CTRL_BASE_EID + 15)
+*/
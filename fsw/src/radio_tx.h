@@ -18,7 +18,11 @@
 **  Notes:
 **    1. Serves as a bridge between the C++ Radio object and the
 **       Loral Tx app. This header shouldn't include cFS or Lora_Tx app
-**       C header files.
+**       C header files other than the platform configuration.
+**    2. Each radio is an independent instance with its own driver, SPI
+**       device, pins, shadow and IRQ thread. Every function's Radio
+**       argument selects the instance, 0..RADIO_TX_MAX_RADIOS-1. An
+**       instance must only be written to by one task at a time.
 **
 */
 
@@ -29,11 +33,25 @@
 ** Includes
 */
 #include <stdint.h>
+#include "lora_tx_platform_cfg.h"
 
 /***********************/
 /** Macro Definitions **/
 /***********************/
 
+#define RADIO_TX_MAX_RADIOS       LORA_TX_MAX_RADIOS
+#define RADIO_TX_MAX_PAYLOAD_LEN  255   /* SX128x LoRa variable length packet limit */
+#define RADIO_TX_PREAMBLE_LEN     12    /* LoRa preamble symbols */
+
+#define RADIO_TX_TIMEOUT_MARGIN   50     /* ms, added to a packet's time on air for the radio's TX timeout */
+#define RADIO_TX_TIMEOUT_MAX      65535  /* ms, longest TX timeout with 1 ms ticks */
+
+#define RADIO_TX_BACKEND_SX128X   0     /* SX128x driver */
+#define RADIO_TX_BACKEND_SIM      1     /* Simulated radio, see radio_sim.h */
+
+#define RADIO_TX_IMAGE_MAX_OPS    5     /* Commands in a compiled profile */
+#define RADIO_TX_IMAGE_BUF_LEN    32    /* Opcodes and arguments of a compiled profile */
+
 
 /**********************/
 /** Type Definitions **/
@@ -54,6 +72,108 @@ typedef struct
 } RADIO_TX_Pin_t;
 
 
+typedef struct
+{
+   uint32_t SpiSpeed;
+   uint32_t Frequency;         /* Hz */
+   uint8_t  SpreadingFactor;
+   uint8_t  Bandwidth;
+   uint8_t  CodingRate;
+   bool     SpiBatch;          /* Batch commands into one ioctl, requires NSS on the spidev CE line, see RADIO_TX_SpiCeGpio() */
+   const char *GpioChip;       /* GPIO character device for BUSY/DIO1 line events, NULL polls */
+   uint8_t  Backend;           /* RADIO_TX_BACKEND_x */
+   uint32_t SimBusyUs;         /* Simulated backend BUSY time per command */
+   uint8_t  SimLossPct;        /* Simulated backend frame loss */
+   const char *SimOutput;      /* Simulated backend frame output, NULL or "" disables */
+   bool     WarmStart;         /* Keep a radio that is already configured instead of resetting it */
+      
+} RADIO_TX_Config_t;
+
+
+/*
+** Shadow copy of the settings programmed into the radio. It's only written
+** by the functions in this file after the chip accepts a command so it is
+** the radio's 'truth'. Writes that wouldn't change a shadowed setting aren't
+** sent to the chip.
+*/
+typedef struct
+{
+   bool     Valid;             /* False until the radio is initialized */
+   uint32_t SpiSpeed;
+   uint32_t FreqReg;           /* SetRfFrequency register value */
+   uint32_t Frequency;         /* Hz, derived from FreqReg */
+   uint8_t  SpreadingFactor;
+   uint8_t  Bandwidth;
+   uint8_t  CodingRate;
+   uint8_t  PreambleLen;
+   uint8_t  HeaderType;
+   uint8_t  PayloadLen;
+   uint8_t  Crc;
+   uint8_t  InvertIQ;
+   uint8_t  TxBaseAddr;
+   int8_t   TxPower;           /* dBm offset, see SX128x SetTxParams */
+   uint8_t  TxRampTime;
+   uint32_t WriteCnt;          /* Shadowed settings written to the chip */
+   uint32_t SkipCnt;           /* Redundant shadowed writes suppressed */
+   
+} RADIO_TX_Shadow_t;
+
+
+/*
+** Radio operating point. Modulation parameters are SX128x register codes.
+** The preamble must be encodable as mantissa*2^exponent with a mantissa of
+** 1..15. A zero frequency leaves each radio's frequency unchanged. The
+** header is always explicit with CRC on because the time on air model and
+** the receiver depend on them.
+*/
+typedef struct
+{
+   uint8_t  SpreadingFactor;
+   uint8_t  Bandwidth;
+   uint8_t  CodingRate;
+   uint16_t PreambleLen;       /* Symbols */
+   bool     InvertIQ;
+   uint32_t Frequency;         /* Hz, 0 keeps the current frequency */
+   int8_t   TxPower;           /* dBm, -18..13 */
+   uint16_t TxRampUs;          /* 2, 4, 6, 8, 10, 12, 16 or 20 */
+   
+} RADIO_TX_Profile_t;
+
+
+/*
+** A profile compiled into the exact command bytes that program it. Buf holds
+** OpCnt commands back to back, each an opcode followed by its arguments, so
+** applying a profile is a copy into one batch. The decoded settings update
+** the shadow and drive the simulated backend.
+*/
+typedef struct
+{
+   uint8_t  SpreadingFactor;
+   uint8_t  Bandwidth;
+   uint8_t  CodingRate;
+   uint8_t  PreambleLen;       /* SetPacketParams encoding */
+   uint8_t  InvertIQ;
+   uint32_t FreqReg;           /* 0 when the profile doesn't set the frequency */
+   int8_t   TxPower;
+   uint8_t  TxRampTime;
+   uint16_t PreambleSym;       /* Symbols, for the time on air model */
+   uint8_t  PayloadLenIdx;     /* Buf index of SetPacketParams' payload length */
+   uint8_t  OpCnt;
+   uint8_t  OpLen[RADIO_TX_IMAGE_MAX_OPS];
+   uint8_t  BufLen;
+   uint8_t  Buf[RADIO_TX_IMAGE_BUF_LEN];
+   
+} RADIO_TX_Image_t;
+
+
+/*
+** Called from the radio driver's IRQ handler thread when a transmission
+** completes (TxTimeout false) or the radio's TX timeout expires (TxTimeout
+** true). Radio identifies the instance. The function must not block.
+*/
+typedef void (*RADIO_TX_TxDoneFunc_t)(uint8_t Radio, bool TxTimeout);
+
+
 /************************/
 /** Exported Functions **/
 /************************/
@@ -66,9 +186,97 @@ typedef struct
 **
 ** Notes:
 **   1. This must be called prior to any other function.
+**   2. Performs the full chip configuration sequence (standby, regulator,
+**      LNA, buffer base, packet type, modulation, packet and frequency) so
+**      the radio is ready to transmit when this returns true.
+**   3. Returns false if Radio isn't a valid instance.
+**   4. With WarmStart set, a radio whose status, packet type and spreading
+**      factor registers show it's already configured with RadioConfig
+**      isn't reset. Only the settings that can't be read back are written.
+**   5. Returns false when SpiBatch is set and RadioPin->Nss isn't the SPI
+**      device's hardware chip select, see RADIO_TX_SpiCeGpio().
+**
+*/
+bool RADIO_TX_InitRadio(uint8_t Radio, const char *SpiDevStr, uint8_t SpiDevNum, 
+                        const RADIO_TX_Pin_t *RadioPin,
+                        const RADIO_TX_Config_t *RadioConfig);
+
+
+/******************************************************************************
+** Function: RADIO_TX_SetTxDoneCallback
+**
+** Register the function that is called when a transmission completes
+**
+** Notes:
+**   1. Must be called prior to RADIO_TX_InitRadio() because the driver's
+**      callbacks and IRQ handler are installed during initialization.
+**   2. One function serves every radio. Its Radio argument identifies the
+**      radio that completed the transmission.
+**
+*/
+void RADIO_TX_SetTxDoneCallback(RADIO_TX_TxDoneFunc_t TxDoneFunc);
+
+
+/******************************************************************************
+** Function: RADIO_TX_SendPayload
+**
+** Load a payload into the radio's data buffer and start the transmission
+**
+** Notes:
+**   1. Returns as soon as the transmission has started. The TxDone callback
+**      is invoked when the packet is off the air and the next payload can be
+**      sent.
+**   2. The packet parameters are only rewritten when the payload length
+**      differs from the previous payload.
+**   3. Submits any open batch. With batching, the packet parameters and the
+**      buffer write are part of that batch.
+**   4. Discards a staged payload.
+**   5. TimeOnAir (us) sets the radio's TX timeout, see RADIO_TX_SendStaged().
+**
+*/
+bool RADIO_TX_SendPayload(uint8_t Radio, const uint8_t *Payload, uint8_t PayloadLen, uint32_t TimeOnAir);
+
+
+/******************************************************************************
+** Function: RADIO_TX_StagePayload
+**
+** Write the next payload to the radio's data buffer while the current
+** packet is on the air
+**
+** Notes:
+**   1. The payload is written after the packet on the air. Returns false
+**      without writing when a payload is already staged or the two packets
+**      don't fit in the radio's 256 byte buffer, e.g. two 255 byte blocks.
+**      The payload must then be sent with RADIO_TX_SendPayload() after
+**      TxDone.
+**
+*/
+bool RADIO_TX_StagePayload(uint8_t Radio, const uint8_t *Payload, uint8_t PayloadLen);
+
+
+/******************************************************************************
+** Function: RADIO_TX_SendStaged
+**
+** Start transmitting the staged payload after the previous TxDone
+**
+** Notes:
+**   1. Only flips the TX base address, updates the packet length if it
+**      changed and issues SetTx.
+**   2. The radio's TX timeout is the packet's time on air (us) plus
+**      RADIO_TX_TIMEOUT_MARGIN, limited to RADIO_TX_TIMEOUT_MAX. The
+**      simulated radio doesn't model the timeout.
 **
 */
-bool RADIO_TX_InitRadio(const char *SpiDevStr, uint8_t SpiDevNum, const RADIO_TX_Pin_t *RadioPin);
+bool RADIO_TX_SendStaged(uint8_t Radio, uint32_t TimeOnAir);
+
+
+/******************************************************************************
+** Function: RADIO_TX_DiscardStaged
+**
+** Discard a staged payload that won't be sent
+**
+*/
+void RADIO_TX_DiscardStaged(uint8_t Radio);
 
 
 /******************************************************************************
@@ -77,10 +285,10 @@ bool RADIO_TX_InitRadio(const char *SpiDevStr, uint8_t SpiDevNum, const RADIO_TX
 ** Set the radio Lora parameters
 **
 ** Notes:
-**   None
+**   1. Not written to the chip when the parameters are already programmed.
 **
 */
-bool RADIO_TX_SetLoraParams(uint8_t SpreadingFactor,
+bool RADIO_TX_SetLoraParams(uint8_t Radio, uint8_t SpreadingFactor,
                             uint8_t Bandwidth,
                             uint8_t CodingRate);
 
@@ -91,10 +299,82 @@ bool RADIO_TX_SetLoraParams(uint8_t SpreadingFactor,
 ** Set the radio frequency (Hz)
 **
 ** Notes:
-**   None
+**   1. Converted to the RF frequency register value and sent through
+**      RADIO_TX_SetRfFrequencyReg() so both share the shadow.
 **
 */
-bool RADIO_TX_SetRadioFrequency(uint32_t Frequency);
+bool RADIO_TX_SetRadioFrequency(uint8_t Radio, uint32_t Frequency);
+
+
+/******************************************************************************
+** Function: RADIO_TX_SetRfFrequencyReg
+**
+** Set the radio frequency using a precomputed RF frequency register value
+**
+** Notes:
+**   1. Writes the SetRfFrequency command's three byte argument directly so
+**      a frequency hop doesn't convert the frequency between packets.
+**   2. Queued when a batch is open.
+**
+*/
+bool RADIO_TX_SetRfFrequencyReg(uint8_t Radio, uint32_t FreqReg);
+
+
+/******************************************************************************
+** Function: RADIO_TX_CompileProfile
+**
+** Compile a profile into the commands that program it
+**
+** Notes:
+**   1. Returns false if the TX power, ramp time or preamble length can't be
+**      programmed. The caller validates the modulation parameters and the
+**      frequency range.
+**   2. Doesn't access a radio so profiles can be compiled when a table is
+**      loaded.
+**
+*/
+bool RADIO_TX_CompileProfile(const RADIO_TX_Profile_t *Profile, RADIO_TX_Image_t *Image);
+
+
+/******************************************************************************
+** Function: RADIO_TX_ApplyImage
+**
+** Program a compiled profile in a single batch
+**
+** Notes:
+**   1. Not written to the chip when every setting is already programmed.
+**   2. The packet parameters keep the current payload length so the next
+**      packet doesn't need another SetPacketParams.
+**
+*/
+bool RADIO_TX_ApplyImage(uint8_t Radio, const RADIO_TX_Image_t *Image);
+
+
+/******************************************************************************
+** Function: RADIO_TX_BatchBegin
+**
+** Open a batch so batchable commands are queued instead of sent
+**
+** Notes:
+**   1. Has no effect unless the radio was initialized with SpiBatch set.
+**      Without batching every command goes through the driver as before.
+**   2. Functions that aren't batchable submit the open batch before sending
+**      their command so the command order is preserved.
+**
+*/
+void RADIO_TX_BatchBegin(uint8_t Radio);
+
+
+/******************************************************************************
+** Function: RADIO_TX_BatchSubmit
+**
+** Send the queued commands in a single SPI_IOC_MESSAGE() ioctl
+**
+** Notes:
+**   1. Returns false if the ioctl fails.
+**
+*/
+bool RADIO_TX_BatchSubmit(uint8_t Radio);
 
 
 /******************************************************************************
@@ -106,7 +386,64 @@ bool RADIO_TX_SetRadioFrequency(uint32_t Frequency);
 **   None
 **
 */
-bool RADIO_TX_SetSpiSpeed(uint32_t SpiSpeed);
+bool RADIO_TX_SetSpiSpeed(uint8_t Radio, uint32_t SpiSpeed);
+
+
+/******************************************************************************
+** Function: RADIO_TX_GpioEventsActive
+**
+** Return true if BUSY and DIO1 waits block on GPIO line events
+**
+** Notes:
+**   1. False when GpioChip wasn't configured or the lines couldn't be
+**      requested and the driver polls them.
+**
+*/
+bool RADIO_TX_GpioEventsActive(uint8_t Radio);
+
+
+/******************************************************************************
+** Function: RADIO_TX_SpiCeGpio
+**
+** Return the GPIO of a spidev device's hardware chip select or -1 if it's
+** unknown
+**
+** Notes:
+**   1. Batched transfers are framed by the spidev chip select so the
+**      radio's NSS must be wired to it. The driver's NSS GPIO is only
+**      toggled for unbatched commands.
+**   2. Uses the Raspberry Pi SPI0 (CE0 GPIO 8, CE1 GPIO 7) and SPI1 (CE0
+**      GPIO 18, CE1 GPIO 17, CE2 GPIO 16) pinout. SpiDevStr must be
+**      /dev/spidev<bus>.<chip select>.
+**
+*/
+int RADIO_TX_SpiCeGpio(const char *SpiDevStr);
+
+
+/******************************************************************************
+** Function: RADIO_TX_WarmStarted
+**
+** Return true if the last initialization kept the radio's configuration
+**
+** Notes:
+**   1. False when WarmStart wasn't requested or the radio's registers didn't
+**      match the configuration and the radio was reset.
+**
+*/
+bool RADIO_TX_WarmStarted(uint8_t Radio);
+
+
+/******************************************************************************
+** Function: RADIO_TX_GetShadow
+**
+** Return a pointer to the shadow copy of the radio's programmed settings
+**
+** Notes:
+**   1. The shadow is updated by the task that writes to the radio so a
+**      reader in another task may see a setting change between fields.
+**
+*/
+const RADIO_TX_Shadow_t *RADIO_TX_GetShadow(uint8_t Radio);
 
 
 #endif /* _radio_tx_ */
@@ -0,0 +1,639 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the telemetry forwarding class
+**
+**  Notes:
+**    1. See tlm_fwd.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "tlm_fwd.h"
+#include "radio_if.h"
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static TLM_FWD_Class_t *TlmFwd = NULL;
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void SubscribeTopics(const char *TopicIdList);
+static bool ClassSpace(void);
+static void ForwardMsg(const CFE_SB_Buffer_t *SbBufPtr, uint32 Time);
+static uint16 PackMsg(uint8 Class, const CFE_SB_Buffer_t *SbBufPtr, uint16 MsgSize, uint32 Time);
+static void FlushFrame(uint8 Class);
+static void InvalidateStaleApids(void);
+static uint16 MidIndex(const CFE_SB_Buffer_t *SbBufPtr);
+static uint32 GetTimeMs(void);
+
+
+/******************************************************************************
+** Function: TLM_FWD_Constructor
+**
+*/
+void TLM_FWD_Constructor(TLM_FWD_Class_t *TlmFwdPtr, INITBL_Class_t *IniTbl)
+{
+   
+   int32  SysStatus;
+   uint16 HdrRefresh;
+   uint8  Class;
+   
+   TlmFwd = TlmFwdPtr;
+   
+   memset(TlmFwd, 0, sizeof(TLM_FWD_Class_t));
+   
+   TlmFwd->IniTbl   = IniTbl;
+   CFE_MSG_Init(CFE_MSG_PTR(TlmFwd->MidAirtimeTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(TlmFwd->IniTbl, CFG_LORA_TX_MID_AIRTIME_TLM_TOPICID)), sizeof(LORA_TX_MidAirtimeTlm_t));
+   
+   TlmFwd->BatchLim = INITBL_GetIntConfig(TlmFwd->IniTbl, CFG_TLM_FWD_BATCH_LIM);
+   TlmFwd->FlushDeadline = INITBL_GetIntConfig(TlmFwd->IniTbl, CFG_TLM_FWD_FLUSH_MS);
+   
+   HdrRefresh = INITBL_GetIntConfig(TlmFwd->IniTbl, CFG_TLM_FWD_HDR_REFRESH);
+   TlmFwd->HdrCompress = (HdrRefresh > 0);
+   TX_HDRC_Constructor(&TlmFwd->Hdrc, HdrRefresh);
+   
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      TX_FRAME_Constructor(&TlmFwd->Frame[Class], 
+                           TlmFwd->HdrCompress ? TX_FRAME_TYPE_SB_MSG_HC : TX_FRAME_TYPE_SB_MSG,
+                           RADIO_TX_MAX_PAYLOAD_LEN);
+   }
+   
+   SysStatus = CFE_SB_CreatePipe(&TlmFwd->Pipe, 
+                                 INITBL_GetIntConfig(TlmFwd->IniTbl, CFG_TLM_FWD_PIPE_DEPTH),
+                                 INITBL_GetStrConfig(TlmFwd->IniTbl, CFG_TLM_FWD_PIPE_NAME));  
+   if (SysStatus == CFE_SUCCESS)
+   {
+      SubscribeTopics(INITBL_GetStrConfig(TlmFwd->IniTbl, CFG_TLM_FWD_TOPICIDS));
+   }
+   else
+   {
+      CFE_EVS_SendEvent(TLM_FWD_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to create telemetry forwarding pipe %s, status = 0x%08X",
+                        INITBL_GetStrConfig(TlmFwd->IniTbl, CFG_TLM_FWD_PIPE_NAME), SysStatus);
+   }
+
+} /* End TLM_FWD_Constructor() */
+
+
+/******************************************************************************
+** Function: TLM_FWD_ResetStatus
+**
+*/
+void TLM_FWD_ResetStatus(void)
+{
+
+   uint8 Class;
+   
+   TlmFwd->MsgCnt  = 0;
+   TlmFwd->DropCnt = 0;
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      TlmFwd->Frame[Class].FrameCnt = 0;
+      TlmFwd->Frame[Class].MsgTotal = 0;
+   }
+   TlmFwd->Hdrc.FullCnt    = 0;
+   TlmFwd->Hdrc.CompCnt    = 0;
+   TlmFwd->Hdrc.BytesSaved = 0;
+   memset(TlmFwd->MidStats, 0, sizeof(TlmFwd->MidStats));
+
+} /* End TLM_FWD_ResetStatus() */
+
+
+/******************************************************************************
+** Function: TLM_FWD_ForwardMsgs
+**
+** Notes:
+**   1. A message is only received when the transmit ring of every class
+**      with forwarded topics has a free slot so messages that can't be
+**      queued stay in the pipe. One free slot is enough because adding a
+**      message flushes at most one frame.
+**   2. The open frames' flush deadline is checked after every batch,
+**      including batches that didn't receive a message.
+**   3. APIDs with entries in frames the radios discarded are sent as full
+**      entries before any messages are compressed.
+**
+*/
+void TLM_FWD_ForwardMsgs(void)
+{
+   
+   CFE_SB_Buffer_t *SbBufPtr;
+   uint16 BatchCnt = 0;
+   int32  SysStatus = CFE_SUCCESS;
+   bool   RadioInitialized = RADIO_IF_Initialized();
+   uint32 Time = GetTimeMs();
+   uint16 Mid;
+   uint8  Class;
+   
+   if (TlmFwd->MidCnt == 0)
+   {
+      return;
+   }
+   
+   if (TlmFwd->HdrCompress)
+   {
+      InvalidateStaleApids();
+   }
+   
+   while (BatchCnt < TlmFwd->BatchLim && SysStatus == CFE_SUCCESS)
+   {
+      
+      if (RadioInitialized && !ClassSpace())
+      {
+         break;
+      }
+      
+      SysStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, TlmFwd->Pipe, CFE_SB_POLL);
+      if (SysStatus == CFE_SUCCESS)
+      {
+         BatchCnt++;
+         if (RadioInitialized)
+         {
+            ForwardMsg(SbBufPtr, Time);
+         }
+         else
+         {
+            TlmFwd->DropCnt++;
+            Mid = MidIndex(SbBufPtr);
+            if (Mid < TlmFwd->MidCnt)
+            {
+               TlmFwd->MidStats[Mid].DropCnt++;
+            }
+         }
+      }
+      
+   } /* End while batch */
+   
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      if (TX_FRAME_Expired(&TlmFwd->Frame[Class], Time, TlmFwd->FlushDeadline))
+      {
+         if (RADIO_IF_TxQueueSpace(Class) > 0)
+         {
+            FlushFrame(Class);
+         }
+      }
+   }
+   
+} /* End TLM_FWD_ForwardMsgs() */
+
+
+/******************************************************************************
+** Function: TLM_FWD_FrameCnt
+**
+*/
+uint32 TLM_FWD_FrameCnt(void)
+{
+   
+   uint32 FrameCnt = 0;
+   uint8  Class;
+   
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      FrameCnt += TlmFwd->Frame[Class].FrameCnt;
+   }
+   
+   return FrameCnt;
+   
+} /* End TLM_FWD_FrameCnt() */
+
+
+/******************************************************************************
+** Function: TLM_FWD_SendMidAirtimeTlmCmd
+**
+*/
+bool TLM_FWD_SendMidAirtimeTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+   
+   LORA_TX_MidAirtimeTlm_Payload_t *Payload = &TlmFwd->MidAirtimeTlm.Payload;
+   const TLM_FWD_MidStats_t *Stats;
+   uint64 AirtimeTotal = 0;
+   uint16 i;
+   
+   for (i = 0; i < TlmFwd->MidCnt; i++)
+   {
+      AirtimeTotal += TlmFwd->MidStats[i].Airtime;
+   }
+   
+   Payload->MidCnt = TlmFwd->MidCnt;
+   for (i = 0; i < TlmFwd->MidCnt; i++)
+   {
+      Stats = &TlmFwd->MidStats[i];
+      Payload->Mid[i].MsgId   = CFE_SB_MsgIdToValue(TlmFwd->Mid[i]);
+      Payload->Mid[i].MsgCnt  = Stats->MsgCnt;
+      Payload->Mid[i].ByteCnt = Stats->ByteCnt;
+      Payload->Mid[i].Airtime = (uint32)(Stats->Airtime / 1000);
+      Payload->Mid[i].AirtimeShare = (AirtimeTotal > 0) ? (uint8)((Stats->Airtime * 100 + AirtimeTotal / 2) / AirtimeTotal) : 0;
+      Payload->Mid[i].DropCnt = Stats->DropCnt;
+   }
+   
+   CFE_SB_TimeStampMsg(CFE_MSG_PTR(TlmFwd->MidAirtimeTlm.TelemetryHeader));
+   CFE_SB_TransmitMsg(CFE_MSG_PTR(TlmFwd->MidAirtimeTlm.TelemetryHeader), true);
+   
+   CFE_EVS_SendEvent(TLM_FWD_SEND_MID_AIRTIME_TLM_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                     "Sent airtime accounting telemetry for %d forwarded topics", TlmFwd->MidCnt);
+   return true;
+   
+} /* End TLM_FWD_SendMidAirtimeTlmCmd() */
+
+
+/******************************************************************************
+** Function: ClassSpace
+**
+** Return true if every class with forwarded topics can open a new frame
+**
+** Notes:
+**   1. An open frame is built in its ring's free producer slot so a class
+**      with an open frame needs a second free slot.
+**
+*/
+static bool ClassSpace(void)
+{
+   
+   uint8 Class;
+   
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      if ((TlmFwd->ClassMask & (1 << Class)) && 
+          RADIO_IF_TxQueueSpace(Class) < (TX_FRAME_IsOpen(&TlmFwd->Frame[Class]) ? 2 : 1))
+      {
+         return false;
+      }
+   }
+   
+   return true;
+   
+} /* End ClassSpace() */
+
+
+/******************************************************************************
+** Function: ForwardMsg
+**
+** Notes:
+**   1. The complete SB message, or its compressed entry when header
+**      compression is enabled, is packed into its class's open frame. A
+**      full frame is flushed and the message starts a new frame.
+**   2. A message is compressed once, directly into the frame, so the
+**      compressor's context only advances for messages that are framed.
+**
+*/
+static void ForwardMsg(const CFE_SB_Buffer_t *SbBufPtr, uint32 Time)
+{
+   
+   CFE_MSG_Size_t MsgSize  = 0;
+   CFE_SB_MsgId_t MsgId    = CFE_SB_INVALID_MSG_ID;
+   uint16         MsgLim   = TlmFwd->HdrCompress ? (TX_FRAME_MAX_MSG_LEN + TX_HDRC_HDR_LEN) : TX_FRAME_MAX_MSG_LEN;
+   uint16         EntryLen = 0;
+   uint8          Class    = 0;
+   uint32         Deadline = 0;
+   uint16         Mid;
+   TX_FRAME_Class_t *Frame;
+   
+   CFE_MSG_GetSize(&SbBufPtr->Msg, &MsgSize);
+   CFE_MSG_GetMsgId(&SbBufPtr->Msg, &MsgId);
+   
+   Mid = MidIndex(SbBufPtr);
+   if (Mid < TlmFwd->MidCnt)
+   {
+      Class    = TlmFwd->MidClass[Mid];
+      Deadline = TlmFwd->MidDeadline[Mid];
+   }
+   Frame = &TlmFwd->Frame[Class];
+   
+   if (MsgSize <= MsgLim)
+   {
+      EntryLen = PackMsg(Class, SbBufPtr, MsgSize, Time);
+      if (EntryLen == 0 && Frame->MsgCnt > 0)
+      {
+         FlushFrame(Class);
+         EntryLen = PackMsg(Class, SbBufPtr, MsgSize, Time);
+      }
+   }
+   
+   if (EntryLen > 0)
+   {
+      if (Mid < TlmFwd->MidCnt)
+      {
+         TlmFwd->FrameMidMsgs[Class][Mid]++;
+         TlmFwd->FrameMidBytes[Class][Mid] += EntryLen + TX_FRAME_MSG_HDR_LEN;
+      }
+      if (Frame->MsgCnt == 1)
+      {
+         TlmFwd->FrameDeadline[Class] = 0;
+      }
+      if (Deadline > 0)
+      {
+         Deadline += Time - Frame->OpenTime;
+         if (TlmFwd->FrameDeadline[Class] == 0 || Deadline < TlmFwd->FrameDeadline[Class])
+         {
+            TlmFwd->FrameDeadline[Class] = Deadline;
+         }
+      }
+   }
+   else
+   {
+      TlmFwd->DropCnt++;
+      if (Mid < TlmFwd->MidCnt)
+      {
+         TlmFwd->MidStats[Mid].DropCnt++;
+      }
+      if (MsgSize > MsgLim || TX_FRAME_IsOpen(Frame))
+      {
+         CFE_EVS_SendEvent(TLM_FWD_FORWARD_MSG_EID, CFE_EVS_EventType_ERROR,
+                           "Forwarded message 0x%04X length %d exceeds radio payload limit %d",
+                           CFE_SB_MsgIdToValue(MsgId), (int)MsgSize, TX_FRAME_MAX_MSG_LEN);
+      }
+      if (Frame->MsgCnt == 0)
+      {
+         TX_FRAME_Close(Frame);
+      }
+   }
+   
+} /* End ForwardMsg() */
+
+
+/******************************************************************************
+** Function: PackMsg
+**
+** Write a message into its class's open frame, opening a frame in the
+** class's transmit ring slot if needed
+**
+** Notes:
+**   1. The SB message is copied, or header compressed, directly into the
+**      ring slot that is written to the radio so the message isn't copied
+**      again before it's transmitted.
+**   2. Returns the message's frame entry length, zero if it doesn't fit in
+**      the open frame or the ring has no free slot.
+**
+*/
+static uint16 PackMsg(uint8 Class, const CFE_SB_Buffer_t *SbBufPtr, uint16 MsgSize, uint32 Time)
+{
+   
+   TX_FRAME_Class_t *Frame = &TlmFwd->Frame[Class];
+   uint8  *Slot;
+   uint16  EntryLen = 0;
+   
+   if (!TX_FRAME_IsOpen(Frame))
+   {
+      Slot = RADIO_IF_PayloadSlot(Class);
+      if (Slot == NULL)
+      {
+         return 0;
+      }
+      TX_FRAME_Open(Frame, Slot, Time);
+   }
+   
+   if (TlmFwd->HdrCompress)
+   {
+      EntryLen = TX_HDRC_Compress(&TlmFwd->Hdrc, (const uint8 *)SbBufPtr, MsgSize,
+                                  TX_FRAME_MsgBuf(Frame), TX_FRAME_MsgSpace(Frame));
+   }
+   else if (MsgSize <= TX_FRAME_MsgSpace(Frame))
+   {
+      memcpy(TX_FRAME_MsgBuf(Frame), SbBufPtr, MsgSize);
+      EntryLen = MsgSize;
+   }
+   
+   if (EntryLen > 0)
+   {
+      TX_FRAME_CommitMsg(Frame, EntryLen);
+   }
+   
+   return EntryLen;
+   
+} /* End PackMsg() */
+
+
+/******************************************************************************
+** Function: FlushFrame
+**
+** Queue a class's open frame for transmission
+**
+** Notes:
+**   1. The frame is queued with the time it was opened so the transmit
+**      latency and deadline include the time its messages spent packing.
+**   2. The frame was built in the ring's producer slot so queueing it only
+**      publishes the slot. Only the producer adds to a ring's depth and
+**      airtime so the slot is still free and queueing can't fail. A failure
+**      is reported as an error and the frame's messages are counted as
+**      dropped.
+**   3. The frame's airtime, including the frame header, is divided between
+**      its topics by their share of the frame's message bytes.
+**
+*/
+static void FlushFrame(uint8 Class)
+{
+   
+   TX_FRAME_Class_t   *Frame = &TlmFwd->Frame[Class];
+   TLM_FWD_MidStats_t *Stats;
+   uint32 Airtime;
+   uint16 MsgBytes;
+   uint16 Mid;
+   
+   if (TX_FRAME_IsOpen(Frame) && Frame->MsgCnt > 0)
+   {
+      Airtime = RADIO_IF_QueuePayload(Class, Frame->Len, Frame->OpenTime, TlmFwd->FrameDeadline[Class]);
+      if (Airtime > 0)
+      {
+         TlmFwd->MsgCnt += Frame->MsgCnt;
+         MsgBytes = Frame->Len - TX_FRAME_HDR_LEN;
+         for (Mid = 0; Mid < TlmFwd->MidCnt; Mid++)
+         {
+            if (TlmFwd->FrameMidMsgs[Class][Mid] > 0)
+            {
+               Stats = &TlmFwd->MidStats[Mid];
+               Stats->MsgCnt  += TlmFwd->FrameMidMsgs[Class][Mid];
+               Stats->ByteCnt += TlmFwd->FrameMidBytes[Class][Mid];
+               Stats->Airtime += ((uint64)Airtime * TlmFwd->FrameMidBytes[Class][Mid]) / MsgBytes;
+            }
+         }
+      }
+      else
+      {
+         TlmFwd->DropCnt += Frame->MsgCnt;
+         CFE_EVS_SendEvent(TLM_FWD_FLUSH_FRAME_EID, CFE_EVS_EventType_ERROR,
+                           "Class %d frame with %d messages wasn't queued in its producer slot",
+                           Class, Frame->MsgCnt);
+      }
+      TX_FRAME_Close(Frame);
+      memset(TlmFwd->FrameMidMsgs[Class], 0, sizeof(TlmFwd->FrameMidMsgs[Class]));
+      memset(TlmFwd->FrameMidBytes[Class], 0, sizeof(TlmFwd->FrameMidBytes[Class]));
+   }
+   
+} /* End FlushFrame() */
+
+
+/******************************************************************************
+** Function: InvalidateStaleApids
+**
+** Invalidate the compressor contexts of APIDs in discarded frames
+**
+*/
+static void InvalidateStaleApids(void)
+{
+   
+   uint16 Apid;
+   
+   while (RADIO_IF_StaleApid(&Apid))
+   {
+      if (Apid == RADIO_IF_STALE_APID_ALL)
+      {
+         TX_HDRC_InvalidateAll(&TlmFwd->Hdrc);
+      }
+      else
+      {
+         TX_HDRC_Invalidate(&TlmFwd->Hdrc, Apid);
+      }
+   }
+   
+} /* End InvalidateStaleApids() */
+
+
+/******************************************************************************
+** Function: MidIndex
+**
+** Return a message's forwarded topic table index
+**
+** Notes:
+**   1. Returns MidCnt if the message isn't a forwarded topic.
+**
+*/
+static uint16 MidIndex(const CFE_SB_Buffer_t *SbBufPtr)
+{
+   
+   CFE_SB_MsgId_t MsgId = CFE_SB_INVALID_MSG_ID;
+   uint16 i;
+   
+   CFE_MSG_GetMsgId(&SbBufPtr->Msg, &MsgId);
+   
+   for (i = 0; i < TlmFwd->MidCnt; i++)
+   {
+      if (CFE_SB_MsgId_Equal(MsgId, TlmFwd->Mid[i]))
+      {
+         break;
+      }
+   }
+   
+   return i;
+   
+} /* End MidIndex() */
+
+
+/******************************************************************************
+** Function: GetTimeMs
+**
+*/
+static uint32 GetTimeMs(void)
+{
+   
+   OS_time_t LocalTime;
+   
+   OS_GetLocalTime(&LocalTime);
+   
+   return (uint32)OS_TimeGetTotalMilliseconds(LocalTime);
+   
+} /* End GetTimeMs() */
+
+
+/******************************************************************************
+** Function: SubscribeTopics
+**
+** Notes:
+**   1. TopicIdList is a comma or space separated list of
+**      TopicId[:Class[:DeadlineMs]] entries. Decimal and 0x prefixed
+**      hexadecimal values are accepted.
+**
+*/
+static void SubscribeTopics(const char *TopicIdList)
+{
+   
+   const char *TopicStr = TopicIdList;
+   char  *EndPtr;
+   uint32 TopicId;
+   uint32 Class;
+   uint32 Deadline;
+   int32  SysStatus;
+   
+   while (*TopicStr != '\0')
+   {
+      
+      if (*TopicStr == ',' || *TopicStr == ' ')
+      {
+         TopicStr++;
+         continue;
+      }
+      
+      Class    = 0;
+      Deadline = 0;
+      TopicId  = strtoul(TopicStr, &EndPtr, 0);
+      if (EndPtr != TopicStr && *EndPtr == ':')
+      {
+         Class = strtoul(EndPtr + 1, &EndPtr, 0);
+         if (*EndPtr == ':')
+         {
+            Deadline = strtoul(EndPtr + 1, &EndPtr, 0);
+         }
+      }
+      if (EndPtr == TopicStr || (*EndPtr != '\0' && *EndPtr != ',' && *EndPtr != ' ') ||
+          Class >= TX_SCHED_CLASS_CNT)
+      {
+         CFE_EVS_SendEvent(TLM_FWD_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Invalid telemetry forwarding topic ID list entry '%s'", TopicStr);
+         break;
+      }
+      TopicStr = EndPtr;
+      
+      if (TlmFwd->MidCnt >= LORA_TX_TLM_FWD_MAX_MIDS)
+      {
+         CFE_EVS_SendEvent(TLM_FWD_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Telemetry forwarding topic ID list exceeds the %d topic limit",
+                           LORA_TX_TLM_FWD_MAX_MIDS);
+         break;
+      }
+      
+      TlmFwd->Mid[TlmFwd->MidCnt] = CFE_SB_ValueToMsgId(TopicId);
+      TlmFwd->MidClass[TlmFwd->MidCnt]    = Class;
+      TlmFwd->MidDeadline[TlmFwd->MidCnt] = Deadline;
+      SysStatus = CFE_SB_Subscribe(TlmFwd->Mid[TlmFwd->MidCnt], TlmFwd->Pipe);
+      if (SysStatus == CFE_SUCCESS)
+      {
+         TlmFwd->ClassMask |= (1 << Class);
+         TlmFwd->MidCnt++;
+      }
+      else
+      {
+         CFE_EVS_SendEvent(TLM_FWD_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Failed to subscribe to telemetry forwarding topic ID %d, status = 0x%08X",
+                           TopicId, SysStatus);
+      }
+      
+   } /* End while topic IDs */
+   
+   CFE_EVS_SendEvent(TLM_FWD_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                     "Forwarding %d software bus topics over the radio link", TlmFwd->MidCnt);
+   
+} /* End SubscribeTopics() */
@@ -0,0 +1,209 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the telemetry forwarding class
+**
+**  Notes:
+**    1. Subscribes to the software bus topics listed in the app's JSON init
+**       file on a dedicated pipe and queues each received message for
+**       transmission over the LoRa link.
+**    2. The pipe is drained in batches by the app's main task each time it
+**       wakes up. The main task pends on its command pipe with a timeout so
+**       the forwarding pipe is serviced at least once per forwarding period.
+**    3. When the transmit ring is full the remaining messages are left in
+**       the pipe so the pipe's depth absorbs telemetry bursts. Messages are
+**       discarded when the radio isn't initialized so the pipe doesn't
+**       overflow while the link is down.
+**    4. Messages are packed into TX_FRAME frames. A partially filled frame
+**       is flushed once it has been open for the configured flush deadline
+**       so packing never delays a message by more than the deadline plus
+**       one forwarding period. Frames are built in place in the transmit
+**       ring slot the radio is written from so a message is only copied
+**       once, from its SB buffer into the slot.
+**    5. When header compression is enabled each message is replaced by its
+**       TX_HDRC entry and frames are sent with the header compressed frame
+**       type.
+**    6. Each topic is assigned a transmit scheduler class and an optional
+**       deadline. Every class packs its own frame so a frame's messages
+**       share a class. A frame's deadline is its earliest message deadline
+**       and it's measured from when the frame was opened. An APID's
+**       messages stay in order because a topic only has one class.
+**    7. Each topic's share of the link is accounted when its frames are
+**       queued. A frame's airtime is divided between its topics by their
+**       share of the frame's bytes. Frames dropped by the child task after
+**       missing their deadline are still charged because a frame's topics
+**       aren't known once it's queued.
+**
+*/
+
+#ifndef _tlm_fwd_
+#define _tlm_fwd_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "tx_frame.h"
+#include "tx_hdrc.h"
+#include "tx_sched.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/*
+** Event Message IDs
+*/
+
+#define TLM_FWD_CONSTRUCTOR_EID  (TLM_FWD_BASE_EID + 0)
+#define TLM_FWD_FORWARD_MSG_EID  (TLM_FWD_BASE_EID + 1)
+#define TLM_FWD_SEND_MID_AIRTIME_TLM_CMD_EID  (TLM_FWD_BASE_EID + 2)
+#define TLM_FWD_FLUSH_FRAME_EID  (TLM_FWD_BASE_EID + 3)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/*
+** Forwarded topic statistics since reset
+*/
+typedef struct
+{
+   
+   uint32  MsgCnt;      /* Messages in queued frames                */
+   uint32  ByteCnt;     /* Frame bytes including each message's header */
+   uint64  Airtime;     /* us, share of queued frames' time on air  */
+   uint32  DropCnt;     /* Messages discarded before they were queued */
+   
+} TLM_FWD_MidStats_t;
+
+
+/******************************************************************************
+** TLM_FWD_Class
+*/
+typedef struct
+{
+
+   /*
+   ** Framework References
+   */
+   
+   INITBL_Class_t *IniTbl;
+
+   /*
+   ** Telemetry Packets
+   */
+   
+   LORA_TX_MidAirtimeTlm_t  MidAirtimeTlm;
+
+   /*
+   ** Class State Data
+   */
+   
+   CFE_SB_PipeId_t Pipe;
+   uint16          BatchLim;
+   uint32          FlushDeadline;   /* ms */
+   uint16          MidCnt;
+   CFE_SB_MsgId_t  Mid[LORA_TX_TLM_FWD_MAX_MIDS];
+   uint8           MidClass[LORA_TX_TLM_FWD_MAX_MIDS];
+   uint32          MidDeadline[LORA_TX_TLM_FWD_MAX_MIDS];   /* ms, 0 is no deadline */
+   uint8           ClassMask;                               /* Classes with forwarded topics */
+   
+   uint32  MsgCnt;        /* Messages queued for transmission         */
+   uint32  DropCnt;       /* Messages discarded                       */
+   
+   TLM_FWD_MidStats_t MidStats[LORA_TX_TLM_FWD_MAX_MIDS];
+   
+   TX_FRAME_Class_t Frame[TX_SCHED_CLASS_CNT];
+   uint32           FrameDeadline[TX_SCHED_CLASS_CNT];      /* ms after the frame opened, 0 is no deadline */
+   uint8            FrameMidMsgs[TX_SCHED_CLASS_CNT][LORA_TX_TLM_FWD_MAX_MIDS];   /* Open frame's messages per topic */
+   uint16           FrameMidBytes[TX_SCHED_CLASS_CNT][LORA_TX_TLM_FWD_MAX_MIDS];  /* Open frame's bytes per topic    */
+   
+   bool             HdrCompress;
+   TX_HDRC_Class_t  Hdrc;
+   
+} TLM_FWD_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TLM_FWD_Constructor
+**
+** Initialize the telemetry forwarding object to a known state
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**   2. Creates the forwarding pipe and subscribes to the init file's topic
+**      list. Each list entry is TopicId[:Class[:DeadlineMs]], the class
+**      defaults to 0 and the deadline defaults to none.
+**
+*/
+void TLM_FWD_Constructor(TLM_FWD_Class_t *TlmFwdPtr, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: TLM_FWD_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+**
+*/
+void TLM_FWD_ResetStatus(void);
+
+
+/******************************************************************************
+** Function: TLM_FWD_ForwardMsgs
+**
+** Drain up to one batch of messages from the forwarding pipe
+**
+** Notes:
+**   1. Must be called from the app's main task because it is the transmit
+**      rings' producer.
+**
+*/
+void TLM_FWD_ForwardMsgs(void);
+
+
+/******************************************************************************
+** Function: TLM_FWD_FrameCnt
+**
+** Return the number of frames packed by every class
+**
+*/
+uint32 TLM_FWD_FrameCnt(void);
+
+
+/******************************************************************************
+** Function: TLM_FWD_SendMidAirtimeTlmCmd
+**
+** Send the forwarded topics' airtime accounting telemetry packet
+**
+** Notes:
+**   1. Must match CMDMGR_CmdFuncPtr_t function signature
+**   2. AirtimeShare is each topic's percentage of the airtime charged to
+**      every forwarded topic since reset.
+**
+*/
+bool TLM_FWD_SendMidAirtimeTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+#endif /* _tlm_fwd_ */
@@ -0,0 +1,211 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the adaptive data rate controller class
+**
+**  Notes:
+**    1. See tx_adr.h for the control policy.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "tx_adr.h"
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void SwitchProfile(TX_ADR_Class_t *TxAdr, uint8_t Profile, uint32_t TimeMs);
+
+
+/******************************************************************************
+** Function: TX_ADR_Constructor
+**
+*/
+void TX_ADR_Constructor(TX_ADR_Class_t *TxAdr, uint32_t BacklogHighMs, uint32_t BacklogLowMs,
+                        uint32_t HoldMs)
+{
+   
+   memset(TxAdr, 0, sizeof(TX_ADR_Class_t));
+   
+   TxAdr->BacklogHigh = BacklogHighMs * 1000;
+   TxAdr->BacklogLow  = BacklogLowMs * 1000;
+   TxAdr->HoldMs      = HoldMs;
+
+} /* End TX_ADR_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_ADR_LoadProfiles
+**
+*/
+uint8_t TX_ADR_LoadProfiles(TX_ADR_Class_t *TxAdr, const char *ProfileStr, uint32_t TimeMs)
+{
+   
+   const char *Str = ProfileStr;
+   char *EndPtr;
+   long  Field[4];
+   uint8_t i;
+   TX_ADR_Profile_t *Profile;
+   
+   TxAdr->ProfileCnt = 0;
+   memset(TxAdr->Stats, 0, sizeof(TxAdr->Stats));
+   
+   while (*Str != '\0')
+   {
+      
+      if (*Str == ',' || *Str == ' ')
+      {
+         Str++;
+         continue;
+      }
+      
+      if (TxAdr->ProfileCnt >= TX_ADR_MAX_PROFILES)
+      {
+         TxAdr->ProfileCnt = 0;
+         break;
+      }
+      
+      for (i = 0; i < 4; i++)
+      {
+         Field[i] = strtol(Str, &EndPtr, 0);
+         if (EndPtr == Str || (i < 3 && *EndPtr != ':'))
+         {
+            TxAdr->ProfileCnt = 0;
+            return 0;
+         }
+         Str = (i < 3) ? EndPtr + 1 : EndPtr;
+      }
+      
+      Profile = &TxAdr->Profile[TxAdr->ProfileCnt];
+      Profile->SpreadingFactor = (uint8_t)Field[0];
+      Profile->Bandwidth       = (uint8_t)Field[1];
+      Profile->CodingRate      = (uint8_t)Field[2];
+      Profile->MarginDb        = (int8_t)Field[3];
+      
+      if (TxAdr->ProfileCnt > 0 && Profile->MarginDb <= TxAdr->Profile[TxAdr->ProfileCnt - 1].MarginDb)
+      {
+         TxAdr->ProfileCnt = 0;
+         return 0;
+      }
+      TxAdr->ProfileCnt++;
+      
+   } /* End while profiles */
+   
+   if (TxAdr->ProfileCnt > 0)
+   {
+      TxAdr->Cur = TxAdr->ProfileCnt - 1;
+      TxAdr->CurStartMs = TimeMs;
+   }
+   
+   return TxAdr->ProfileCnt;
+   
+} /* End TX_ADR_LoadProfiles() */
+
+
+/******************************************************************************
+** Function: TX_ADR_Select
+**
+** Notes:
+**   1. When no profile has the required margin the most robust profile is
+**      the only allowed profile.
+**
+*/
+bool TX_ADR_Select(TX_ADR_Class_t *TxAdr, uint32_t Backlog, uint32_t TimeMs)
+{
+   
+   uint8_t First = 0;
+   uint8_t Last;
+   uint8_t Target;
+   
+   if (!TxAdr->Enabled || TxAdr->ProfileCnt == 0)
+   {
+      return false;
+   }
+   
+   Last = TxAdr->ProfileCnt - 1;
+   while (First < Last && TxAdr->Profile[First].MarginDb < TxAdr->MarginReq)
+   {
+      First++;
+   }
+   
+   Target = TxAdr->Cur;
+   if (TxAdr->Cur < First)
+   {
+      Target = First;
+   }
+   else if ((TimeMs - TxAdr->CurStartMs) >= TxAdr->HoldMs)
+   {
+      if (Backlog >= TxAdr->BacklogHigh && TxAdr->Cur > First)
+      {
+         Target = TxAdr->Cur - 1;
+      }
+      else if (Backlog <= TxAdr->BacklogLow && TxAdr->Cur < Last)
+      {
+         Target = TxAdr->Cur + 1;
+      }
+   }
+   
+   if (Target != TxAdr->Cur)
+   {
+      SwitchProfile(TxAdr, Target, TimeMs);
+      return true;
+   }
+   
+   return false;
+   
+} /* End TX_ADR_Select() */
+
+
+/******************************************************************************
+** Function: TX_ADR_DwellMs
+**
+*/
+uint32_t TX_ADR_DwellMs(const TX_ADR_Class_t *TxAdr, uint8_t Profile, uint32_t TimeMs)
+{
+   
+   uint32_t DwellMs = TxAdr->Stats[Profile].DwellMs;
+   
+   if (Profile == TxAdr->Cur && TxAdr->ProfileCnt > 0)
+   {
+      DwellMs += TimeMs - TxAdr->CurStartMs;
+   }
+   
+   return DwellMs;
+   
+} /* End TX_ADR_DwellMs() */
+
+
+/******************************************************************************
+** Function: SwitchProfile
+**
+*/
+static void SwitchProfile(TX_ADR_Class_t *TxAdr, uint8_t Profile, uint32_t TimeMs)
+{
+   
+   TxAdr->Stats[TxAdr->Cur].DwellMs += TimeMs - TxAdr->CurStartMs;
+   
+   TxAdr->Cur        = Profile;
+   TxAdr->CurStartMs = TimeMs;
+   TxAdr->SwitchCnt++;
+   TxAdr->Stats[Profile].SwitchCnt++;
+   
+} /* End SwitchProfile() */
@@ -0,0 +1,166 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the adaptive data rate controller class
+**
+**  Notes:
+**    1. Selects a LoRa modulation profile from a ladder ordered from the
+**       fastest profile to the most robust profile. Each profile has a
+**       link margin in dB relative to the fastest profile.
+**    2. A transmit-only link has no receiver feedback so the required
+**       margin is configured and changed by command, for example ahead of
+**       a low elevation pass. Profiles with less than the required margin
+**       are never selected and a switch to restore the margin is made
+**       immediately.
+**    3. Within the allowed profiles the controller steps one profile
+**       faster when the transmit backlog reaches the high threshold and
+**       one profile more robust when the backlog falls to the low
+**       threshold so spare airtime is spent on margin. Backlog driven
+**       switches are separated by at least the hold time.
+**    4. The controller only selects a profile. The caller applies it to
+**       the radio between packets.
+**    5. This header shouldn't include cFS header files so the controller
+**       can be used by host tools.
+**
+*/
+
+#ifndef _tx_adr_
+#define _tx_adr_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_platform_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_ADR_MAX_PROFILES  LORA_TX_ADR_MAX_PROFILES
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef struct
+{
+   
+   uint8_t  SpreadingFactor;   /* Radio register codes */
+   uint8_t  Bandwidth;
+   uint8_t  CodingRate;
+   int8_t   MarginDb;
+
+} TX_ADR_Profile_t;
+
+
+typedef struct
+{
+   
+   uint32_t  DwellMs;     /* Time in the profile before the current visit */
+   uint32_t  SwitchCnt;   /* Switches to the profile */
+
+} TX_ADR_ProfileStats_t;
+
+
+/******************************************************************************
+** TX_ADR_Class
+*/
+typedef struct
+{
+
+   bool      Enabled;
+   int8_t    MarginReq;      /* dB */
+   uint32_t  BacklogHigh;    /* us of airtime */
+   uint32_t  BacklogLow;     /* us of airtime */
+   uint32_t  HoldMs;
+   
+   uint8_t   ProfileCnt;
+   TX_ADR_Profile_t Profile[TX_ADR_MAX_PROFILES];
+   
+   uint8_t   Cur;
+   uint32_t  CurStartMs;
+   
+   /*
+   ** Statistics
+   */
+   
+   uint32_t  SwitchCnt;
+   TX_ADR_ProfileStats_t Stats[TX_ADR_MAX_PROFILES];
+   
+} TX_ADR_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_ADR_Constructor
+**
+** Notes:
+**   1. The controller is disabled and has no profiles until profiles are
+**      loaded.
+**
+*/
+void TX_ADR_Constructor(TX_ADR_Class_t *TxAdr, uint32_t BacklogHighMs, uint32_t BacklogLowMs,
+                        uint32_t HoldMs);
+
+
+/******************************************************************************
+** Function: TX_ADR_LoadProfiles
+**
+** Load the profile ladder from a string and return the number of profiles
+**
+** Notes:
+**   1. ProfileStr is a comma separated list of SF:BW:CR:MarginDb entries
+**      ordered from the fastest to the most robust profile. Decimal and 0x
+**      prefixed hexadecimal values are accepted.
+**   2. Returns zero and clears the ladder if an entry is malformed, the
+**      list has too many entries or the margins don't increase.
+**   3. The most robust profile is selected.
+**
+*/
+uint8_t TX_ADR_LoadProfiles(TX_ADR_Class_t *TxAdr, const char *ProfileStr, uint32_t TimeMs);
+
+
+/******************************************************************************
+** Function: TX_ADR_Select
+**
+** Select the profile for the next packet and return true if it changed
+**
+** Notes:
+**   1. Backlog is the airtime (us) waiting to be transmitted.
+**
+*/
+bool TX_ADR_Select(TX_ADR_Class_t *TxAdr, uint32_t Backlog, uint32_t TimeMs);
+
+
+/******************************************************************************
+** Function: TX_ADR_DwellMs
+**
+** Return the total time spent in a profile including the current visit
+**
+*/
+uint32_t TX_ADR_DwellMs(const TX_ADR_Class_t *TxAdr, uint8_t Profile, uint32_t TimeMs);
+
+
+#endif /* _tx_adr_ */
@@ -0,0 +1,235 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the transmit duty cycle limiter class
+**
+**  Notes:
+**    1. See tx_duty.h for the limiter's behavior.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_duty.h"
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static bool Expired(const TX_DUTY_Class_t *TxDuty, const TX_DUTY_Charge_t *Charge, uint32_t TimeMs);
+static void ExpireCharges(TX_DUTY_Class_t *TxDuty, uint32_t TimeMs);
+
+
+/******************************************************************************
+** Function: TX_DUTY_Constructor
+**
+*/
+void TX_DUTY_Constructor(TX_DUTY_Class_t *TxDuty, uint32_t BudgetMs, uint32_t WindowMs)
+{
+   
+   memset(TxDuty, 0, sizeof(TX_DUTY_Class_t));
+   
+   TxDuty->Enabled  = (BudgetMs > 0 && WindowMs > 0);
+   TxDuty->Budget   = (uint64_t)BudgetMs * 1000;
+   TxDuty->WindowMs = WindowMs;
+   
+} /* End TX_DUTY_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_DUTY_ResetStatus
+**
+*/
+void TX_DUTY_ResetStatus(TX_DUTY_Class_t *TxDuty)
+{
+   
+   TxDuty->ThrottleCnt = 0;
+   TxDuty->ThrottleMs  = 0;
+   
+} /* End TX_DUTY_ResetStatus() */
+
+
+/******************************************************************************
+** Function: TX_DUTY_Wait
+**
+** Notes:
+**   1. The wait ends when the oldest charges that make room for Airtime
+**      expire. A packet longer than the budget needs every charge expired.
+**
+*/
+uint32_t TX_DUTY_Wait(TX_DUTY_Class_t *TxDuty, uint32_t Airtime, uint32_t TimeMs)
+{
+   
+   uint64_t Over;
+   uint64_t Freed = 0;
+   uint32_t WaitMs = 1;
+   uint16_t i, Idx;
+   
+   if (!TxDuty->Enabled)
+   {
+      return 0;
+   }
+   
+   ExpireCharges(TxDuty, TimeMs);
+   
+   if (TxDuty->Cnt == 0 || TxDuty->Used + Airtime <= TxDuty->Budget)
+   {
+      return 0;
+   }
+   
+   Over = (Airtime < TxDuty->Budget) ? (TxDuty->Used + Airtime - TxDuty->Budget) : TxDuty->Used;
+   
+   for (i = 0; i < TxDuty->Cnt; i++)
+   {
+      Idx    = (TxDuty->First + i) % TX_DUTY_LEDGER_LEN;
+      Freed += TxDuty->Ledger[Idx].Airtime;
+      if (Freed >= Over)
+      {
+         WaitMs = TxDuty->Ledger[Idx].EndMs + TxDuty->WindowMs - TimeMs;
+         break;
+      }
+   }
+   
+   return (WaitMs > 0) ? WaitMs : 1;
+   
+} /* End TX_DUTY_Wait() */
+
+
+/******************************************************************************
+** Function: TX_DUTY_Charge
+**
+*/
+void TX_DUTY_Charge(TX_DUTY_Class_t *TxDuty, uint32_t Airtime, uint32_t TimeMs)
+{
+   
+   TX_DUTY_Charge_t *Charge;
+   uint16_t Next;
+   
+   if (!TxDuty->Enabled)
+   {
+      return;
+   }
+   
+   ExpireCharges(TxDuty, TimeMs);
+   
+   if (TxDuty->Cnt == TX_DUTY_LEDGER_LEN)
+   {
+      Next = (TxDuty->First + 1) % TX_DUTY_LEDGER_LEN;
+      TxDuty->Ledger[Next].Airtime += TxDuty->Ledger[TxDuty->First].Airtime;
+      TxDuty->First = Next;
+      TxDuty->Cnt--;
+   }
+   
+   Charge = &TxDuty->Ledger[(TxDuty->First + TxDuty->Cnt) % TX_DUTY_LEDGER_LEN];
+   Charge->EndMs   = TimeMs + (Airtime + 999) / 1000;
+   Charge->Airtime = Airtime;
+   
+   TxDuty->Used += Airtime;
+   TxDuty->Cnt++;
+   
+} /* End TX_DUTY_Charge() */
+
+
+/******************************************************************************
+** Function: TX_DUTY_Throttled
+**
+*/
+void TX_DUTY_Throttled(TX_DUTY_Class_t *TxDuty, uint32_t DelayMs, bool NewPkt)
+{
+   
+   if (NewPkt)
+   {
+      TxDuty->ThrottleCnt++;
+   }
+   TxDuty->ThrottleMs += DelayMs;
+   
+} /* End TX_DUTY_Throttled() */
+
+
+/******************************************************************************
+** Function: TX_DUTY_Remaining
+**
+*/
+uint32_t TX_DUTY_Remaining(const TX_DUTY_Class_t *TxDuty, uint32_t TimeMs)
+{
+   
+   uint64_t Used = 0;
+   uint16_t i;
+   const TX_DUTY_Charge_t *Charge;
+   
+   if (!TxDuty->Enabled)
+   {
+      return 0;
+   }
+   
+   for (i = 0; i < TxDuty->Cnt; i++)
+   {
+      Charge = &TxDuty->Ledger[(TxDuty->First + i) % TX_DUTY_LEDGER_LEN];
+      if (!Expired(TxDuty, Charge, TimeMs))
+      {
+         Used += Charge->Airtime;
+      }
+   }
+   
+   return (Used < TxDuty->Budget) ? (uint32_t)((TxDuty->Budget - Used) / 1000) : 0;
+   
+} /* End TX_DUTY_Remaining() */
+
+
+/******************************************************************************
+** Function: Expired
+**
+** Return true when a charge's window has passed at TimeMs
+**
+** Notes:
+**   1. The signed difference handles the ms clock wrapping.
+**
+*/
+static bool Expired(const TX_DUTY_Class_t *TxDuty, const TX_DUTY_Charge_t *Charge, uint32_t TimeMs)
+{
+   
+   return ((int32_t)(TimeMs - (Charge->EndMs + TxDuty->WindowMs)) >= 0);
+   
+} /* End Expired() */
+
+
+/******************************************************************************
+** Function: ExpireCharges
+**
+** Remove the charges whose window has passed from the ledger
+**
+*/
+static void ExpireCharges(TX_DUTY_Class_t *TxDuty, uint32_t TimeMs)
+{
+   
+   TX_DUTY_Charge_t *Charge;
+   
+   while (TxDuty->Cnt > 0)
+   {
+      Charge = &TxDuty->Ledger[TxDuty->First];
+      if (!Expired(TxDuty, Charge, TimeMs))
+      {
+         break;
+      }
+      TxDuty->Used -= Charge->Airtime;
+      TxDuty->First = (TxDuty->First + 1) % TX_DUTY_LEDGER_LEN;
+      TxDuty->Cnt--;
+   }
+   
+} /* End ExpireCharges() */
@@ -0,0 +1,168 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the transmit duty cycle limiter class
+**
+**  Notes:
+**    1. A sliding window ledger of airtime. Each packet is charged its time
+**       on air and the charge is held until a full window after the packet
+**       ends, so the airtime of the packets overlapping any window of
+**       WindowMs can't exceed the budget.
+**    2. When the ledger doesn't have room for a packet's airtime the caller
+**       defers the packet for the time returned by TX_DUTY_Wait() rather
+**       than dropping it. The wait ends when enough charges expire.
+**    3. A packet longer than the budget is only sent when the ledger is
+**       empty so it can't be deferred forever. Its window is the only one
+**       that exceeds the budget.
+**    4. Times are in ms on a caller defined clock and airtimes are in us.
+**    5. This header shouldn't include cFS header files so the limiter can
+**       be used by host tools.
+**
+*/
+
+#ifndef _tx_duty_
+#define _tx_duty_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_DUTY_LEDGER_LEN  128   /* Charges held, older charges are merged when it's full */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** TX_DUTY_Charge
+*/
+typedef struct
+{
+
+   uint32_t  EndMs;        /* Time the packet is off the air */
+   uint64_t  Airtime;      /* us, merged charges can exceed 32 bits */
+   
+} TX_DUTY_Charge_t;
+
+
+/******************************************************************************
+** TX_DUTY_Class
+*/
+typedef struct
+{
+
+   bool      Enabled;
+   uint64_t  Budget;       /* us */
+   uint32_t  WindowMs;
+   
+   uint64_t  Used;         /* us, sum of the ledger's charges */
+   uint16_t  First;        /* Oldest charge */
+   uint16_t  Cnt;
+   TX_DUTY_Charge_t Ledger[TX_DUTY_LEDGER_LEN];
+   
+   /*
+   ** Statistics
+   */
+   
+   uint32_t  ThrottleCnt;  /* Packets deferred */
+   uint32_t  ThrottleMs;   /* Time spent deferring packets */
+   
+} TX_DUTY_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_DUTY_Constructor
+**
+** Notes:
+**   1. A zero BudgetMs or WindowMs disables the limiter.
+**   2. The ledger starts empty.
+**
+*/
+void TX_DUTY_Constructor(TX_DUTY_Class_t *TxDuty, uint32_t BudgetMs, uint32_t WindowMs);
+
+
+/******************************************************************************
+** Function: TX_DUTY_ResetStatus
+**
+*/
+void TX_DUTY_ResetStatus(TX_DUTY_Class_t *TxDuty);
+
+
+/******************************************************************************
+** Function: TX_DUTY_Wait
+**
+** Return the ms to wait before a packet with Airtime (us) can be sent
+**
+** Notes:
+**   1. Returns zero when the packet can be sent now.
+**
+*/
+uint32_t TX_DUTY_Wait(TX_DUTY_Class_t *TxDuty, uint32_t Airtime, uint32_t TimeMs);
+
+
+/******************************************************************************
+** Function: TX_DUTY_Charge
+**
+** Charge the ledger for a packet sent at TimeMs
+**
+** Notes:
+**   1. When the ledger is full its two oldest charges are merged into the
+**      later one. The merged airtime is held longer than needed so the
+**      limit is never exceeded, only reached a little later.
+**
+*/
+void TX_DUTY_Charge(TX_DUTY_Class_t *TxDuty, uint32_t Airtime, uint32_t TimeMs);
+
+
+/******************************************************************************
+** Function: TX_DUTY_Throttled
+**
+** Record time spent deferring a packet
+**
+** Notes:
+**   1. NewPkt is true the first time a packet is deferred.
+**
+*/
+void TX_DUTY_Throttled(TX_DUTY_Class_t *TxDuty, uint32_t DelayMs, bool NewPkt);
+
+
+/******************************************************************************
+** Function: TX_DUTY_Remaining
+**
+** Return the airtime (ms) available at TimeMs
+**
+** Notes:
+**   1. Doesn't modify the ledger.
+**
+*/
+uint32_t TX_DUTY_Remaining(const TX_DUTY_Class_t *TxDuty, uint32_t TimeMs);
+
+
+#endif /* _tx_duty_ */
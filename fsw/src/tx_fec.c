@@ -0,0 +1,635 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the transmit forward erasure coding class
+**
+**  Notes:
+**    1. See tx_fec.h for the packet and symbol formats.
+**    2. GF(256) uses the 0x11D polynomial. The vector kernels split each
+**       byte into nibbles and look up Coef*nibble in two 16 entry tables.
+**       NEON kernels are selected at compile time. x86 kernels are
+**       compiled with function target attributes and selected at run time
+**       so the host build doesn't need extra compiler flags.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_fec.h"
+
+#if defined(__ARM_NEON)
+   #include <arm_neon.h>
+   #define TX_FEC_NEON
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+   #include <immintrin.h>
+   #define TX_FEC_X86
+#endif
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define GF_POLY  0x11D
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/* Vector kernels return the number of bytes processed */
+typedef uint16_t (*MulAddFunc_t)(uint8_t *Dst, const uint8_t *Src, const uint8_t *Tbl, uint16_t Len);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static bool    GfInitialized = false;
+static uint8_t GfExp[512];
+static uint8_t GfLog[256];
+
+static MulAddFunc_t MulAddVec = NULL;
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void    InitGf(void);
+static uint8_t GfMul(uint8_t A, uint8_t B);
+static uint8_t GfInv(uint8_t A);
+static uint8_t Coef(uint8_t ParityIdx, uint8_t DataIdx);
+static bool    InvertMatrix(uint8_t *Mat, uint8_t N);
+static MulAddFunc_t AutoKernel(void);
+
+#if defined(TX_FEC_NEON)
+static uint16_t MulAddNeon(uint8_t *Dst, const uint8_t *Src, const uint8_t *Tbl, uint16_t Len);
+#elif defined(TX_FEC_X86)
+static uint16_t MulAddSsse3(uint8_t *Dst, const uint8_t *Src, const uint8_t *Tbl, uint16_t Len);
+static uint16_t MulAddAvx2(uint8_t *Dst, const uint8_t *Src, const uint8_t *Tbl, uint16_t Len);
+#endif
+
+
+/******************************************************************************
+** Function: TX_FEC_Constructor
+**
+*/
+bool TX_FEC_Constructor(TX_FEC_Class_t *TxFec, uint8_t K, uint8_t M, uint16_t PktLen)
+{
+   
+   memset(TxFec, 0, sizeof(TX_FEC_Class_t));
+   
+   InitGf();
+   
+   if (K == 0 || K > TX_FEC_MAX_DATA || M == 0 || M > TX_FEC_MAX_PARITY ||
+       PktLen <= (TX_FEC_HDR_LEN + 1) || PktLen > RADIO_TX_MAX_PAYLOAD_LEN)
+   {
+      return false;
+   }
+   
+   TxFec->K = K;
+   TxFec->M = M;
+   
+   /* Leave room for a parity symbol's Len byte */
+   TxFec->DataMax = PktLen - TX_FEC_HDR_LEN - 1;
+   
+   return true;
+
+} /* End TX_FEC_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_FEC_Reset
+**
+*/
+void TX_FEC_Reset(TX_FEC_Class_t *TxFec)
+{
+   
+   TxFec->Group     = 0;
+   TxFec->DataCnt   = 0;
+   TxFec->ParityCnt = 0;
+   TxFec->SymLen    = 0;
+   TxFec->ParityPending = false;
+   
+   memset(TxFec->Parity, 0, sizeof(TxFec->Parity));
+
+} /* End TX_FEC_Reset() */
+
+
+/******************************************************************************
+** Function: TX_FEC_EncodeData
+**
+*/
+uint16_t TX_FEC_EncodeData(TX_FEC_Class_t *TxFec, uint8_t *Pkt, uint16_t DataLen)
+{
+   
+   uint8_t j, C;
+   
+   Pkt[0] = (uint8_t)(TxFec->Group >> 8);
+   Pkt[1] = (uint8_t)(TxFec->Group & 0xFF);
+   Pkt[2] = TxFec->DataCnt;
+   Pkt[3] = TxFec->K;
+   
+   for (j = 0; j < TxFec->M; j++)
+   {
+      C = Coef(j, TxFec->DataCnt);
+      TxFec->Parity[j][0] ^= GfMul(C, (uint8_t)DataLen);
+      TX_FEC_MulAdd(&TxFec->Parity[j][1], &Pkt[TX_FEC_HDR_LEN], C, DataLen);
+   }
+   
+   if ((DataLen + 1) > TxFec->SymLen)
+   {
+      TxFec->SymLen = DataLen + 1;
+   }
+   
+   if (++TxFec->DataCnt >= TxFec->K)
+   {
+      TxFec->ParityPending = true;
+   }
+   
+   return DataLen + TX_FEC_HDR_LEN;
+   
+} /* End TX_FEC_EncodeData() */
+
+
+/******************************************************************************
+** Function: TX_FEC_EndGroup
+**
+*/
+bool TX_FEC_EndGroup(TX_FEC_Class_t *TxFec)
+{
+   
+   if (TxFec->DataCnt > 0)
+   {
+      TxFec->ParityPending = true;
+   }
+   
+   return TxFec->ParityPending;
+   
+} /* End TX_FEC_EndGroup() */
+
+
+/******************************************************************************
+** Function: TX_FEC_NextParity
+**
+*/
+uint16_t TX_FEC_NextParity(TX_FEC_Class_t *TxFec, uint8_t *Pkt)
+{
+   
+   uint16_t PktLen = TX_FEC_HDR_LEN + TxFec->SymLen;
+   
+   Pkt[0] = (uint8_t)(TxFec->Group >> 8);
+   Pkt[1] = (uint8_t)(TxFec->Group & 0xFF);
+   Pkt[2] = TX_FEC_PARITY | TxFec->ParityCnt;
+   Pkt[3] = TxFec->DataCnt;
+   memcpy(&Pkt[TX_FEC_HDR_LEN], TxFec->Parity[TxFec->ParityCnt], TxFec->SymLen);
+   
+   TxFec->ParityPktCnt++;
+   
+   if (++TxFec->ParityCnt >= TxFec->M)
+   {
+      TxFec->Group++;
+      TxFec->GroupCnt++;
+      TxFec->DataCnt   = 0;
+      TxFec->ParityCnt = 0;
+      TxFec->ParityPending = false;
+      memset(TxFec->Parity, 0, (size_t)TxFec->M * TX_FEC_MAX_SYM_LEN);
+      TxFec->SymLen = 0;
+   }
+   
+   return PktLen;
+   
+} /* End TX_FEC_NextParity() */
+
+
+/******************************************************************************
+** Function: TX_FEC_DecodeGroup
+**
+** Notes:
+**   1. Each received parity symbol is reduced to the sum of its missing
+**      data terms by removing the received data terms. The missing symbols
+**      are the product of the inverted Cauchy submatrix and the reduced
+**      parity symbols.
+**
+*/
+bool TX_FEC_DecodeGroup(uint8_t K, uint16_t SymLen, uint8_t *Symbol[], const bool Present[],
+                        uint8_t *Parity[], const uint8_t ParityIdx[], uint8_t ParityCnt)
+{
+   
+   uint8_t Missing[TX_FEC_MAX_PARITY];
+   uint8_t Mat[TX_FEC_MAX_PARITY * TX_FEC_MAX_PARITY];
+   uint8_t MissingCnt = 0;
+   uint8_t i, j, m;
+   
+   InitGf();
+   
+   for (i = 0; i < K; i++)
+   {
+      if (!Present[i])
+      {
+         if (MissingCnt >= ParityCnt || MissingCnt >= TX_FEC_MAX_PARITY)
+         {
+            return false;
+         }
+         Missing[MissingCnt++] = i;
+      }
+   }
+   
+   if (MissingCnt == 0)
+   {
+      return true;
+   }
+   
+   for (j = 0; j < MissingCnt; j++)
+   {
+      for (i = 0; i < K; i++)
+      {
+         if (Present[i])
+         {
+            TX_FEC_MulAdd(Parity[j], Symbol[i], Coef(ParityIdx[j], i), SymLen);
+         }
+      }
+      for (m = 0; m < MissingCnt; m++)
+      {
+         Mat[j * MissingCnt + m] = Coef(ParityIdx[j], Missing[m]);
+      }
+   }
+   
+   if (!InvertMatrix(Mat, MissingCnt))
+   {
+      return false;
+   }
+   
+   for (m = 0; m < MissingCnt; m++)
+   {
+      memset(Symbol[Missing[m]], 0, SymLen);
+      for (j = 0; j < MissingCnt; j++)
+      {
+         TX_FEC_MulAdd(Symbol[Missing[m]], Parity[j], Mat[m * MissingCnt + j], SymLen);
+      }
+   }
+   
+   return true;
+   
+} /* End TX_FEC_DecodeGroup() */
+
+
+/******************************************************************************
+** Function: TX_FEC_MulAdd
+**
+*/
+void TX_FEC_MulAdd(uint8_t *Dst, const uint8_t *Src, uint8_t Coef, uint16_t Len)
+{
+   
+   uint8_t  Tbl[32];
+   uint16_t i = 0;
+   uint8_t  LogC;
+   
+   if (Coef == 0)
+   {
+      return;
+   }
+   
+   if (MulAddVec != NULL && Len >= 16)
+   {
+      for (i = 0; i < 16; i++)
+      {
+         Tbl[i]      = GfMul(Coef, (uint8_t)i);
+         Tbl[16 + i] = GfMul(Coef, (uint8_t)(i << 4));
+      }
+      i = MulAddVec(Dst, Src, Tbl, Len);
+   }
+   
+   LogC = GfLog[Coef];
+   for (; i < Len; i++)
+   {
+      if (Src[i] != 0)
+      {
+         Dst[i] ^= GfExp[LogC + GfLog[Src[i]]];
+      }
+   }
+   
+} /* End TX_FEC_MulAdd() */
+
+
+/******************************************************************************
+** Function: TX_FEC_SelectKernel
+**
+*/
+bool TX_FEC_SelectKernel(uint8_t Kernel)
+{
+   
+   bool RetStatus = true;
+   
+   InitGf();
+   
+   switch (Kernel)
+   {
+      case TX_FEC_KERNEL_AUTO:
+         MulAddVec = AutoKernel();
+         break;
+      case TX_FEC_KERNEL_SCALAR:
+         MulAddVec = NULL;
+         break;
+#if defined(TX_FEC_NEON)
+      case TX_FEC_KERNEL_NEON:
+         MulAddVec = MulAddNeon;
+         break;
+#elif defined(TX_FEC_X86)
+      case TX_FEC_KERNEL_SSSE3:
+         RetStatus = __builtin_cpu_supports("ssse3");
+         if (RetStatus)
+         {
+            MulAddVec = MulAddSsse3;
+         }
+         break;
+      case TX_FEC_KERNEL_AVX2:
+         RetStatus = __builtin_cpu_supports("avx2");
+         if (RetStatus)
+         {
+            MulAddVec = MulAddAvx2;
+         }
+         break;
+#endif
+      default:
+         RetStatus = false;
+         break;
+   }
+   
+   return RetStatus;
+   
+} /* End TX_FEC_SelectKernel() */
+
+
+/******************************************************************************
+** Function: InitGf
+**
+** Build the GF(256) log tables and select the multiply-add kernel
+**
+*/
+static void InitGf(void)
+{
+   
+   uint16_t i;
+   uint16_t X = 1;
+   
+   if (GfInitialized)
+   {
+      return;
+   }
+   
+   for (i = 0; i < 255; i++)
+   {
+      GfExp[i] = (uint8_t)X;
+      GfLog[X] = (uint8_t)i;
+      X <<= 1;
+      if (X & 0x100)
+      {
+         X ^= GF_POLY;
+      }
+   }
+   for (i = 255; i < 512; i++)
+   {
+      GfExp[i] = GfExp[i - 255];
+   }
+   
+   MulAddVec = AutoKernel();
+   
+   GfInitialized = true;
+   
+} /* End InitGf() */
+
+
+/******************************************************************************
+** Function: AutoKernel
+**
+** Return the fastest multiply-add kernel the build and CPU support or NULL
+** for the scalar loop
+**
+*/
+static MulAddFunc_t AutoKernel(void)
+{
+   
+   MulAddFunc_t Kernel = NULL;
+   
+#if defined(TX_FEC_NEON)
+   Kernel = MulAddNeon;
+#elif defined(TX_FEC_X86)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+   {
+      Kernel = MulAddAvx2;
+   }
+   else if (__builtin_cpu_supports("ssse3"))
+   {
+      Kernel = MulAddSsse3;
+   }
+#endif
+   
+   return Kernel;
+   
+} /* End AutoKernel() */
+
+
+/******************************************************************************
+** Functions: GF(256) arithmetic
+**
+*/
+static uint8_t GfMul(uint8_t A, uint8_t B)
+{
+   return (A == 0 || B == 0) ? 0 : GfExp[GfLog[A] + GfLog[B]];
+}
+
+static uint8_t GfInv(uint8_t A)
+{
+   return GfExp[255 - GfLog[A]];
+}
+
+static uint8_t Coef(uint8_t ParityIdx, uint8_t DataIdx)
+{
+   return GfInv((uint8_t)((TX_FEC_PARITY | ParityIdx) ^ DataIdx));
+}
+
+
+/******************************************************************************
+** Function: InvertMatrix
+**
+** Gauss-Jordan inversion of an N x N row major matrix in place
+**
+*/
+static bool InvertMatrix(uint8_t *Mat, uint8_t N)
+{
+   
+   uint8_t Aug[TX_FEC_MAX_PARITY][2 * TX_FEC_MAX_PARITY];
+   uint8_t Row, Col, Pivot, Tmp, Scale;
+   
+   memset(Aug, 0, sizeof(Aug));
+   for (Row = 0; Row < N; Row++)
+   {
+      memcpy(Aug[Row], &Mat[Row * N], N);
+      Aug[Row][N + Row] = 1;
+   }
+   
+   for (Col = 0; Col < N; Col++)
+   {
+      
+      for (Pivot = Col; Pivot < N && Aug[Pivot][Col] == 0; Pivot++);
+      if (Pivot == N)
+      {
+         return false;
+      }
+      if (Pivot != Col)
+      {
+         for (Row = 0; Row < 2 * N; Row++)
+         {
+            Tmp = Aug[Col][Row];
+            Aug[Col][Row]   = Aug[Pivot][Row];
+            Aug[Pivot][Row] = Tmp;
+         }
+      }
+      
+      Scale = GfInv(Aug[Col][Col]);
+      for (Row = 0; Row < 2 * N; Row++)
+      {
+         Aug[Col][Row] = GfMul(Aug[Col][Row], Scale);
+      }
+      
+      for (Row = 0; Row < N; Row++)
+      {
+         if (Row != Col && Aug[Row][Col] != 0)
+         {
+            Scale = Aug[Row][Col];
+            for (Tmp = 0; Tmp < 2 * N; Tmp++)
+            {
+               Aug[Row][Tmp] ^= GfMul(Scale, Aug[Col][Tmp]);
+            }
+         }
+      }
+      
+   } /* End column loop */
+   
+   for (Row = 0; Row < N; Row++)
+   {
+      memcpy(&Mat[Row * N], &Aug[Row][N], N);
+   }
+   
+   return true;
+   
+} /* End InvertMatrix() */
+
+
+#if defined(TX_FEC_NEON)
+
+/******************************************************************************
+** Function: MulAddNeon
+**
+*/
+static uint16_t MulAddNeon(uint8_t *Dst, const uint8_t *Src, const uint8_t *Tbl, uint16_t Len)
+{
+   
+   uint16_t i;
+   uint8x16_t Mask = vdupq_n_u8(0x0F);
+#if defined(__aarch64__)
+   uint8x16_t TblLo = vld1q_u8(Tbl);
+   uint8x16_t TblHi = vld1q_u8(&Tbl[16]);
+#else
+   uint8x8x2_t TblLo = {{ vld1_u8(Tbl),      vld1_u8(&Tbl[8])  }};
+   uint8x8x2_t TblHi = {{ vld1_u8(&Tbl[16]), vld1_u8(&Tbl[24]) }};
+#endif
+   uint8x16_t S, Lo, Hi, Prod;
+   
+   for (i = 0; (i + 16) <= Len; i += 16)
+   {
+      S  = vld1q_u8(&Src[i]);
+      Lo = vandq_u8(S, Mask);
+      Hi = vshrq_n_u8(S, 4);
+#if defined(__aarch64__)
+      Prod = veorq_u8(vqtbl1q_u8(TblLo, Lo), vqtbl1q_u8(TblHi, Hi));
+#else
+      Prod = vcombine_u8(veor_u8(vtbl2_u8(TblLo, vget_low_u8(Lo)),  vtbl2_u8(TblHi, vget_low_u8(Hi))),
+                         veor_u8(vtbl2_u8(TblLo, vget_high_u8(Lo)), vtbl2_u8(TblHi, vget_high_u8(Hi))));
+#endif
+      vst1q_u8(&Dst[i], veorq_u8(vld1q_u8(&Dst[i]), Prod));
+   }
+   
+   return i;
+   
+} /* End MulAddNeon() */
+
+#elif defined(TX_FEC_X86)
+
+/******************************************************************************
+** Function: MulAddSsse3
+**
+*/
+__attribute__((target("ssse3")))
+static uint16_t MulAddSsse3(uint8_t *Dst, const uint8_t *Src, const uint8_t *Tbl, uint16_t Len)
+{
+   
+   uint16_t i;
+   __m128i Mask  = _mm_set1_epi8(0x0F);
+   __m128i TblLo = _mm_loadu_si128((const __m128i *)Tbl);
+   __m128i TblHi = _mm_loadu_si128((const __m128i *)&Tbl[16]);
+   __m128i S, Prod;
+   
+   for (i = 0; (i + 16) <= Len; i += 16)
+   {
+      S    = _mm_loadu_si128((const __m128i *)&Src[i]);
+      Prod = _mm_xor_si128(_mm_shuffle_epi8(TblLo, _mm_and_si128(S, Mask)),
+                           _mm_shuffle_epi8(TblHi, _mm_and_si128(_mm_srli_epi64(S, 4), Mask)));
+      _mm_storeu_si128((__m128i *)&Dst[i], _mm_xor_si128(_mm_loadu_si128((const __m128i *)&Dst[i]), Prod));
+   }
+   
+   return i;
+   
+} /* End MulAddSsse3() */
+
+
+/******************************************************************************
+** Function: MulAddAvx2
+**
+*/
+__attribute__((target("avx2")))
+static uint16_t MulAddAvx2(uint8_t *Dst, const uint8_t *Src, const uint8_t *Tbl, uint16_t Len)
+{
+   
+   uint16_t i;
+   __m256i Mask  = _mm256_set1_epi8(0x0F);
+   __m256i TblLo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)Tbl));
+   __m256i TblHi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&Tbl[16]));
+   __m256i S, Prod;
+   
+   for (i = 0; (i + 32) <= Len; i += 32)
+   {
+      S    = _mm256_loadu_si256((const __m256i *)&Src[i]);
+      Prod = _mm256_xor_si256(_mm256_shuffle_epi8(TblLo, _mm256_and_si256(S, Mask)),
+                              _mm256_shuffle_epi8(TblHi, _mm256_and_si256(_mm256_srli_epi64(S, 4), Mask)));
+      _mm256_storeu_si256((__m256i *)&Dst[i], _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&Dst[i]), Prod));
+   }
+   
+   if ((i + 16) <= Len)
+   {
+      i += MulAddSsse3(&Dst[i], &Src[i], Tbl, Len - i);
+   }
+   
+   return i;
+   
+} /* End MulAddAvx2() */
+
+#endif
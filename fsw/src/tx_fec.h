@@ -0,0 +1,224 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the transmit forward erasure coding class
+**
+**  Notes:
+**    1. Systematic Reed-Solomon erasure code over GF(256). Data packets
+**       are sent unchanged in groups of up to K packets and each group is
+**       followed by M parity packets. A receiver recovers a group from
+**       any K of its packets.
+**    2. Every packet starts with a header:
+**
+**         | Group (2, big endian) | Index | K |
+**
+**       Index is the data packet's position in the group or TX_FEC_PARITY
+**       plus the parity packet's number. A data packet's K is the
+**       configured group size and a parity packet's K is the number of
+**       data packets in its group, which is smaller for a transfer's last
+**       group.
+**    3. The code operates on symbols of the form | Len | Data | zero pad |
+**       where Len is the data packet's data length so recovered packets
+**       have their original length. A data packet only carries its data
+**       and a parity packet carries a complete parity symbol whose length
+**       is the group's longest symbol.
+**    4. Parity j is sum(C[j][i] * Symbol[i]) with the Cauchy matrix
+**       C[j][i] = 1/((TX_FEC_PARITY + j) XOR i) so any K rows of the
+**       systematic generator are invertible.
+**    5. Parity is accumulated as each data packet is encoded so the class
+**       only stores the M parity symbols. The GF(256) multiply-add uses
+**       NEON or SSSE3/AVX2 nibble table lookups when available.
+**    6. This header shouldn't include cFS header files so the encoder and
+**       decoder can be used by host tools.
+**
+*/
+
+#ifndef _tx_fec_
+#define _tx_fec_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_platform_cfg.h"
+#include "radio_tx.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_FEC_HDR_LEN       4
+#define TX_FEC_PARITY        0x80   /* Index flag for parity packets */
+
+#define TX_FEC_MAX_DATA      127
+#define TX_FEC_MAX_PARITY    LORA_TX_FEC_MAX_PARITY
+#define TX_FEC_MAX_SYM_LEN   (RADIO_TX_MAX_PAYLOAD_LEN - TX_FEC_HDR_LEN)
+
+#define TX_FEC_KERNEL_AUTO    0   /* Fastest kernel the build and CPU support */
+#define TX_FEC_KERNEL_SCALAR  1
+#define TX_FEC_KERNEL_SSSE3   2
+#define TX_FEC_KERNEL_AVX2    3
+#define TX_FEC_KERNEL_NEON    4
+
+#if (TX_FEC_MAX_PARITY > 127)
+   #error LORA_TX_FEC_MAX_PARITY exceeds the FEC parity index range
+#endif
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** TX_FEC_Class
+*/
+typedef struct
+{
+
+   uint8_t   K;               /* Data packets per group   */
+   uint8_t   M;               /* Parity packets per group */
+   uint16_t  DataMax;         /* Data bytes per packet    */
+   
+   uint16_t  Group;
+   uint8_t   DataCnt;
+   uint8_t   ParityCnt;       /* Parity packets sent in the group */
+   bool      ParityPending;
+   uint16_t  SymLen;          /* Group's longest symbol */
+   
+   /*
+   ** Statistics
+   */
+   
+   uint32_t  GroupCnt;
+   uint32_t  ParityPktCnt;
+   
+   uint8_t   Parity[TX_FEC_MAX_PARITY][TX_FEC_MAX_SYM_LEN];
+   
+} TX_FEC_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_FEC_Constructor
+**
+** Notes:
+**   1. Returns false if K, M or PktLen is out of range. PktLen is the
+**      maximum packet length including the FEC header.
+**
+*/
+bool TX_FEC_Constructor(TX_FEC_Class_t *TxFec, uint8_t K, uint8_t M, uint16_t PktLen);
+
+
+/******************************************************************************
+** Function: TX_FEC_Reset
+**
+** Start a new stream with group zero
+**
+*/
+void TX_FEC_Reset(TX_FEC_Class_t *TxFec);
+
+
+/******************************************************************************
+** Function: TX_FEC_EncodeData
+**
+** Add the FEC header to a data packet, accumulate its parity and return the
+** packet length
+**
+** Notes:
+**   1. The caller writes DataLen bytes, at most DataMax, to
+**      Pkt[TX_FEC_HDR_LEN] before the call.
+**   2. Completing a group sets ParityPending.
+**
+*/
+uint16_t TX_FEC_EncodeData(TX_FEC_Class_t *TxFec, uint8_t *Pkt, uint16_t DataLen);
+
+
+/******************************************************************************
+** Function: TX_FEC_EndGroup
+**
+** End a partially filled group at the end of a stream
+**
+** Notes:
+**   1. Returns true if the group has data and its parity is pending.
+**
+*/
+bool TX_FEC_EndGroup(TX_FEC_Class_t *TxFec);
+
+
+/******************************************************************************
+** Function: TX_FEC_NextParity
+**
+** Write the group's next parity packet to Pkt and return its length
+**
+** Notes:
+**   1. Must only be called while ParityPending is true. The group is
+**      closed after its last parity packet.
+**
+*/
+uint16_t TX_FEC_NextParity(TX_FEC_Class_t *TxFec, uint8_t *Pkt);
+
+
+/******************************************************************************
+** Function: TX_FEC_DecodeGroup
+**
+** Recover a group's missing data symbols and return true if successful
+**
+** Notes:
+**   1. Symbol[i] points to a SymLen byte buffer for data symbol i that the
+**      caller fills with | Len | Data | zero pad | when Present[i] is true.
+**      Missing symbols are written in place.
+**   2. Parity[n] points to the symbol of received parity packet number
+**      ParityIdx[n]. Parity buffers are overwritten.
+**   3. Fails if fewer parity symbols than missing data symbols were
+**      received.
+**
+*/
+bool TX_FEC_DecodeGroup(uint8_t K, uint16_t SymLen, uint8_t *Symbol[], const bool Present[],
+                        uint8_t *Parity[], const uint8_t ParityIdx[], uint8_t ParityCnt);
+
+
+/******************************************************************************
+** Function: TX_FEC_MulAdd
+**
+** Dst[n] ^= Coef * Src[n] over GF(256)
+**
+*/
+void TX_FEC_MulAdd(uint8_t *Dst, const uint8_t *Src, uint8_t Coef, uint16_t Len);
+
+
+/******************************************************************************
+** Function: TX_FEC_SelectKernel
+**
+** Select the GF(256) multiply-add kernel used by every FEC instance
+**
+** Notes:
+**   1. Returns false and leaves the kernel unchanged if the build or the
+**      CPU doesn't support Kernel.
+**   2. The kernel is selected automatically so this is only needed by
+**      host tests that compare the kernels.
+**
+*/
+bool TX_FEC_SelectKernel(uint8_t Kernel);
+
+
+#endif /* _tx_fec_ */
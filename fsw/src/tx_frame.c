@@ -0,0 +1,171 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the transmit frame packing class
+**
+**  Notes:
+**    1. See tx_frame.h for the frame layout.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_frame.h"
+
+
+/******************************************************************************
+** Function: TX_FRAME_Constructor
+**
+*/
+void TX_FRAME_Constructor(TX_FRAME_Class_t *TxFrame, uint8_t Type, uint16_t MaxLen)
+{
+   
+   memset(TxFrame, 0, sizeof(TX_FRAME_Class_t));
+   
+   TxFrame->Type   = Type;
+   TxFrame->MaxLen = (MaxLen > RADIO_TX_MAX_PAYLOAD_LEN) ? RADIO_TX_MAX_PAYLOAD_LEN : MaxLen;
+
+} /* End TX_FRAME_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_Open
+**
+*/
+void TX_FRAME_Open(TX_FRAME_Class_t *TxFrame, uint8_t *Buf, uint32_t Time)
+{
+   
+   TxFrame->Buf      = Buf;
+   TxFrame->Buf[0]   = TX_FRAME_HDR(TxFrame->Type);
+   TxFrame->Len      = TX_FRAME_HDR_LEN;
+   TxFrame->MsgCnt   = 0;
+   TxFrame->OpenTime = Time;
+   
+} /* End TX_FRAME_Open() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_MsgSpace
+**
+*/
+uint16_t TX_FRAME_MsgSpace(const TX_FRAME_Class_t *TxFrame)
+{
+   
+   uint16_t Space = 0;
+   
+   if (TxFrame->Len > 0 && (TxFrame->Len + TX_FRAME_MSG_HDR_LEN) < TxFrame->MaxLen)
+   {
+      Space = TxFrame->MaxLen - TxFrame->Len - TX_FRAME_MSG_HDR_LEN;
+   }
+   
+   return Space;
+   
+} /* End TX_FRAME_MsgSpace() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_MsgBuf
+**
+*/
+uint8_t *TX_FRAME_MsgBuf(const TX_FRAME_Class_t *TxFrame)
+{
+   
+   return &TxFrame->Buf[TxFrame->Len + TX_FRAME_MSG_HDR_LEN];
+   
+} /* End TX_FRAME_MsgBuf() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_CommitMsg
+**
+*/
+void TX_FRAME_CommitMsg(TX_FRAME_Class_t *TxFrame, uint16_t MsgLen)
+{
+   
+   TxFrame->Buf[TxFrame->Len] = (uint8_t)MsgLen;
+   TxFrame->Len += TX_FRAME_MSG_HDR_LEN + MsgLen;
+   TxFrame->MsgCnt++;
+   TxFrame->MsgTotal++;
+   
+} /* End TX_FRAME_CommitMsg() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_AddMsg
+**
+*/
+bool TX_FRAME_AddMsg(TX_FRAME_Class_t *TxFrame, const uint8_t *Msg, uint16_t MsgLen)
+{
+   
+   bool RetStatus = false;
+   
+   if (TxFrame->Len > 0 && MsgLen <= TX_FRAME_MsgSpace(TxFrame))
+   {
+      memcpy(TX_FRAME_MsgBuf(TxFrame), Msg, MsgLen);
+      TX_FRAME_CommitMsg(TxFrame, MsgLen);
+      RetStatus = true;
+   }
+   
+   return RetStatus;
+   
+} /* End TX_FRAME_AddMsg() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_IsOpen
+**
+*/
+bool TX_FRAME_IsOpen(const TX_FRAME_Class_t *TxFrame)
+{
+   
+   return (TxFrame->Len > 0);
+   
+} /* End TX_FRAME_IsOpen() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_Expired
+**
+** Notes:
+**   1. Unsigned subtraction handles time wraparound.
+**
+*/
+bool TX_FRAME_Expired(const TX_FRAME_Class_t *TxFrame, uint32_t Time, uint32_t Deadline)
+{
+   
+   return (TxFrame->Len > 0 && (Time - TxFrame->OpenTime) >= Deadline);
+   
+} /* End TX_FRAME_Expired() */
+
+
+/******************************************************************************
+** Function: TX_FRAME_Close
+**
+*/
+void TX_FRAME_Close(TX_FRAME_Class_t *TxFrame)
+{
+   
+   if (TxFrame->MsgCnt > 0)
+   {
+      TxFrame->FrameCnt++;
+   }
+   TxFrame->Len    = 0;
+   TxFrame->MsgCnt = 0;
+   TxFrame->Buf    = NULL;
+   
+} /* End TX_FRAME_Close() */
@@ -0,0 +1,205 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the transmit frame packing class
+**
+**  Notes:
+**    1. Packs several length prefixed messages into one radio payload so
+**       the LoRa preamble and header overhead is paid once per frame rather
+**       than once per message. Frame layout:
+**
+**         | FrameHdr | Len0 | Msg0 ... | Len1 | Msg1 ... | ...
+**
+**       FrameHdr bits 7-4 contain TX_FRAME_VERSION and bits 3-0 contain
+**       the frame type. Each LenN is one byte.
+**    2. A frame is open from the time the owner opens it until the owner
+**       flushes it. The owner flushes a frame when the next message doesn't
+**       fit or when the frame has been open longer than the flush deadline.
+**    3. The frame is built in a buffer supplied by the owner when the frame
+**       is opened, e.g. a transmit ring slot, so a packed frame doesn't have
+**       to be copied. A message can be written in place at TX_FRAME_MsgBuf()
+**       and committed or copied with TX_FRAME_AddMsg().
+**    4. This header shouldn't include cFS header files so the framer can be
+**       used by host tools.
+**
+*/
+
+#ifndef _tx_frame_
+#define _tx_frame_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "radio_tx.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_FRAME_VERSION      1
+#define TX_FRAME_HDR_LEN      1
+#define TX_FRAME_MSG_HDR_LEN  1
+#define TX_FRAME_MAX_MSG_LEN  (RADIO_TX_MAX_PAYLOAD_LEN - TX_FRAME_HDR_LEN - TX_FRAME_MSG_HDR_LEN)
+
+#define TX_FRAME_TYPE_SB_MSG     1   /* Complete software bus messages */
+#define TX_FRAME_TYPE_SB_MSG_HC  2   /* TX_HDRC header compressed messages */
+
+#define TX_FRAME_HDR(Type)    ((uint8_t)((TX_FRAME_VERSION << 4) | ((Type) & 0x0F)))
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** TX_FRAME_Class
+*/
+typedef struct
+{
+
+   uint8_t   Type;
+   uint16_t  MaxLen;
+   
+   /*
+   ** Open frame
+   */
+   
+   uint16_t  Len;        /* Zero when no frame is open */
+   uint16_t  MsgCnt;
+   uint32_t  OpenTime;   /* Owner defined time units   */
+   uint8_t  *Buf;        /* Owner's buffer, at least MaxLen bytes */
+   
+   /*
+   ** Statistics
+   */
+   
+   uint32_t  FrameCnt;
+   uint32_t  MsgTotal;
+   
+} TX_FRAME_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_FRAME_Constructor
+**
+** Notes:
+**   1. MaxLen is limited to RADIO_TX_MAX_PAYLOAD_LEN.
+**
+*/
+void TX_FRAME_Constructor(TX_FRAME_Class_t *TxFrame, uint8_t Type, uint16_t MaxLen);
+
+
+/******************************************************************************
+** Function: TX_FRAME_Open
+**
+** Open an empty frame in the owner's buffer
+**
+** Notes:
+**   1. Buf must hold MaxLen bytes and stay valid until the frame is closed.
+**
+*/
+void TX_FRAME_Open(TX_FRAME_Class_t *TxFrame, uint8_t *Buf, uint32_t Time);
+
+
+/******************************************************************************
+** Function: TX_FRAME_MsgSpace
+**
+** Return the longest message that fits in the open frame, zero if no frame
+** is open
+**
+*/
+uint16_t TX_FRAME_MsgSpace(const TX_FRAME_Class_t *TxFrame);
+
+
+/******************************************************************************
+** Function: TX_FRAME_MsgBuf
+**
+** Return where the next message's data is written in the open frame
+**
+** Notes:
+**   1. Up to TX_FRAME_MsgSpace() bytes can be written before the message is
+**      committed with TX_FRAME_CommitMsg().
+**
+*/
+uint8_t *TX_FRAME_MsgBuf(const TX_FRAME_Class_t *TxFrame);
+
+
+/******************************************************************************
+** Function: TX_FRAME_CommitMsg
+**
+** Add the MsgLen byte message written at TX_FRAME_MsgBuf() to the open frame
+**
+** Notes:
+**   1. MsgLen must not exceed TX_FRAME_MsgSpace().
+**
+*/
+void TX_FRAME_CommitMsg(TX_FRAME_Class_t *TxFrame, uint16_t MsgLen);
+
+
+/******************************************************************************
+** Function: TX_FRAME_AddMsg
+**
+** Copy a message into the open frame
+**
+** Notes:
+**   1. Returns false if no frame is open or the message doesn't fit. The
+**      owner should flush the frame, open a new one and add the message
+**      again.
+**   2. Messages longer than TX_FRAME_MAX_MSG_LEN never fit.
+**
+*/
+bool TX_FRAME_AddMsg(TX_FRAME_Class_t *TxFrame, const uint8_t *Msg, uint16_t MsgLen);
+
+
+/******************************************************************************
+** Function: TX_FRAME_IsOpen
+**
+*/
+bool TX_FRAME_IsOpen(const TX_FRAME_Class_t *TxFrame);
+
+
+/******************************************************************************
+** Function: TX_FRAME_Expired
+**
+** Return true if a frame is open and it has been open for at least Deadline
+**
+*/
+bool TX_FRAME_Expired(const TX_FRAME_Class_t *TxFrame, uint32_t Time, uint32_t Deadline);
+
+
+/******************************************************************************
+** Function: TX_FRAME_Close
+**
+** Close the open frame after the owner has consumed Buf and Len
+**
+** Notes:
+**   1. The frame no longer references the owner's buffer.
+**
+**
+*/
+void TX_FRAME_Close(TX_FRAME_Class_t *TxFrame);
+
+
+#endif /* _tx_frame_ */
@@ -0,0 +1,431 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the CCSDS telemetry header compression class
+**
+**  Notes:
+**    1. See tx_hdrc.h for the entry formats.
+**    2. CCSDS primary header fields are big endian:
+**         Bytes 0-1: Version(3) Type(1) SecHdr(1) APID(11)
+**         Bytes 2-3: SeqFlags(2) SeqCnt(14)
+**         Bytes 4-5: Packet data length - 1
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_hdrc.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define PRI_HDR_VER_TYPE_MASK  0xF8   /* Version, type and secondary header flag */
+#define PRI_HDR_TLM_SEC_HDR    0x08   /* Version 0, telemetry, secondary header  */
+
+#define SEQ_CNT_MASK   0x3FFF
+#define SEQ_FLAG_MASK  0xC0
+
+#define TIME_OFFSET    TX_HDRC_PRI_HDR_LEN
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static bool Compressible(const uint8_t *Msg, uint16_t MsgLen);
+static TX_HDRC_Ctx_t *FindCtx(TX_HDRC_Class_t *TxHdrc, uint16_t Apid, bool Create);
+static void UpdateCtx(TX_HDRC_Class_t *TxHdrc, TX_HDRC_Ctx_t *Ctx, const uint8_t *Msg);
+static uint16_t GetApid(const uint8_t *Msg);
+static uint16_t GetSeqCnt(const uint8_t *Msg);
+static uint32_t GetSeconds(const uint8_t *Msg);
+static uint16_t GetSubsecs(const uint8_t *Msg);
+
+
+/******************************************************************************
+** Function: TX_HDRC_Constructor
+**
+*/
+void TX_HDRC_Constructor(TX_HDRC_Class_t *TxHdrc, uint16_t RefreshInterval)
+{
+   
+   memset(TxHdrc, 0, sizeof(TX_HDRC_Class_t));
+   
+   TxHdrc->RefreshInterval = RefreshInterval;
+
+} /* End TX_HDRC_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_HDRC_Compress
+**
+** Notes:
+**   1. The sequence count and seconds deltas are computed relative to the
+**      last values sent for the APID so the decompressor's context matches
+**      the compressor's when no packets are lost.
+**
+*/
+uint16_t TX_HDRC_Compress(TX_HDRC_Class_t *TxHdrc, const uint8_t *Msg, uint16_t MsgLen,
+                          uint8_t *Entry, uint16_t EntryMax)
+{
+   
+   TX_HDRC_Ctx_t *Ctx = NULL;
+   uint16_t EntryLen  = 0;
+   bool     Compress  = false;
+   uint16_t Apid, SeqCnt, Subsecs, DataLen;
+   uint32_t Seconds;
+   int32_t  SeqDelta, SecDelta;
+   
+   if (TxHdrc->RefreshInterval > 0 && Compressible(Msg, MsgLen))
+   {
+      
+      Apid    = GetApid(Msg);
+      SeqCnt  = GetSeqCnt(Msg);
+      Seconds = GetSeconds(Msg);
+      Subsecs = GetSubsecs(Msg);
+      
+      Ctx = FindCtx(TxHdrc, Apid, true);
+      
+      if (Ctx->Valid && Ctx->SinceRefresh < TxHdrc->RefreshInterval)
+      {
+         
+         SeqDelta = (int32_t)((SeqCnt - Ctx->SeqCnt) & SEQ_CNT_MASK);
+         if (SeqDelta > (SEQ_CNT_MASK >> 1))
+         {
+            SeqDelta -= (SEQ_CNT_MASK + 1);
+         }
+         SecDelta = (int32_t)(Seconds - Ctx->Seconds);
+         
+         Compress = (Ctx->PriHdr[0] == Msg[0] &&
+                     (Ctx->PriHdr[2] & SEQ_FLAG_MASK) == (Msg[2] & SEQ_FLAG_MASK) &&
+                     memcmp(&Ctx->PriHdr[6], &Msg[6], TX_HDRC_PRI_HDR_LEN - 6) == 0 &&
+                     SeqDelta >= -128 && SeqDelta <= 127 &&
+                     SecDelta >= -128 && SecDelta <= 127);
+      }
+      
+      if (Compress)
+      {
+         
+         DataLen = MsgLen - TX_HDRC_HDR_LEN;
+         EntryLen = 4 + ((Subsecs == Ctx->RefSubsecs) ? 0 : 2) + DataLen;
+         
+         if (EntryLen <= EntryMax)
+         {
+            Entry[0] = (uint8_t)(Ctx->Epoch | ((Apid >> 8) & TX_HDRC_CTL_APID_HI));
+            Entry[1] = (uint8_t)(Apid & 0xFF);
+            Entry[2] = (uint8_t)(SeqCnt & 0xFF);
+            Entry[3] = (uint8_t)(Seconds & 0xFF);
+            if (Subsecs == Ctx->RefSubsecs)
+            {
+               Entry[0] |= TX_HDRC_CTL_SUBSECS;
+               memcpy(&Entry[4], &Msg[TX_HDRC_HDR_LEN], DataLen);
+            }
+            else
+            {
+               Entry[4] = (uint8_t)(Subsecs >> 8);
+               Entry[5] = (uint8_t)(Subsecs & 0xFF);
+               memcpy(&Entry[6], &Msg[TX_HDRC_HDR_LEN], DataLen);
+            }
+            UpdateCtx(TxHdrc, Ctx, Msg);
+            Ctx->SinceRefresh++;
+            TxHdrc->CompCnt++;
+            TxHdrc->BytesSaved += MsgLen - EntryLen;
+         }
+         else
+         {
+            EntryLen = 0;
+         }
+         
+         return EntryLen;
+      
+      } /* End if compress */
+      
+   } /* End if compressible */
+   
+   if ((MsgLen + 1) <= EntryMax)
+   {
+      if (Ctx != NULL)
+      {
+         UpdateCtx(TxHdrc, Ctx, Msg);
+         Ctx->Valid = true;
+         Ctx->SinceRefresh = 0;
+         Ctx->RefSubsecs   = Ctx->Subsecs;
+         Ctx->Epoch        = (uint8_t)((Ctx->Epoch + (1 << TX_HDRC_EPOCH_SHIFT)) & TX_HDRC_CTL_EPOCH);
+      }
+      Entry[0] = TX_HDRC_CTL_FULL | ((Ctx != NULL) ? Ctx->Epoch : 0);
+      memcpy(&Entry[1], Msg, MsgLen);
+      EntryLen = MsgLen + 1;
+      TxHdrc->FullCnt++;
+   }
+   
+   return EntryLen;
+   
+} /* End TX_HDRC_Compress() */
+
+
+/******************************************************************************
+** Function: TX_HDRC_Decompress
+**
+*/
+uint16_t TX_HDRC_Decompress(TX_HDRC_Class_t *TxHdrc, const uint8_t *Entry, uint16_t EntryLen,
+                            uint8_t *Msg, uint16_t MsgMax)
+{
+   
+   TX_HDRC_Ctx_t *Ctx;
+   uint16_t MsgLen = 0;
+   uint16_t HdrLen, Apid, SeqCnt, Subsecs;
+   uint32_t Seconds;
+   
+   if (EntryLen < 1)
+   {
+      return 0;
+   }
+   
+   if (Entry[0] & TX_HDRC_CTL_FULL)
+   {
+      
+      MsgLen = EntryLen - 1;
+      if (MsgLen <= MsgMax)
+      {
+         memcpy(Msg, &Entry[1], MsgLen);
+         if (Compressible(Msg, MsgLen))
+         {
+            Ctx = FindCtx(TxHdrc, GetApid(Msg), true);
+            UpdateCtx(TxHdrc, Ctx, Msg);
+            Ctx->Valid = true;
+            Ctx->RefSubsecs = Ctx->Subsecs;
+            Ctx->Epoch      = Entry[0] & TX_HDRC_CTL_EPOCH;
+         }
+      }
+      else
+      {
+         MsgLen = 0;
+      }
+      
+   }
+   else
+   {
+      
+      HdrLen = (Entry[0] & TX_HDRC_CTL_SUBSECS) ? 4 : 6;
+      Apid   = ((uint16_t)(Entry[0] & TX_HDRC_CTL_APID_HI) << 8) | Entry[1];
+      Ctx    = FindCtx(TxHdrc, Apid, false);
+      
+      if (Ctx != NULL && (Entry[0] & TX_HDRC_CTL_EPOCH) == Ctx->Epoch && EntryLen >= HdrLen &&
+          (EntryLen - HdrLen + TX_HDRC_HDR_LEN) <= MsgMax)
+      {
+         
+         MsgLen  = EntryLen - HdrLen + TX_HDRC_HDR_LEN;
+         SeqCnt  = (Ctx->SeqCnt + (int8_t)(Entry[2] - (uint8_t)Ctx->SeqCnt)) & SEQ_CNT_MASK;
+         Seconds = Ctx->Seconds + (int8_t)(Entry[3] - (uint8_t)Ctx->Seconds);
+         Subsecs = (HdrLen == 4) ? Ctx->RefSubsecs : (((uint16_t)Entry[4] << 8) | Entry[5]);
+         
+         memcpy(Msg, Ctx->PriHdr, TX_HDRC_PRI_HDR_LEN);
+         Msg[2] = (uint8_t)((Ctx->PriHdr[2] & SEQ_FLAG_MASK) | (SeqCnt >> 8));
+         Msg[3] = (uint8_t)(SeqCnt & 0xFF);
+         Msg[4] = (uint8_t)((MsgLen - 7) >> 8);
+         Msg[5] = (uint8_t)((MsgLen - 7) & 0xFF);
+         
+         Msg[TIME_OFFSET]   = (uint8_t)(Seconds >> 24);
+         Msg[TIME_OFFSET+1] = (uint8_t)(Seconds >> 16);
+         Msg[TIME_OFFSET+2] = (uint8_t)(Seconds >> 8);
+         Msg[TIME_OFFSET+3] = (uint8_t)(Seconds & 0xFF);
+         Msg[TIME_OFFSET+4] = (uint8_t)(Subsecs >> 8);
+         Msg[TIME_OFFSET+5] = (uint8_t)(Subsecs & 0xFF);
+         
+         memcpy(&Msg[TX_HDRC_HDR_LEN], &Entry[HdrLen], EntryLen - HdrLen);
+         
+         UpdateCtx(TxHdrc, Ctx, Msg);
+      }
+      
+   }
+   
+   return MsgLen;
+   
+} /* End TX_HDRC_Decompress() */
+
+
+/******************************************************************************
+** Function: TX_HDRC_EntryApid
+**
+*/
+uint16_t TX_HDRC_EntryApid(const uint8_t *Entry, uint16_t EntryLen)
+{
+   
+   uint16_t Apid = TX_HDRC_APID_NONE;
+   
+   if (EntryLen < 1)
+   {
+      return Apid;
+   }
+   
+   if (Entry[0] & TX_HDRC_CTL_FULL)
+   {
+      if (Compressible(&Entry[1], EntryLen - 1))
+      {
+         Apid = GetApid(&Entry[1]);
+      }
+   }
+   else if (EntryLen >= 2)
+   {
+      Apid = ((uint16_t)(Entry[0] & TX_HDRC_CTL_APID_HI) << 8) | Entry[1];
+   }
+   
+   return Apid;
+   
+} /* End TX_HDRC_EntryApid() */
+
+
+/******************************************************************************
+** Function: TX_HDRC_Invalidate
+**
+*/
+void TX_HDRC_Invalidate(TX_HDRC_Class_t *TxHdrc, uint16_t Apid)
+{
+   
+   TX_HDRC_Ctx_t *Ctx = FindCtx(TxHdrc, Apid, false);
+   
+   if (Ctx != NULL)
+   {
+      Ctx->SinceRefresh = TxHdrc->RefreshInterval;
+   }
+   
+} /* End TX_HDRC_Invalidate() */
+
+
+/******************************************************************************
+** Function: TX_HDRC_InvalidateAll
+**
+*/
+void TX_HDRC_InvalidateAll(TX_HDRC_Class_t *TxHdrc)
+{
+   
+   uint16_t i;
+   
+   for (i = 0; i < TX_HDRC_CTX_CNT; i++)
+   {
+      TxHdrc->Ctx[i].SinceRefresh = TxHdrc->RefreshInterval;
+   }
+   
+} /* End TX_HDRC_InvalidateAll() */
+
+
+/******************************************************************************
+** Function: Compressible
+**
+** Return true if a message is a version 0 telemetry packet with a secondary
+** header whose length field matches the message length
+**
+*/
+static bool Compressible(const uint8_t *Msg, uint16_t MsgLen)
+{
+   
+   return (MsgLen >= TX_HDRC_HDR_LEN &&
+           (Msg[0] & PRI_HDR_VER_TYPE_MASK) == PRI_HDR_TLM_SEC_HDR &&
+           (((uint16_t)Msg[4] << 8) | Msg[5]) == (MsgLen - 7));
+   
+} /* End Compressible() */
+
+
+/******************************************************************************
+** Function: FindCtx
+**
+** Notes:
+**   1. When Create is true and the APID doesn't have a context an unused or
+**      the least recently used context is assigned to the APID.
+**
+*/
+static TX_HDRC_Ctx_t *FindCtx(TX_HDRC_Class_t *TxHdrc, uint16_t Apid, bool Create)
+{
+   
+   TX_HDRC_Ctx_t *Ctx = NULL;
+   TX_HDRC_Ctx_t *Lru = NULL;
+   uint16_t i;
+   
+   for (i = 0; i < TX_HDRC_CTX_CNT; i++)
+   {
+      if (!TxHdrc->Ctx[i].Valid)
+      {
+         if (Lru == NULL || Lru->Valid)
+         {
+            Lru = &TxHdrc->Ctx[i];
+         }
+      }
+      else if (TxHdrc->Ctx[i].Apid == Apid)
+      {
+         Ctx = &TxHdrc->Ctx[i];
+         break;
+      }
+      else if (Lru == NULL || (Lru->Valid && TxHdrc->Ctx[i].LastUsed < Lru->LastUsed))
+      {
+         Lru = &TxHdrc->Ctx[i];
+      }
+   }
+   
+   if (Ctx == NULL && Create)
+   {
+      Ctx = Lru;
+      memset(Ctx, 0, sizeof(TX_HDRC_Ctx_t));
+      Ctx->Apid = Apid;
+   }
+   
+   return Ctx;
+   
+} /* End FindCtx() */
+
+
+/******************************************************************************
+** Function: UpdateCtx
+**
+*/
+static void UpdateCtx(TX_HDRC_Class_t *TxHdrc, TX_HDRC_Ctx_t *Ctx, const uint8_t *Msg)
+{
+   
+   memcpy(Ctx->PriHdr, Msg, TX_HDRC_PRI_HDR_LEN);
+   Ctx->SeqCnt   = GetSeqCnt(Msg);
+   Ctx->Seconds  = GetSeconds(Msg);
+   Ctx->Subsecs  = GetSubsecs(Msg);
+   Ctx->LastUsed = ++TxHdrc->UseCnt;
+   
+} /* End UpdateCtx() */
+
+
+/******************************************************************************
+** Functions: Header field accessors
+**
+*/
+static uint16_t GetApid(const uint8_t *Msg)
+{
+   return ((uint16_t)(Msg[0] & 0x07) << 8) | Msg[1];
+}
+
+static uint16_t GetSeqCnt(const uint8_t *Msg)
+{
+   return (((uint16_t)Msg[2] << 8) | Msg[3]) & SEQ_CNT_MASK;
+}
+
+static uint32_t GetSeconds(const uint8_t *Msg)
+{
+   return ((uint32_t)Msg[TIME_OFFSET] << 24) | ((uint32_t)Msg[TIME_OFFSET+1] << 16) |
+          ((uint32_t)Msg[TIME_OFFSET+2] << 8) | Msg[TIME_OFFSET+3];
+}
+
+static uint16_t GetSubsecs(const uint8_t *Msg)
+{
+   return ((uint16_t)Msg[TIME_OFFSET+4] << 8) | Msg[TIME_OFFSET+5];
+}
@@ -0,0 +1,207 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the CCSDS telemetry header compression class
+**
+**  Notes:
+**    1. Replaces a telemetry packet's CCSDS primary header and the cFE time
+**       at the start of its secondary header with a short header whose
+**       fields are relative to the previous packet with the same APID. Each
+**       APID has a context that holds the last values sent. A compressed entry has the form:
+**
+**         | Ctl | ApidLo | SeqLsb | SecLsb | [Subsecs (2)] | Data ... |
+**
+**       Ctl bit 7 (F) is clear, bit 6 (U) is set when the subseconds equal
+**       the value in the APID's last full entry and are omitted, bits 5-3
+**       contain the APID's refresh epoch and bits 2-0 contain APID bits
+**       10-8. The packet length is implied by the entry length. SeqLsb and
+**       SecLsb are the least significant bytes of the sequence count and
+**       seconds. The decompressor selects the value within -128..+127 of
+**       its context so it stays correct across lost compressed entries.
+**    2. A full entry has the form | Ctl | Message ... | with Ctl bit 7 set
+**       and bits 5-3 containing the refresh epoch. It establishes or
+**       refreshes the APID's context and advances the epoch. The
+**       decompressor drops compressed entries whose epoch doesn't match
+**       its context, so when a full entry is lost the APID's packets are
+**       dropped rather than restored with the previous full entry's header
+**       fields and subseconds. Eight consecutive lost full entries alias
+**       the 3 bit epoch.
+**       Full entries are sent for an APID's first packet, every
+**       RefreshInterval packets, when a field can't be expressed relative to
+**       the context and for packets that aren't telemetry with the mission's
+**       header layout.
+**    3. The same class is used by a receiver to decompress entries so host
+**       tools can verify the encoding.
+**    4. This header shouldn't include cFS header files so the compressor
+**       can be used by host tools.
+**
+*/
+
+#ifndef _tx_hdrc_
+#define _tx_hdrc_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_mission_cfg.h"
+#include "lora_tx_platform_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_HDRC_CTX_CNT       LORA_TX_HDRC_CTX_CNT
+#define TX_HDRC_PRI_HDR_LEN   LORA_TX_TLM_PRI_HDR_LEN
+#define TX_HDRC_TIME_LEN      6
+#define TX_HDRC_HDR_LEN       (TX_HDRC_PRI_HDR_LEN + TX_HDRC_TIME_LEN)
+
+#define TX_HDRC_CTL_FULL      0x80
+#define TX_HDRC_CTL_SUBSECS   0x40   /* Subseconds equal the reference */
+#define TX_HDRC_CTL_EPOCH     0x38   /* Refresh epoch */
+#define TX_HDRC_CTL_APID_HI   0x07
+
+#define TX_HDRC_EPOCH_SHIFT   3
+
+#define TX_HDRC_APID_NONE     0xFFFF  /* Entry doesn't use an APID context */
+
+#define TX_HDRC_COMP_HDR_LEN  6      /* Longest compressed header */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef struct
+{
+   
+   bool      Valid;
+   uint16_t  Apid;
+   uint32_t  LastUsed;
+   uint16_t  SinceRefresh;
+   
+   uint8_t   PriHdr[TX_HDRC_PRI_HDR_LEN];  /* Last primary header */
+   uint16_t  SeqCnt;
+   uint32_t  Seconds;
+   uint16_t  Subsecs;
+   uint16_t  RefSubsecs;   /* Subseconds in the last full entry */
+   uint8_t   Epoch;        /* Ctl epoch bits of the last full entry */
+   
+} TX_HDRC_Ctx_t;
+
+
+/******************************************************************************
+** TX_HDRC_Class
+*/
+typedef struct
+{
+
+   uint16_t  RefreshInterval;
+   uint32_t  UseCnt;
+   
+   /*
+   ** Statistics
+   */
+   
+   uint32_t  FullCnt;
+   uint32_t  CompCnt;
+   uint32_t  BytesSaved;
+   
+   TX_HDRC_Ctx_t Ctx[TX_HDRC_CTX_CNT];
+   
+} TX_HDRC_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_HDRC_Constructor
+**
+** Notes:
+**   1. RefreshInterval is the maximum number of compressed packets sent for
+**      an APID between full headers. Zero disables compression.
+**
+*/
+void TX_HDRC_Constructor(TX_HDRC_Class_t *TxHdrc, uint16_t RefreshInterval);
+
+
+/******************************************************************************
+** Function: TX_HDRC_Compress
+**
+** Write a message's compressed entry to Entry and return the entry length
+**
+** Notes:
+**   1. Returns zero if the entry doesn't fit in EntryMax bytes.
+**
+*/
+uint16_t TX_HDRC_Compress(TX_HDRC_Class_t *TxHdrc, const uint8_t *Msg, uint16_t MsgLen,
+                          uint8_t *Entry, uint16_t EntryMax);
+
+
+/******************************************************************************
+** Function: TX_HDRC_Decompress
+**
+** Restore the message in Entry to Msg and return the message length
+**
+** Notes:
+**   1. Returns zero if the entry is malformed, the message doesn't fit in
+**      MsgMax bytes or there's no context for a compressed entry's APID or
+**      its epoch doesn't match the context's.
+**
+*/
+uint16_t TX_HDRC_Decompress(TX_HDRC_Class_t *TxHdrc, const uint8_t *Entry, uint16_t EntryLen,
+                            uint8_t *Msg, uint16_t MsgMax);
+
+
+/******************************************************************************
+** Function: TX_HDRC_EntryApid
+**
+** Return the APID whose context an entry uses, TX_HDRC_APID_NONE if it
+** doesn't use a context
+**
+*/
+uint16_t TX_HDRC_EntryApid(const uint8_t *Entry, uint16_t EntryLen);
+
+
+/******************************************************************************
+** Function: TX_HDRC_Invalidate
+**
+** Send the APID's next packet as a full entry
+**
+** Notes:
+**   1. Used when entries that were compressed are discarded before they're
+**      sent so the decompressor's context no longer matches.
+**
+*/
+void TX_HDRC_Invalidate(TX_HDRC_Class_t *TxHdrc, uint16_t Apid);
+
+
+/******************************************************************************
+** Function: TX_HDRC_InvalidateAll
+**
+** Send every APID's next packet as a full entry
+**
+*/
+void TX_HDRC_InvalidateAll(TX_HDRC_Class_t *TxHdrc);
+
+
+#endif /* _tx_hdrc_ */
@@ -0,0 +1,147 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the latency histogram class
+**
+**  Notes:
+**    1. See tx_hist.h for the bucket layout.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_hist.h"
+
+
+/******************************************************************************
+** Function: TX_HIST_Constructor
+**
+*/
+void TX_HIST_Constructor(TX_HIST_Class_t *TxHist)
+{
+   
+   memset(TxHist, 0, sizeof(TX_HIST_Class_t));
+   
+} /* End TX_HIST_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_HIST_Add
+**
+*/
+void TX_HIST_Add(TX_HIST_Class_t *TxHist, uint32_t LatencyUs)
+{
+   
+   uint32_t i = 0;
+   
+   if (LatencyUs > 1)
+   {
+      i = 31 - __builtin_clz(LatencyUs);
+      if (i >= TX_HIST_BUCKET_CNT)
+      {
+         i = TX_HIST_BUCKET_CNT - 1;
+      }
+   }
+   
+   TxHist->Bucket[i]++;
+   TxHist->Cnt++;
+   TxHist->SumUs += LatencyUs;
+   if (LatencyUs > TxHist->MaxUs)
+   {
+      TxHist->MaxUs = LatencyUs;
+   }
+   
+} /* End TX_HIST_Add() */
+
+
+/******************************************************************************
+** Function: TX_HIST_Merge
+**
+*/
+void TX_HIST_Merge(TX_HIST_Class_t *TxHist, const TX_HIST_Class_t *Src)
+{
+   
+   uint32_t i;
+   
+   for (i = 0; i < TX_HIST_BUCKET_CNT; i++)
+   {
+      TxHist->Bucket[i] += Src->Bucket[i];
+   }
+   TxHist->Cnt   += Src->Cnt;
+   TxHist->SumUs += Src->SumUs;
+   if (Src->MaxUs > TxHist->MaxUs)
+   {
+      TxHist->MaxUs = Src->MaxUs;
+   }
+   
+} /* End TX_HIST_Merge() */
+
+
+/******************************************************************************
+** Function: TX_HIST_MeanUs
+**
+*/
+uint32_t TX_HIST_MeanUs(const TX_HIST_Class_t *TxHist)
+{
+   
+   return (TxHist->Cnt > 0) ? (uint32_t)(TxHist->SumUs / TxHist->Cnt) : 0;
+   
+} /* End TX_HIST_MeanUs() */
+
+
+/******************************************************************************
+** Function: TX_HIST_PercentileUs
+**
+*/
+uint32_t TX_HIST_PercentileUs(const TX_HIST_Class_t *TxHist, uint8_t Pct)
+{
+   
+   uint64_t Rank;
+   uint64_t Sum = 0;
+   uint32_t UpperUs;
+   uint32_t i;
+   
+   if (TxHist->Cnt == 0)
+   {
+      return 0;
+   }
+   
+   Rank = ((uint64_t)TxHist->Cnt * Pct + 99) / 100;
+   if (Rank == 0)
+   {
+      Rank = 1;
+   }
+   
+   for (i = 0; i < TX_HIST_BUCKET_CNT - 1; i++)
+   {
+      Sum += TxHist->Bucket[i];
+      if (Sum >= Rank)
+      {
+         break;
+      }
+   }
+   
+   UpperUs = (i < 31) ? ((2u << i) - 1) : UINT32_MAX;
+   if (i == TX_HIST_BUCKET_CNT - 1 || UpperUs > TxHist->MaxUs)
+   {
+      UpperUs = TxHist->MaxUs;
+   }
+   
+   return UpperUs;
+   
+} /* End TX_HIST_PercentileUs() */
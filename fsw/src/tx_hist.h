@@ -0,0 +1,122 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the latency histogram class
+**
+**  Notes:
+**    1. Fixed log2 buckets of microseconds. Bucket i counts latencies from
+**       2^i to 2^(i+1)-1 us, bucket 0 also counts 0 us and the last bucket
+**       counts everything above its lower bound. Adding a sample is a few
+**       instructions so it can be done on every packet.
+**    2. Percentiles are reported as the upper bound of the bucket holding
+**       the percentile, limited to the maximum sample, so they're within a
+**       factor of two of the exact value.
+**    3. This header shouldn't include cFS header files so the histogram can
+**       be used by host tools.
+**
+*/
+
+#ifndef _tx_hist_
+#define _tx_hist_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_platform_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_HIST_BUCKET_CNT  LORA_TX_HIST_BUCKET_CNT
+
+#if (TX_HIST_BUCKET_CNT < 2 || TX_HIST_BUCKET_CNT > 32)
+   #error LORA_TX_HIST_BUCKET_CNT must be 2..32
+#endif
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** TX_HIST_Class
+*/
+typedef struct
+{
+
+   uint32_t  Cnt;
+   uint64_t  SumUs;
+   uint32_t  MaxUs;
+   uint32_t  Bucket[TX_HIST_BUCKET_CNT];
+   
+} TX_HIST_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_HIST_Constructor
+**
+*/
+void TX_HIST_Constructor(TX_HIST_Class_t *TxHist);
+
+
+/******************************************************************************
+** Function: TX_HIST_Add
+**
+** Add a latency sample in us
+**
+*/
+void TX_HIST_Add(TX_HIST_Class_t *TxHist, uint32_t LatencyUs);
+
+
+/******************************************************************************
+** Function: TX_HIST_Merge
+**
+** Add the samples of Src to TxHist
+**
+*/
+void TX_HIST_Merge(TX_HIST_Class_t *TxHist, const TX_HIST_Class_t *Src);
+
+
+/******************************************************************************
+** Function: TX_HIST_MeanUs
+**
+*/
+uint32_t TX_HIST_MeanUs(const TX_HIST_Class_t *TxHist);
+
+
+/******************************************************************************
+** Function: TX_HIST_PercentileUs
+**
+** Return the bucket upper bound of the Pct percentile sample
+**
+** Notes:
+**   1. Returns zero when the histogram is empty.
+**
+*/
+uint32_t TX_HIST_PercentileUs(const TX_HIST_Class_t *TxHist, uint8_t Pct);
+
+
+#endif /* _tx_hist_ */
@@ -0,0 +1,164 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the frequency hopping class
+**
+**  Notes:
+**    1. See tx_hop.h for the hopping behavior.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "tx_hop.h"
+
+
+/******************************************************************************
+** Function: TX_HOP_Constructor
+**
+*/
+void TX_HOP_Constructor(TX_HOP_Class_t *TxHop, uint16_t PktsPerHop)
+{
+   
+   memset(TxHop, 0, sizeof(TX_HOP_Class_t));
+   
+   TxHop->PktsPerHop = (PktsPerHop > 0) ? PktsPerHop : 1;
+
+} /* End TX_HOP_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_HOP_LoadChannels
+**
+*/
+uint8_t TX_HOP_LoadChannels(TX_HOP_Class_t *TxHop, const char *ChannelStr)
+{
+   
+   const char *Str = ChannelStr;
+   char *EndPtr;
+   unsigned long Frequency;
+   
+   TxHop->ChanCnt = 0;
+   
+   while (*Str != '\0')
+   {
+      
+      if (*Str == ',' || *Str == ' ')
+      {
+         Str++;
+         continue;
+      }
+      
+      Frequency = strtoul(Str, &EndPtr, 0);
+      if (EndPtr == Str || TxHop->ChanCnt >= TX_HOP_MAX_CHANNELS ||
+          Frequency < TX_HOP_FREQ_MIN || Frequency > TX_HOP_FREQ_MAX)
+      {
+         TxHop->ChanCnt = 0;
+         break;
+      }
+      Str = EndPtr;
+      
+      TxHop->FreqHz[TxHop->ChanCnt]  = (uint32_t)Frequency;
+      TxHop->FreqReg[TxHop->ChanCnt] = TX_HOP_FreqReg((uint32_t)Frequency);
+      TxHop->ChanCnt++;
+      
+   } /* End while channels */
+   
+   TX_HOP_Restart(TxHop);
+   
+   return TxHop->ChanCnt;
+   
+} /* End TX_HOP_LoadChannels() */
+
+
+/******************************************************************************
+** Function: TX_HOP_FreqReg
+**
+** Notes:
+**   1. Rounds to the nearest 198.36Hz frequency step.
+**
+*/
+uint32_t TX_HOP_FreqReg(uint32_t Frequency)
+{
+   
+   return (uint32_t)((((uint64_t)Frequency << 18) + (TX_HOP_XTAL_FREQ / 2)) / TX_HOP_XTAL_FREQ);
+   
+} /* End TX_HOP_FreqReg() */
+
+
+/******************************************************************************
+** Function: TX_HOP_SetFirst
+**
+*/
+void TX_HOP_SetFirst(TX_HOP_Class_t *TxHop, uint8_t First)
+{
+   
+   TxHop->First = (TxHop->ChanCnt > 0) ? (First % TxHop->ChanCnt) : 0;
+   TX_HOP_Restart(TxHop);
+   
+} /* End TX_HOP_SetFirst() */
+
+
+/******************************************************************************
+** Function: TX_HOP_Restart
+**
+** Notes:
+**   1. Cur is left on the channel before First because TX_HOP_Next()
+**      advances before the first packet.
+**
+*/
+void TX_HOP_Restart(TX_HOP_Class_t *TxHop)
+{
+   
+   if (TxHop->First >= TxHop->ChanCnt)
+   {
+      TxHop->First = 0;
+   }
+   TxHop->Cur    = (TxHop->First > 0) ? TxHop->First - 1 : ((TxHop->ChanCnt > 0) ? TxHop->ChanCnt - 1 : 0);
+   TxHop->PktCnt = 0;
+   
+} /* End TX_HOP_Restart() */
+
+
+/******************************************************************************
+** Function: TX_HOP_Next
+**
+*/
+bool TX_HOP_Next(TX_HOP_Class_t *TxHop)
+{
+   
+   bool Hop = false;
+   
+   if (!TxHop->Enabled || TxHop->ChanCnt == 0)
+   {
+      return false;
+   }
+   
+   if (TxHop->PktCnt == 0)
+   {
+      TxHop->Cur    = (TxHop->Cur + 1 < TxHop->ChanCnt) ? TxHop->Cur + 1 : 0;
+      TxHop->PktCnt = TxHop->PktsPerHop;
+      TxHop->HopCnt++;
+      Hop = true;
+   }
+   TxHop->PktCnt--;
+   
+   return Hop;
+   
+} /* End TX_HOP_Next() */
@@ -0,0 +1,153 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the frequency hopping class
+**
+**  Notes:
+**    1. Steps through a channel table in table order, hopping to the next
+**       channel every PktsPerHop packets. The table order is the hop
+**       pattern so a pseudo-random pattern is defined by the table.
+**    2. Channels are loaded in Hz and each channel's SX128x RF frequency
+**       register value is computed when the table is loaded so a hop is a
+**       single SetRfFrequency command write.
+**    3. This header shouldn't include cFS header files so the hop table can
+**       be used by host tools.
+**
+*/
+
+#ifndef _tx_hop_
+#define _tx_hop_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_platform_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_HOP_MAX_CHANNELS  LORA_TX_HOP_MAX_CHANNELS
+
+#define TX_HOP_FREQ_MIN   2400000000UL   /* Hz, SX128x band */
+#define TX_HOP_FREQ_MAX   2500000000UL
+
+#define TX_HOP_XTAL_FREQ  52000000UL     /* Hz, SX128x RF frequency step is XTAL/2^18 */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** TX_HOP_Class
+*/
+typedef struct
+{
+
+   bool      Enabled;
+   uint16_t  PktsPerHop;
+   
+   uint8_t   ChanCnt;
+   uint32_t  FreqHz[TX_HOP_MAX_CHANNELS];
+   uint32_t  FreqReg[TX_HOP_MAX_CHANNELS];
+   
+   uint8_t   First;      /* Channel used after a restart */
+   uint8_t   Cur;
+   uint16_t  PktCnt;     /* Packets remaining on the current channel */
+   
+   uint32_t  HopCnt;
+   
+} TX_HOP_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_HOP_Constructor
+**
+** Notes:
+**   1. Hopping is disabled and the table is empty until channels are
+**      loaded.
+**
+*/
+void TX_HOP_Constructor(TX_HOP_Class_t *TxHop, uint16_t PktsPerHop);
+
+
+/******************************************************************************
+** Function: TX_HOP_LoadChannels
+**
+** Load the channel table from a string and return the number of channels
+**
+** Notes:
+**   1. ChannelStr is a comma or space separated list of frequencies in Hz.
+**   2. Returns zero and clears the table if an entry is malformed, outside
+**      the SX128x band or the list has too many entries.
+**
+*/
+uint8_t TX_HOP_LoadChannels(TX_HOP_Class_t *TxHop, const char *ChannelStr);
+
+
+/******************************************************************************
+** Function: TX_HOP_FreqReg
+**
+** Return the SX128x RF frequency register value for a frequency (Hz)
+**
+*/
+uint32_t TX_HOP_FreqReg(uint32_t Frequency);
+
+
+/******************************************************************************
+** Function: TX_HOP_SetFirst
+**
+** Set the channel that a restart hops to
+**
+** Notes:
+**   1. Radios that share a channel table start on different channels so
+**      they follow the same sequence without transmitting on the same
+**      channel. The channel wraps to the table size.
+**
+*/
+void TX_HOP_SetFirst(TX_HOP_Class_t *TxHop, uint8_t First);
+
+
+/******************************************************************************
+** Function: TX_HOP_Restart
+**
+** Hop to the first channel before the next packet
+**
+*/
+void TX_HOP_Restart(TX_HOP_Class_t *TxHop);
+
+
+/******************************************************************************
+** Function: TX_HOP_Next
+**
+** Account for the next packet and return true if the radio must hop to
+** channel Cur before it's sent
+**
+*/
+bool TX_HOP_Next(TX_HOP_Class_t *TxHop);
+
+
+#endif /* _tx_hop_ */
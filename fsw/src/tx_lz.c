@@ -0,0 +1,227 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the transmit block LZ compression class
+**
+**  Notes:
+**    1. See tx_lz.h for the block format.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_lz.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define HASH_EMPTY  0xFFFF
+
+#define HASH(p) ((uint16_t)((((uint32_t)(p)[0] << 16) | ((uint32_t)(p)[1] << 8) | (p)[2]) * 2654435761u >> (32 - TX_LZ_HASH_BITS)))
+
+
+/******************************************************************************
+** Function: TX_LZ_Constructor
+**
+*/
+void TX_LZ_Constructor(TX_LZ_Class_t *TxLz)
+{
+   
+   memset(TxLz, 0, sizeof(TX_LZ_Class_t));
+
+} /* End TX_LZ_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_LZ_CompressBlock
+**
+** Notes:
+**   1. Greedy parse. Room for a new flag byte and the longest item is
+**      reserved before each item so the block never overflows.
+**
+*/
+uint16_t TX_LZ_CompressBlock(TX_LZ_Class_t *TxLz, const uint8_t *In, uint16_t InLen,
+                             uint8_t *Out, uint16_t OutMax, uint16_t *InUsed)
+{
+   
+   uint16_t InIdx   = 0;
+   uint16_t OutLen  = 1;
+   uint16_t FlagIdx = 0;
+   uint8_t  ItemCnt = 8;
+   uint16_t RawLen  = (InLen < (OutMax - 1)) ? InLen : (OutMax - 1);
+   uint16_t Cand, MatchLen, MatchMax, Offset, Hash;
+   
+   memset(TxLz->Head, 0xFF, sizeof(TxLz->Head));
+   
+   Out[0] = TX_LZ_BLOCK_LZ;
+   
+   while (InIdx < InLen)
+   {
+      
+      if ((OutLen + 2 + (ItemCnt == 8 ? 1 : 0)) > OutMax)
+      {
+         break;
+      }
+      if (ItemCnt == 8)
+      {
+         FlagIdx = OutLen++;
+         Out[FlagIdx] = 0;
+         ItemCnt = 0;
+      }
+      
+      MatchLen = 0;
+      if ((InIdx + TX_LZ_MATCH_MIN) <= InLen)
+      {
+         Hash = HASH(&In[InIdx]);
+         Cand = TxLz->Head[Hash];
+         TxLz->Head[Hash] = InIdx;
+         if (Cand != HASH_EMPTY)
+         {
+            MatchMax = InLen - InIdx;
+            if (MatchMax > TX_LZ_MATCH_MAX)
+            {
+               MatchMax = TX_LZ_MATCH_MAX;
+            }
+            while (MatchLen < MatchMax && In[Cand + MatchLen] == In[InIdx + MatchLen])
+            {
+               MatchLen++;
+            }
+         }
+      }
+      
+      if (MatchLen >= TX_LZ_MATCH_MIN)
+      {
+         Offset = InIdx - Cand - 1;
+         Out[OutLen++] = (uint8_t)(Offset >> 4);
+         Out[OutLen++] = (uint8_t)(((Offset & 0x0F) << 4) | (MatchLen - TX_LZ_MATCH_MIN));
+         Out[FlagIdx] |= (uint8_t)(1 << ItemCnt);
+         InIdx++;
+         for (--MatchLen; MatchLen > 0; MatchLen--, InIdx++)
+         {
+            if ((InIdx + TX_LZ_MATCH_MIN) <= InLen)
+            {
+               TxLz->Head[HASH(&In[InIdx])] = InIdx;
+            }
+         }
+      }
+      else
+      {
+         Out[OutLen++] = In[InIdx++];
+      }
+      ItemCnt++;
+      
+   } /* End while input */
+   
+   if (InIdx < RawLen || (InIdx == RawLen && OutLen > RawLen))
+   {
+      Out[0] = TX_LZ_BLOCK_RAW;
+      memcpy(&Out[1], In, RawLen);
+      OutLen = RawLen + 1;
+      InIdx  = RawLen;
+      TxLz->RawBlkCnt++;
+   }
+   else
+   {
+      TxLz->LzBlkCnt++;
+   }
+   
+   *InUsed = InIdx;
+   
+   return OutLen;
+   
+} /* End TX_LZ_CompressBlock() */
+
+
+/******************************************************************************
+** Function: TX_LZ_DecompressBlock
+**
+*/
+uint16_t TX_LZ_DecompressBlock(const uint8_t *In, uint16_t InLen, uint8_t *Out, uint16_t OutMax)
+{
+   
+   uint16_t InIdx  = 1;
+   uint16_t OutLen = 0;
+   uint8_t  Flags  = 0;
+   uint8_t  ItemCnt = 8;
+   uint16_t Offset, MatchLen;
+   
+   if (InLen < 1)
+   {
+      return 0;
+   }
+   
+   if (In[0] == TX_LZ_BLOCK_RAW)
+   {
+      OutLen = InLen - 1;
+      if (OutLen > OutMax)
+      {
+         return 0;
+      }
+      memcpy(Out, &In[1], OutLen);
+      return OutLen;
+   }
+   else if (In[0] != TX_LZ_BLOCK_LZ)
+   {
+      return 0;
+   }
+   
+   while (InIdx < InLen)
+   {
+      
+      if (ItemCnt == 8)
+      {
+         Flags = In[InIdx++];
+         ItemCnt = 0;
+         continue;
+      }
+      
+      if (Flags & (1 << ItemCnt))
+      {
+         if ((InIdx + 2) > InLen)
+         {
+            return 0;
+         }
+         Offset   = (((uint16_t)In[InIdx] << 4) | (In[InIdx+1] >> 4)) + 1;
+         MatchLen = (In[InIdx+1] & 0x0F) + TX_LZ_MATCH_MIN;
+         InIdx += 2;
+         if (Offset > OutLen || (OutLen + MatchLen) > OutMax)
+         {
+            return 0;
+         }
+         for (; MatchLen > 0; MatchLen--, OutLen++)
+         {
+            Out[OutLen] = Out[OutLen - Offset];
+         }
+      }
+      else
+      {
+         if (OutLen >= OutMax)
+         {
+            return 0;
+         }
+         Out[OutLen++] = In[InIdx++];
+      }
+      ItemCnt++;
+      
+   } /* End while block */
+   
+   return OutLen;
+   
+} /* End TX_LZ_DecompressBlock() */
@@ -0,0 +1,141 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the transmit block LZ compression class
+**
+**  Notes:
+**    1. Compresses a stream into independently decodable blocks so a lost
+**       packet only loses its own data. The caller keeps up to
+**       TX_LZ_WINDOW_LEN bytes of input buffered and each call compresses
+**       as much of the input as fits in one output block. The window is
+**       the block's own input so matches never reference another block.
+**    2. A block has the form | Type | Body |. A TX_LZ_BLOCK_RAW body is
+**       the input verbatim. A TX_LZ_BLOCK_LZ body is a sequence of groups
+**       with a flag byte followed by eight items. Flag bit n, starting
+**       with the least significant bit, is set when item n is a match and
+**       clear when it's a literal byte. A match is two bytes:
+**
+**         | Offset-1 bits 11-4 | Offset-1 bits 3-0, Length-3 (4 bits) |
+**
+**       so matches are 3 to 18 bytes long. The body ends at the end of the
+**       block.
+**    3. A raw block is sent whenever the LZ block would carry fewer input
+**       bytes than a raw block so incompressible data costs one byte per
+**       block.
+**    4. The match finder uses a single entry hash table in the class so
+**       compression uses no heap and little stack.
+**    5. This header shouldn't include cFS header files so the compressor
+**       can be used by host tools.
+**
+*/
+
+#ifndef _tx_lz_
+#define _tx_lz_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_platform_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_LZ_WINDOW_LEN   LORA_TX_LZ_WINDOW_LEN
+
+#define TX_LZ_HASH_BITS    8
+#define TX_LZ_HASH_CNT     (1 << TX_LZ_HASH_BITS)
+
+#define TX_LZ_MATCH_MIN    3
+#define TX_LZ_MATCH_MAX    18
+#define TX_LZ_OFFSET_MAX   4096
+
+#define TX_LZ_BLOCK_RAW    0
+#define TX_LZ_BLOCK_LZ     1
+
+#if (TX_LZ_WINDOW_LEN > TX_LZ_OFFSET_MAX)
+   #error LORA_TX_LZ_WINDOW_LEN exceeds the LZ match offset range
+#endif
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** TX_LZ_Class
+*/
+typedef struct
+{
+
+   uint16_t  Head[TX_LZ_HASH_CNT];   /* Last input index with each hash */
+   
+   /*
+   ** Statistics
+   */
+   
+   uint32_t  LzBlkCnt;
+   uint32_t  RawBlkCnt;
+   
+} TX_LZ_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_LZ_Constructor
+**
+*/
+void TX_LZ_Constructor(TX_LZ_Class_t *TxLz);
+
+
+/******************************************************************************
+** Function: TX_LZ_CompressBlock
+**
+** Compress a prefix of In into a block and return the block length
+**
+** Notes:
+**   1. InUsed returns the number of input bytes in the block. The caller
+**      discards them from its input buffer before the next call.
+**   2. InLen must not exceed TX_LZ_WINDOW_LEN and OutMax must be at least
+**      two bytes.
+**
+*/
+uint16_t TX_LZ_CompressBlock(TX_LZ_Class_t *TxLz, const uint8_t *In, uint16_t InLen,
+                             uint8_t *Out, uint16_t OutMax, uint16_t *InUsed);
+
+
+/******************************************************************************
+** Function: TX_LZ_DecompressBlock
+**
+** Restore a block's input to Out and return its length
+**
+** Notes:
+**   1. Returns zero if the block is malformed or the input doesn't fit in
+**      OutMax bytes.
+**
+*/
+uint16_t TX_LZ_DecompressBlock(const uint8_t *In, uint16_t InLen, uint8_t *Out, uint16_t OutMax);
+
+
+#endif /* _tx_lz_ */
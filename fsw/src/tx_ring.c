@@ -0,0 +1,227 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the transmit ring class
+**
+**  Notes:
+**    1. See tx_ring.h for the producer/consumer ownership rules.
+**    2. Head and Tail are free running counters. Unsigned wraparound keeps
+**       Head - Tail correct when the counters roll over.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_ring.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p,v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+
+/******************************************************************************
+** Function: TX_RING_Constructor
+**
+*/
+void TX_RING_Constructor(TX_RING_Class_t *TxRing, uint32_t AirtimeLim)
+{
+   
+   memset(TxRing, 0, sizeof(TX_RING_Class_t));
+   
+   TxRing->AirtimeLim = AirtimeLim;
+
+} /* End TX_RING_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_RING_ResetStatus
+**
+** Notes:
+**   1. The high water mark restarts at the current depth.
+**
+*/
+void TX_RING_ResetStatus(TX_RING_Class_t *TxRing)
+{
+   
+   TxRing->HighWater = TX_RING_Depth(TxRing);
+   TxRing->FullCnt   = 0;
+
+} /* End TX_RING_ResetStatus() */
+
+
+/******************************************************************************
+** Function: TX_RING_Depth
+**
+*/
+uint32_t TX_RING_Depth(const TX_RING_Class_t *TxRing)
+{
+   
+   return LOAD_ACQUIRE(&TxRing->Head) - LOAD_ACQUIRE(&TxRing->Tail);
+
+} /* End TX_RING_Depth() */
+
+
+/******************************************************************************
+** Function: TX_RING_Space
+**
+*/
+uint32_t TX_RING_Space(const TX_RING_Class_t *TxRing)
+{
+   
+   uint32_t Depth = TxRing->Head - LOAD_ACQUIRE(&TxRing->Tail);
+   
+   if (Depth > 0 && TxRing->AirtimeLim > 0 && TX_RING_Airtime(TxRing) >= TxRing->AirtimeLim)
+   {
+      return 0;
+   }
+   
+   return TX_RING_DEPTH - Depth;
+
+} /* End TX_RING_Space() */
+
+
+/******************************************************************************
+** Function: TX_RING_Airtime
+**
+** Notes:
+**   1. AirtimeOut is read first so it never exceeds the AirtimeIn value it
+**      is subtracted from.
+**
+*/
+uint32_t TX_RING_Airtime(const TX_RING_Class_t *TxRing)
+{
+
+   uint32_t AirtimeOut = LOAD_ACQUIRE(&TxRing->AirtimeOut);
+   
+   return LOAD_ACQUIRE(&TxRing->AirtimeIn) - AirtimeOut;
+
+} /* End TX_RING_Airtime() */
+
+
+/******************************************************************************
+** Function: TX_RING_ProducerSlot
+**
+*/
+TX_RING_Slot_t *TX_RING_ProducerSlot(TX_RING_Class_t *TxRing)
+{
+   
+   TX_RING_Slot_t *Slot = NULL;
+   
+   if (TX_RING_Space(TxRing) > 0)
+   {
+      Slot = &TxRing->Slot[TX_RING_INDEX(TxRing->Head)];
+   }
+   else
+   {
+      TxRing->FullCnt++;
+   }
+   
+   return Slot;
+   
+} /* End TX_RING_ProducerSlot() */
+
+
+/******************************************************************************
+** Function: TX_RING_Produce
+**
+*/
+void TX_RING_Produce(TX_RING_Class_t *TxRing)
+{
+   
+   uint32_t Head = TxRing->Head + 1;
+   uint32_t Depth;
+   
+   STORE_RELEASE(&TxRing->AirtimeIn, TxRing->AirtimeIn + TxRing->Slot[TX_RING_INDEX(TxRing->Head)].Airtime);
+   
+   STORE_RELEASE(&TxRing->Head, Head);
+
+   Depth = Head - LOAD_ACQUIRE(&TxRing->Tail);
+   if (Depth > TxRing->HighWater)
+   {
+      TxRing->HighWater = Depth;
+   }
+   
+} /* End TX_RING_Produce() */
+
+
+/******************************************************************************
+** Function: TX_RING_Enqueue
+**
+*/
+bool TX_RING_Enqueue(TX_RING_Class_t *TxRing, const uint8_t *Data, uint16_t Len, uint32_t Airtime,
+                     uint32_t EnqueueMs, uint32_t DeadlineMs)
+{
+   
+   bool RetStatus = false;
+   TX_RING_Slot_t *Slot;
+   
+   if (Len <= RADIO_TX_MAX_PAYLOAD_LEN)
+   {
+      Slot = TX_RING_ProducerSlot(TxRing);
+      if (Slot != NULL)
+      {
+         memcpy(Slot->Data, Data, Len);
+         Slot->Len        = Len;
+         Slot->Airtime    = Airtime;
+         Slot->EnqueueMs  = EnqueueMs;
+         Slot->DeadlineMs = DeadlineMs;
+         TX_RING_Produce(TxRing);
+         RetStatus = true;
+      }
+   }
+   
+   return RetStatus;
+   
+} /* End TX_RING_Enqueue() */
+
+
+/******************************************************************************
+** Function: TX_RING_ConsumerSlot
+**
+*/
+const TX_RING_Slot_t *TX_RING_ConsumerSlot(TX_RING_Class_t *TxRing)
+{
+   
+   const TX_RING_Slot_t *Slot = NULL;
+   uint32_t Tail = TxRing->Tail;
+   
+   if (LOAD_ACQUIRE(&TxRing->Head) != Tail)
+   {
+      Slot = &TxRing->Slot[TX_RING_INDEX(Tail)];
+   }
+   
+   return Slot;
+   
+} /* End TX_RING_ConsumerSlot() */
+
+
+/******************************************************************************
+** Function: TX_RING_Consume
+**
+*/
+void TX_RING_Consume(TX_RING_Class_t *TxRing)
+{
+   
+   STORE_RELEASE(&TxRing->AirtimeOut, TxRing->AirtimeOut + TxRing->Slot[TX_RING_INDEX(TxRing->Tail)].Airtime);
+   STORE_RELEASE(&TxRing->Tail, TxRing->Tail + 1);
+   
+} /* End TX_RING_Consume() */
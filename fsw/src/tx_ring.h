@@ -0,0 +1,235 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the transmit ring class
+**
+**  Notes:
+**    1. A fixed capacity single-producer/single-consumer ring of
+**       preallocated radio frame slots. The producer is the app's main task
+**       and the consumer is the radio child task. Neither side blocks or
+**       takes a mutex and no memory is allocated per frame.
+**    2. Head is only written by the producer and Tail is only written by
+**       the consumer. Each side publishes its index with a release store
+**       and reads the other side's index with an acquire load so a slot's
+**       contents are visible before the slot changes hands.
+**    3. Slots can be filled and drained in place using the Slot/Produce
+**       and Slot/Consume function pairs. TX_RING_Enqueue() is a convenience
+**       function for producers that have a contiguous payload.
+**    4. Each slot carries its payload's time on air. The ring totals the
+**       airtime produced and consumed. When an airtime limit is configured
+**       the ring is full once the queued airtime reaches the limit so
+**       queue admission bounds the transmit latency as well as the number
+**       of queued frames.
+**    5. This header shouldn't include cFS header files so the ring can be
+**       used by host tools.
+**
+*/
+
+#ifndef _tx_ring_
+#define _tx_ring_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_platform_cfg.h"
+#include "radio_tx.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_RING_DEPTH     LORA_TX_RING_DEPTH
+#define TX_RING_INDEX(i)  ((i) & (TX_RING_DEPTH - 1))
+
+#if (TX_RING_DEPTH & (TX_RING_DEPTH - 1)) != 0
+   #error LORA_TX_RING_DEPTH must be a power of 2
+#endif
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef struct
+{
+   
+   uint16_t Len;
+   uint32_t Airtime;      /* us */
+   uint32_t EnqueueMs;    /* Owner defined ms clock */
+   uint32_t DeadlineMs;   /* Maximum queue time after EnqueueMs, 0 is no deadline */
+   uint8_t  Data[RADIO_TX_MAX_PAYLOAD_LEN];
+
+} TX_RING_Slot_t;
+
+
+/******************************************************************************
+** TX_RING_Class
+*/
+typedef struct
+{
+
+   /*
+   ** Producer owned
+   */
+   
+   uint32_t  Head;
+   uint32_t  HighWater;
+   uint32_t  FullCnt;     /* Enqueue attempts rejected because the ring was full */
+   uint32_t  AirtimeIn;   /* us, total airtime produced */
+   uint32_t  AirtimeLim;  /* us, queued airtime limit, 0 is unlimited */
+   
+   /*
+   ** Consumer owned
+   */
+   
+   uint32_t  Tail;
+   uint32_t  AirtimeOut;  /* us, total airtime consumed */
+   
+   TX_RING_Slot_t Slot[TX_RING_DEPTH];
+   
+} TX_RING_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_RING_Constructor
+**
+** Initialize the ring to an empty state
+**
+** Notes:
+**   1. Must be called before either task uses the ring.
+**   2. AirtimeLim (us) limits the queued airtime, zero disables the limit.
+**      A frame is always admitted to an empty ring.
+**
+*/
+void TX_RING_Constructor(TX_RING_Class_t *TxRing, uint32_t AirtimeLim);
+
+
+/******************************************************************************
+** Function: TX_RING_ResetStatus
+**
+** Notes:
+**   1. Must be called from the producer's context.
+**
+*/
+void TX_RING_ResetStatus(TX_RING_Class_t *TxRing);
+
+
+/******************************************************************************
+** Function: TX_RING_Depth
+**
+** Return the number of slots that are waiting to be consumed
+**
+*/
+uint32_t TX_RING_Depth(const TX_RING_Class_t *TxRing);
+
+
+/******************************************************************************
+** Function: TX_RING_Space
+**
+** Return the number of slots the producer can fill, zero when the ring is
+** full or the queued airtime limit has been reached
+**
+** Notes:
+**   1. Must be called from the producer's context.
+**
+*/
+uint32_t TX_RING_Space(const TX_RING_Class_t *TxRing);
+
+
+/******************************************************************************
+** Function: TX_RING_Airtime
+**
+** Return the time on air (us) of the slots that are waiting to be consumed
+**
+** Notes:
+**   1. May be called from the producer's or the consumer's context.
+**   2. Slot airtimes are computed when the slots are produced so they don't
+**      reflect LoRa parameter changes made while the slots are queued.
+**
+*/
+uint32_t TX_RING_Airtime(const TX_RING_Class_t *TxRing);
+
+
+/******************************************************************************
+** Function: TX_RING_ProducerSlot
+**
+** Return the next free slot or NULL if the ring is full
+**
+** Notes:
+**   1. The caller sets the slot's Len, Airtime, EnqueueMs and DeadlineMs.
+**      The slot isn't visible to the consumer until TX_RING_Produce() is
+**      called. Calling this function again without producing returns the
+**      same slot.
+**   2. Returns NULL when TX_RING_Space() is zero and increments FullCnt.
+**
+*/
+TX_RING_Slot_t *TX_RING_ProducerSlot(TX_RING_Class_t *TxRing);
+
+
+/******************************************************************************
+** Function: TX_RING_Produce
+**
+** Publish the slot returned by TX_RING_ProducerSlot() to the consumer
+**
+*/
+void TX_RING_Produce(TX_RING_Class_t *TxRing);
+
+
+/******************************************************************************
+** Function: TX_RING_Enqueue
+**
+** Copy a payload into the next free slot and publish it
+**
+** Notes:
+**   1. Returns false if the ring is full or the payload is too long.
+**
+*/
+bool TX_RING_Enqueue(TX_RING_Class_t *TxRing, const uint8_t *Data, uint16_t Len, uint32_t Airtime,
+                     uint32_t EnqueueMs, uint32_t DeadlineMs);
+
+
+/******************************************************************************
+** Function: TX_RING_ConsumerSlot
+**
+** Return the oldest published slot or NULL if the ring is empty
+**
+** Notes:
+**   1. The slot remains owned by the consumer until TX_RING_Consume() is
+**      called.
+**
+*/
+const TX_RING_Slot_t *TX_RING_ConsumerSlot(TX_RING_Class_t *TxRing);
+
+
+/******************************************************************************
+** Function: TX_RING_Consume
+**
+** Return the slot returned by TX_RING_ConsumerSlot() to the producer
+**
+*/
+void TX_RING_Consume(TX_RING_Class_t *TxRing);
+
+
+#endif /* _tx_ring_ */
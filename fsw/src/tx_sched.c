@@ -0,0 +1,156 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the transmit scheduler class
+**
+**  Notes:
+**    1. See tx_sched.h for the scheduling policy.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_sched.h"
+
+
+/******************************************************************************
+** Function: TX_SCHED_Constructor
+**
+*/
+void TX_SCHED_Constructor(TX_SCHED_Class_t *TxSched, const uint32_t Weight[TX_SCHED_CLASS_CNT])
+{
+   
+   memset(TxSched, 0, sizeof(TX_SCHED_Class_t));
+   
+   memcpy(TxSched->Weight, Weight, sizeof(TxSched->Weight));
+
+} /* End TX_SCHED_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_SCHED_ResetStatus
+**
+*/
+void TX_SCHED_ResetStatus(TX_SCHED_Class_t *TxSched)
+{
+   
+   memset(TxSched->Stats, 0, sizeof(TxSched->Stats));
+
+} /* End TX_SCHED_ResetStatus() */
+
+
+/******************************************************************************
+** Function: TX_SCHED_Select
+**
+** Notes:
+**   1. Idle classes are brought forward to the virtual time as soon as
+**      they're backlogged so a backlogged class's pass is never behind the
+**      virtual time.
+**
+*/
+uint8_t TX_SCHED_Select(TX_SCHED_Class_t *TxSched, uint8_t Backlog)
+{
+   
+   uint8_t Class;
+   uint8_t Selected = TX_SCHED_NONE;
+   
+   for (Class = 0; Class < TX_SCHED_CLASS_CNT; Class++)
+   {
+      
+      if ((Backlog & (1 << Class)) == 0)
+      {
+         continue;
+      }
+      
+      if (TxSched->Weight[Class] == 0)
+      {
+         return Class;
+      }
+      
+      if (TxSched->Pass[Class] < TxSched->VirtualTime)
+      {
+         TxSched->Pass[Class] = TxSched->VirtualTime;
+      }
+      if (Selected == TX_SCHED_NONE || TxSched->Pass[Class] < TxSched->Pass[Selected])
+      {
+         Selected = Class;
+      }
+      
+   } /* End class loop */
+   
+   if (Selected != TX_SCHED_NONE)
+   {
+      TxSched->VirtualTime = TxSched->Pass[Selected];
+   }
+   
+   return Selected;
+   
+} /* End TX_SCHED_Select() */
+
+
+/******************************************************************************
+** Function: TX_SCHED_Charge
+**
+*/
+void TX_SCHED_Charge(TX_SCHED_Class_t *TxSched, uint8_t Class, uint32_t Airtime)
+{
+   
+   TX_SCHED_ClassStats_t *Stats = &TxSched->Stats[Class];
+   
+   if (TxSched->Weight[Class] > 0)
+   {
+      TxSched->Pass[Class] += ((uint64_t)Airtime * TX_SCHED_STRIDE) / TxSched->Weight[Class];
+   }
+   
+   Stats->PktCnt++;
+   Stats->AirtimeRem += Airtime;
+   Stats->AirtimeMs  += Stats->AirtimeRem / 1000;
+   Stats->AirtimeRem %= 1000;
+   
+} /* End TX_SCHED_Charge() */
+
+
+/******************************************************************************
+** Function: TX_SCHED_Latency
+**
+*/
+void TX_SCHED_Latency(TX_SCHED_Class_t *TxSched, uint8_t Class, uint32_t LatencyMs)
+{
+   
+   TX_SCHED_ClassStats_t *Stats = &TxSched->Stats[Class];
+   
+   Stats->LatencyCnt++;
+   Stats->LatencySum += LatencyMs;
+   if (LatencyMs > Stats->LatencyMax)
+   {
+      Stats->LatencyMax = LatencyMs;
+   }
+   
+} /* End TX_SCHED_Latency() */
+
+
+/******************************************************************************
+** Function: TX_SCHED_Drop
+**
+*/
+void TX_SCHED_Drop(TX_SCHED_Class_t *TxSched, uint8_t Class)
+{
+   
+   TxSched->Stats[Class].DropCnt++;
+   
+} /* End TX_SCHED_Drop() */
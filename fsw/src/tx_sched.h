@@ -0,0 +1,157 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the transmit scheduler class
+**
+**  Notes:
+**    1. Selects the traffic class that sends the next packet. Classes with
+**       a zero weight are strict priority classes that are served, lowest
+**       class first, before any weighted class.
+**    2. Weighted classes share the airtime in proportion to their weights
+**       using start-time fair queueing. Each class has a virtual pass that
+**       advances by a packet's airtime divided by the class weight and the
+**       backlogged class with the lowest pass is served. Ties go to the
+**       lower class. A class that was idle starts at the scheduler's
+**       virtual time so it can't save up credit while it's idle.
+**    3. Sharing airtime rather than packets means a class sending long
+**       packets at a slow spreading factor can't crowd out a class sending
+**       short packets.
+**    4. The scheduler doesn't own any queues. The caller reports which
+**       classes are backlogged and charges the selected class with the
+**       airtime of the packet it sent.
+**    5. This header shouldn't include cFS header files so the scheduler can
+**       be used by host tools.
+**
+*/
+
+#ifndef _tx_sched_
+#define _tx_sched_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_tx_platform_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_SCHED_CLASS_CNT  LORA_TX_SCHED_CLASS_CNT
+#define TX_SCHED_NONE       0xFF   /* TX_SCHED_Select() return when no class is backlogged */
+
+#define TX_SCHED_STRIDE     1024   /* Pass scale so small weights keep airtime resolution */
+
+#if TX_SCHED_CLASS_CNT > 8
+   #error LORA_TX_SCHED_CLASS_CNT must not exceed the 8 bit backlog mask
+#endif
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef struct
+{
+   
+   uint32_t  PktCnt;
+   uint32_t  AirtimeMs;
+   uint32_t  DropCnt;       /* Packets discarded after their deadline */
+   uint32_t  LatencyCnt;
+   uint64_t  LatencySum;    /* ms */
+   uint32_t  LatencyMax;    /* ms */
+   uint32_t  AirtimeRem;    /* us not yet added to AirtimeMs */
+
+} TX_SCHED_ClassStats_t;
+
+
+/******************************************************************************
+** TX_SCHED_Class
+*/
+typedef struct
+{
+
+   uint32_t  Weight[TX_SCHED_CLASS_CNT];   /* 0 is strict priority */
+   uint64_t  Pass[TX_SCHED_CLASS_CNT];
+   uint64_t  VirtualTime;
+   
+   TX_SCHED_ClassStats_t Stats[TX_SCHED_CLASS_CNT];
+   
+} TX_SCHED_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_SCHED_Constructor
+**
+*/
+void TX_SCHED_Constructor(TX_SCHED_Class_t *TxSched, const uint32_t Weight[TX_SCHED_CLASS_CNT]);
+
+
+/******************************************************************************
+** Function: TX_SCHED_ResetStatus
+**
+*/
+void TX_SCHED_ResetStatus(TX_SCHED_Class_t *TxSched);
+
+
+/******************************************************************************
+** Function: TX_SCHED_Select
+**
+** Return the class that sends the next packet or TX_SCHED_NONE
+**
+** Notes:
+**   1. Bit n of Backlog is set when class n has a packet waiting.
+**
+*/
+uint8_t TX_SCHED_Select(TX_SCHED_Class_t *TxSched, uint8_t Backlog);
+
+
+/******************************************************************************
+** Function: TX_SCHED_Charge
+**
+** Charge a class for a packet it sent
+**
+*/
+void TX_SCHED_Charge(TX_SCHED_Class_t *TxSched, uint8_t Class, uint32_t Airtime);
+
+
+/******************************************************************************
+** Function: TX_SCHED_Latency
+**
+** Record the time a class's packet waited before it was sent
+**
+*/
+void TX_SCHED_Latency(TX_SCHED_Class_t *TxSched, uint8_t Class, uint32_t LatencyMs);
+
+
+/******************************************************************************
+** Function: TX_SCHED_Drop
+**
+** Record a packet that was discarded because it missed its deadline
+**
+*/
+void TX_SCHED_Drop(TX_SCHED_Class_t *TxSched, uint8_t Class);
+
+
+#endif /* _tx_sched_ */
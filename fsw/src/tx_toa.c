@@ -0,0 +1,208 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Implement the LoRa time on air model class
+**
+**  Notes:
+**    1. See tx_toa.h for the model.
+**    2. Symbol counts are kept in quarter symbols so the fractional
+**       preamble symbols are exact in integer arithmetic.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "tx_toa.h"
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+/* Indexed by the position of the bandwidth register code in BwCode[] */
+static const uint8_t  BwCode[TX_TOA_BW_CNT] = { 0x34, 0x26, 0x18, 0x0A };
+static const uint32_t BwHz[TX_TOA_BW_CNT]   = { 203125, 406250, 812500, 1625000 };
+
+/* Coding rate denominators indexed by register code - 1 */
+static const uint8_t  CrDen[TX_TOA_CR_CNT]  = { 5, 6, 7, 8, 5, 6, 8 };
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static int SfIndex(uint8_t SpreadingFactor);
+static int BwIndex(uint8_t Bandwidth);
+
+
+/******************************************************************************
+** Function: TX_TOA_Constructor
+**
+*/
+void TX_TOA_Constructor(TX_TOA_Class_t *TxToa, bool Crc)
+{
+   
+   int32_t Bits;
+   uint8_t Sf, BitsPerBlock;
+   uint16_t Hdr, Len;
+   
+   memset(TxToa, 0, sizeof(TX_TOA_Class_t));
+   
+   TxToa->Crc = Crc;
+   
+   for (Sf = 5; Sf <= 12; Sf++)
+   {
+      BitsPerBlock = 4 * ((Sf >= 11) ? (Sf - 2) : Sf);
+      for (Hdr = TX_TOA_HDR_IMPLICIT; Hdr <= TX_TOA_HDR_EXPLICIT; Hdr++)
+      {
+         for (Len = 0; Len < TX_TOA_LEN_CNT; Len++)
+         {
+            Bits = 8 * Len + (Crc ? 16 : 0) - 4 * Sf + 20 * Hdr + ((Sf >= 7) ? 8 : 0);
+            TxToa->Blocks[Sf - 5][Hdr][Len] = (Bits > 0) ? (uint8_t)((Bits + BitsPerBlock - 1) / BitsPerBlock) : 0;
+         }
+      }
+   }
+   
+} /* End TX_TOA_Constructor() */
+
+
+/******************************************************************************
+** Function: TX_TOA_Compute
+**
+*/
+uint32_t TX_TOA_Compute(const TX_TOA_Class_t *TxToa, uint8_t SpreadingFactor, uint8_t Bandwidth,
+                        uint8_t CodingRate, uint16_t PreambleLen, uint8_t PayloadLen, uint8_t HdrMode)
+{
+   
+   int Sf = SfIndex(SpreadingFactor);
+   int Bw = BwIndex(Bandwidth);
+   uint32_t Quarters;
+   
+   if (Sf < 0 || Bw < 0 || CodingRate < 1 || CodingRate > TX_TOA_CR_CNT || HdrMode > TX_TOA_HDR_EXPLICIT)
+   {
+      return 0;
+   }
+   
+   Quarters = 4 * (uint32_t)PreambleLen + ((Sf < 2) ? 25 : 17) + 
+              4 * (8 + (uint32_t)TxToa->Blocks[Sf][HdrMode][PayloadLen] * CrDen[CodingRate - 1]);
+   
+   return (uint32_t)((((uint64_t)Quarters << (Sf + 5)) * 1000000 + (uint64_t)BwHz[Bw] * 2) / ((uint64_t)BwHz[Bw] * 4));
+   
+} /* End TX_TOA_Compute() */
+
+
+/******************************************************************************
+** Function: TX_TOA_SetActive
+**
+*/
+bool TX_TOA_SetActive(TX_TOA_Class_t *TxToa, uint8_t SpreadingFactor, uint8_t Bandwidth,
+                      uint8_t CodingRate, uint16_t PreambleLen)
+{
+   
+   TX_TOA_Active_t *Active;
+   uint8_t  Next = TxToa->ActiveCur ^ 1;
+   uint16_t Len;
+   
+   if (TX_TOA_Compute(TxToa, SpreadingFactor, Bandwidth, CodingRate, PreambleLen, 0, TX_TOA_HDR_EXPLICIT) == 0)
+   {
+      return false;
+   }
+   
+   Active = &TxToa->Active[Next];
+   for (Len = 0; Len < TX_TOA_LEN_CNT; Len++)
+   {
+      Active->Toa[Len] = TX_TOA_Compute(TxToa, SpreadingFactor, Bandwidth, CodingRate,
+                                        PreambleLen, (uint8_t)Len, TX_TOA_HDR_EXPLICIT);
+   }
+   
+   Active->PreambleLen     = PreambleLen;
+   Active->SpreadingFactor = SpreadingFactor;
+   Active->Bandwidth       = Bandwidth;
+   Active->CodingRate      = CodingRate;
+   
+   TxToa->ActiveCur = Next;
+   
+   return true;
+   
+} /* End TX_TOA_SetActive() */
+
+
+/******************************************************************************
+** Function: TX_TOA_Get
+**
+*/
+uint32_t TX_TOA_Get(const TX_TOA_Class_t *TxToa, uint8_t PayloadLen)
+{
+   
+   return TxToa->Active[TxToa->ActiveCur].Toa[PayloadLen];
+   
+} /* End TX_TOA_Get() */
+
+
+/******************************************************************************
+** Function: TX_TOA_GetActive
+**
+*/
+const TX_TOA_Active_t *TX_TOA_GetActive(const TX_TOA_Class_t *TxToa)
+{
+   
+   return &TxToa->Active[TxToa->ActiveCur];
+   
+} /* End TX_TOA_GetActive() */
+
+
+/******************************************************************************
+** Function: SfIndex
+**
+** Return the table index of a spreading factor register code or -1 if the
+** code is invalid
+**
+*/
+static int SfIndex(uint8_t SpreadingFactor)
+{
+   
+   uint8_t Sf = SpreadingFactor >> 4;
+   
+   return ((SpreadingFactor & 0x0F) == 0 && Sf >= 5 && Sf <= 12) ? (Sf - 5) : -1;
+   
+} /* End SfIndex() */
+
+
+/******************************************************************************
+** Function: BwIndex
+**
+** Return the table index of a bandwidth register code or -1 if the code is
+** invalid
+**
+*/
+static int BwIndex(uint8_t Bandwidth)
+{
+   
+   int i;
+   
+   for (i = 0; i < TX_TOA_BW_CNT; i++)
+   {
+      if (BwCode[i] == Bandwidth)
+      {
+         return i;
+      }
+   }
+   
+   return -1;
+   
+} /* End BwIndex() */
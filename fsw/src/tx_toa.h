@@ -0,0 +1,167 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Define the LoRa time on air model class
+**
+**  Notes:
+**    1. Models the SX128x LoRa packet time on air for every spreading
+**       factor, bandwidth, coding rate, payload length and header mode
+**       using the SX1280 datasheet formula:
+**
+**         ToA = (2^SF / BW) * (Npreamble + 4.25 + 8 + Nblock * CrDen)
+**
+**       Npreamble is increased by 2 symbols for SF5 and SF6. Nblock is
+**       ceil(max(8*PL + 16*CRC - 4*SF + 8 + 20*H, 0) / (4*SF)) with the
+**       SF5/SF6 form omitting the 8 bits and SF11/SF12 using 4*(SF-2).
+**       Long interleaving coding rates are modeled with their
+**       denominators.
+**    2. The radio register codes are used for all parameters so callers
+**       can pass command and configuration values directly.
+**    3. The block count table covering every spreading factor, header mode
+**       and length is built by the constructor. The active table holds the
+**       time on air of every payload length for the current parameters so
+**       transmit pacing and queue admission are a single lookup.
+**    4. This header shouldn't include cFS header files so the model can be
+**       used by host tools.
+**
+*/
+
+#ifndef _tx_toa_
+#define _tx_toa_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "radio_tx.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TX_TOA_SF_CNT      8      /* SF5..SF12, register codes 0x50..0xC0 */
+#define TX_TOA_BW_CNT      4
+#define TX_TOA_CR_CNT      7      /* Register codes 1..7 */
+#define TX_TOA_LEN_CNT     (RADIO_TX_MAX_PAYLOAD_LEN + 1)
+
+#define TX_TOA_HDR_IMPLICIT  0
+#define TX_TOA_HDR_EXPLICIT  1
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** TX_TOA_Active
+**
+** LoRa parameters and time on air table of the radio's current packets
+*/
+typedef struct
+{
+
+   uint16_t  PreambleLen;
+   uint8_t   SpreadingFactor;
+   uint8_t   Bandwidth;
+   uint8_t   CodingRate;
+   uint32_t  Toa[TX_TOA_LEN_CNT];   /* us, explicit header */
+   
+} TX_TOA_Active_t;
+
+
+/******************************************************************************
+** TX_TOA_Class
+**
+** The active table is double buffered. TX_TOA_SetActive() builds the table
+** that isn't in use and then switches ActiveCur so readers in other tasks
+** never see a partially built table.
+*/
+typedef struct
+{
+
+   bool      Crc;
+   
+   uint8_t   Blocks[TX_TOA_SF_CNT][2][TX_TOA_LEN_CNT];
+   
+   volatile uint8_t ActiveCur;
+   TX_TOA_Active_t  Active[2];
+   
+} TX_TOA_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TX_TOA_Constructor
+**
+** Notes:
+**   1. Crc must match the radio's packet parameters.
+**   2. The active table is empty until TX_TOA_SetActive() is called.
+**
+*/
+void TX_TOA_Constructor(TX_TOA_Class_t *TxToa, bool Crc);
+
+
+/******************************************************************************
+** Function: TX_TOA_Compute
+**
+** Return the time on air (us) of a packet or zero if a parameter is invalid
+**
+*/
+uint32_t TX_TOA_Compute(const TX_TOA_Class_t *TxToa, uint8_t SpreadingFactor, uint8_t Bandwidth,
+                        uint8_t CodingRate, uint16_t PreambleLen, uint8_t PayloadLen, uint8_t HdrMode);
+
+
+/******************************************************************************
+** Function: TX_TOA_SetActive
+**
+** Build the active table for the radio's current LoRa parameters
+**
+** Notes:
+**   1. Returns false and leaves the active table unchanged if a parameter
+**      is invalid.
+**   2. Only one task may call this function, see TX_TOA_Class_t.
+**
+*/
+bool TX_TOA_SetActive(TX_TOA_Class_t *TxToa, uint8_t SpreadingFactor, uint8_t Bandwidth,
+                      uint8_t CodingRate, uint16_t PreambleLen);
+
+
+/******************************************************************************
+** Function: TX_TOA_Get
+**
+** Return the time on air (us) of a payload with the active parameters
+**
+*/
+uint32_t TX_TOA_Get(const TX_TOA_Class_t *TxToa, uint8_t PayloadLen);
+
+
+/******************************************************************************
+** Function: TX_TOA_GetActive
+**
+** Return the active parameters and table
+**
+*/
+const TX_TOA_Active_t *TX_TOA_GetActive(const TX_TOA_Class_t *TxToa);
+
+
+#endif /* _tx_toa_ */
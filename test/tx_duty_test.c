@@ -0,0 +1,322 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Host test of the transmit duty cycle limiter class
+**
+**  Notes:
+**    1. Each case saturates the limiter with random airtimes, sending a
+**       packet as soon as the radio is free and TX_DUTY_Wait() allows it.
+**       Deferred packets sleep for the whole wait or part of it.
+**    2. Every rolling window that starts at a packet's start or ends at a
+**       packet's end is summed and must not exceed the budget. A packet
+**       longer than the budget must be the only packet in its windows.
+**    3. The limiter must also use most of the budget, send a packet when
+**       TX_DUTY_Remaining() says it fits and handle the ms clock wrapping.
+**    4. Returns non-zero if a check fails.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <stdio.h>
+
+#include "tx_duty.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TEST_WINDOWS      12       /* Windows simulated per case */
+#define TEST_MAX_SENDS    20000
+#define TEST_MIN_USE_PCT  85       /* Budget a saturated limiter must use */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef struct
+{
+
+   const char *Name;
+   uint32_t  BudgetMs;
+   uint32_t  WindowMs;
+   uint32_t  AirMin;      /* us */
+   uint32_t  AirMax;      /* us */
+   uint32_t  StartMs;     /* Clock at the start of the case */
+   
+} Case_t;
+
+
+typedef struct
+{
+
+   uint64_t  StartUs;
+   uint32_t  Airtime;
+   
+} Send_t;
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static const Case_t Case[] =
+{
+   { "1%/hour",          36000, 3600000, 20000, 2000000, 0          },
+   { "10%/10s short",     1000,   10000,   300,  400000, 0          },
+   { "full ledger",        500,   10000,   100,    2000, 0          },
+   { "oversize packets",   100,    1000, 50000,  300000, 0          },
+   { "clock wrap",        1000,   10000,  1000,  400000, 0xFFFF0000u }
+};
+
+static uint32_t Rand = 1;
+
+static TX_DUTY_Class_t TxDuty;
+
+static Send_t   Send[TEST_MAX_SENDS];
+static uint32_t SendCnt;
+
+static uint32_t CheckCnt;
+static uint32_t FailCnt;
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static uint32_t NextRand(void);
+static void Simulate(const Case_t *Case);
+static void CheckWindows(const Case_t *Case);
+static uint64_t WindowAirtime(uint64_t StartUs, uint64_t EndUs, uint32_t *Oversize, uint32_t *PktCnt, uint64_t Budget);
+
+
+/******************************************************************************
+** Function: main
+**
+*/
+int main(void)
+{
+   
+   uint32_t CaseFailCnt;
+   uint8_t  c;
+   
+   for (c = 0; c < (sizeof(Case)/sizeof(Case[0])); c++)
+   {
+      CheckCnt    = 0;
+      CaseFailCnt = FailCnt;
+      
+      Simulate(&Case[c]);
+      CheckWindows(&Case[c]);
+      
+      printf("%-17s %u packets, %u checks, %u failures\n", Case[c].Name, SendCnt, CheckCnt, FailCnt - CaseFailCnt);
+   }
+   
+   return (FailCnt == 0) ? 0 : 1;
+   
+} /* End main() */
+
+
+/******************************************************************************
+** Function: NextRand
+**
+** xorshift32 so the airtimes and waits are repeatable
+**
+*/
+static uint32_t NextRand(void)
+{
+   
+   Rand ^= Rand << 13;
+   Rand ^= Rand >> 17;
+   Rand ^= Rand << 5;
+   
+   return Rand;
+   
+} /* End NextRand() */
+
+
+/******************************************************************************
+** Function: Simulate
+**
+** Send packets for TEST_WINDOWS windows as fast as the limiter allows
+**
+** Notes:
+**   1. The simulated clock is 64 bits and the limiter gets its low 32 bits
+**      offset by the case's StartMs.
+**
+*/
+static void Simulate(const Case_t *Case)
+{
+   
+   uint64_t TimeMs = 0;
+   uint64_t EndMs  = (uint64_t)Case->WindowMs * TEST_WINDOWS;
+   uint64_t SentUs = 0;
+   uint64_t MinUs;
+   uint32_t Airtime, WaitMs, Remaining;
+   
+   TX_DUTY_Constructor(&TxDuty, Case->BudgetMs, Case->WindowMs);
+   SendCnt = 0;
+   Airtime = Case->AirMin + NextRand() % (Case->AirMax - Case->AirMin + 1);
+   
+   while (TimeMs < EndMs && SendCnt < TEST_MAX_SENDS)
+   {
+      
+      Remaining = TX_DUTY_Remaining(&TxDuty, (uint32_t)(Case->StartMs + TimeMs));
+      WaitMs    = TX_DUTY_Wait(&TxDuty, Airtime, (uint32_t)(Case->StartMs + TimeMs));
+      
+      CheckCnt++;
+      if (WaitMs > 0 && (uint64_t)Remaining * 1000 >= Airtime)
+      {
+         FailCnt++;
+         printf("FAIL %s at %llu ms: %u us deferred %u ms with %u ms remaining\n",
+                Case->Name, (unsigned long long)TimeMs, Airtime, WaitMs, Remaining);
+      }
+      
+      if (WaitMs > 0)
+      {
+         CheckCnt++;
+         if (WaitMs > Case->WindowMs + Case->AirMax / 1000 + 1)
+         {
+            FailCnt++;
+            printf("FAIL %s at %llu ms: wait of %u ms is longer than a window\n",
+                   Case->Name, (unsigned long long)TimeMs, WaitMs);
+         }
+         TX_DUTY_Throttled(&TxDuty, WaitMs, true);
+         TimeMs += (NextRand() & 1) ? WaitMs : (1 + NextRand() % WaitMs);
+         continue;
+      }
+      
+      TX_DUTY_Charge(&TxDuty, Airtime, (uint32_t)(Case->StartMs + TimeMs));
+      Send[SendCnt].StartUs = TimeMs * 1000;
+      Send[SendCnt].Airtime = Airtime;
+      SendCnt++;
+      SentUs += Airtime;
+      
+      /* The radio is busy until the packet ends */
+      TimeMs += (Airtime + 999) / 1000;
+      Airtime = Case->AirMin + NextRand() % (Case->AirMax - Case->AirMin + 1);
+   
+   }
+   
+   if (Case->AirMax <= (uint64_t)Case->BudgetMs * 1000)
+   {
+      MinUs = (uint64_t)Case->BudgetMs * 1000 * TEST_WINDOWS * TEST_MIN_USE_PCT / 100;
+      CheckCnt++;
+      if (SentUs < MinUs)
+      {
+         FailCnt++;
+         printf("FAIL %s: sent %llu us, a saturated limiter should send at least %llu us\n",
+                Case->Name, (unsigned long long)SentUs, (unsigned long long)MinUs);
+      }
+   }
+   
+} /* End Simulate() */
+
+
+/******************************************************************************
+** Function: CheckWindows
+**
+** Check the airtime of every window that starts at a packet's start or
+** ends at a packet's end
+**
+*/
+static void CheckWindows(const Case_t *Case)
+{
+   
+   uint64_t Budget   = (uint64_t)Case->BudgetMs * 1000;
+   uint64_t WindowUs = (uint64_t)Case->WindowMs * 1000;
+   uint64_t StartUs, Airtime;
+   uint32_t Oversize, PktCnt;
+   uint32_t i, Edge;
+   
+   for (i = 0; i < SendCnt; i++)
+   {
+      for (Edge = 0; Edge < 2; Edge++)
+      {
+         
+         if (Edge == 0)
+         {
+            StartUs = Send[i].StartUs;
+         }
+         else
+         {
+            StartUs = Send[i].StartUs + Send[i].Airtime;
+            StartUs = (StartUs > WindowUs) ? (StartUs - WindowUs) : 0;
+         }
+         
+         Airtime = WindowAirtime(StartUs, StartUs + WindowUs, &Oversize, &PktCnt, Budget);
+         
+         CheckCnt++;
+         if (Oversize > 0)
+         {
+            if (PktCnt > 1)
+            {
+               FailCnt++;
+               printf("FAIL %s: window at %llu us has a packet longer than the budget and %u others\n",
+                      Case->Name, (unsigned long long)StartUs, PktCnt - 1);
+            }
+         }
+         else if (Airtime > Budget)
+         {
+            FailCnt++;
+            printf("FAIL %s: window at %llu us has %llu us of airtime, budget is %llu us\n",
+                   Case->Name, (unsigned long long)StartUs, (unsigned long long)Airtime,
+                   (unsigned long long)Budget);
+         }
+      
+      }
+   }
+   
+} /* End CheckWindows() */
+
+
+/******************************************************************************
+** Function: WindowAirtime
+**
+** Return the airtime of the packets overlapping [StartUs, EndUs)
+**
+*/
+static uint64_t WindowAirtime(uint64_t StartUs, uint64_t EndUs, uint32_t *Oversize, uint32_t *PktCnt, uint64_t Budget)
+{
+   
+   uint64_t Airtime = 0;
+   uint64_t PktStart, PktEnd;
+   uint32_t i;
+   
+   *Oversize = 0;
+   *PktCnt   = 0;
+   
+   for (i = 0; i < SendCnt; i++)
+   {
+      PktStart = Send[i].StartUs;
+      PktEnd   = PktStart + Send[i].Airtime;
+      if (PktEnd <= StartUs || PktStart >= EndUs)
+      {
+         continue;
+      }
+      Airtime += ((PktEnd < EndUs) ? PktEnd : EndUs) - ((PktStart > StartUs) ? PktStart : StartUs);
+      (*PktCnt)++;
+      if (Send[i].Airtime > Budget)
+      {
+         (*Oversize)++;
+      }
+   }
+   
+   return Airtime;
+   
+} /* End WindowAirtime() */
@@ -0,0 +1,480 @@
+/*
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Lesser General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Lesser General Public License for more details.
+**
+**  You should have received a copy of the GNU Lesser General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+**
+**  Purpose:
+**    Host test of the transmit forward erasure coding class
+**
+**  Notes:
+**    1. Every multiply-add kernel the build and CPU support is forced in
+**       turn and compared with the scalar loop for every length and
+**       alignment of a maximum length symbol.
+**    2. Streams with a partial last group are encoded with each kernel and
+**       must produce the scalar kernel's packets. Each group is then
+**       decoded after erasing every loss count up to M packets, randomly
+**       and in bursts at every position, and the recovered packets must
+**       match the originals including their lengths. Erasing more data
+**       packets than parity packets received must fail.
+**    3. Returns non-zero if a check fails. Kernels that aren't supported
+**       are reported as skipped.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tx_fec.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TEST_STREAM_PKTS    200     /* Data packets per stream */
+#define TEST_RANDOM_TRIALS  20      /* Random erasure patterns per loss count */
+#define TEST_GROUP_MAX      (TX_FEC_MAX_DATA + TX_FEC_MAX_PARITY)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef struct
+{
+
+   uint16_t  Len;
+   uint8_t   Data[RADIO_TX_MAX_PAYLOAD_LEN];
+   
+} Pkt_t;
+
+
+typedef struct
+{
+
+   uint8_t   K;
+   uint8_t   M;
+   uint16_t  PktLen;
+   
+} Code_t;
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static const struct
+{
+   uint8_t     Kernel;
+   const char *Name;
+} Kernel[] =
+{
+   { TX_FEC_KERNEL_SCALAR, "scalar" },
+   { TX_FEC_KERNEL_SSSE3,  "ssse3"  },
+   { TX_FEC_KERNEL_AVX2,   "avx2"   },
+   { TX_FEC_KERNEL_NEON,   "neon"   }
+};
+
+static const Code_t Code[] =
+{
+   {   1, 1,                  RADIO_TX_MAX_PAYLOAD_LEN },
+   {   4, 2,                  64                       },
+   {  16, 4,                  RADIO_TX_MAX_PAYLOAD_LEN },
+   {  10, TX_FEC_MAX_PARITY,  RADIO_TX_MAX_PAYLOAD_LEN },
+   {  TX_FEC_MAX_DATA, 3,     40                       }
+};
+
+static uint32_t Rand = 1;
+
+static TX_FEC_Class_t TxFec;
+
+static Pkt_t    DataPkt[TEST_STREAM_PKTS];
+static Pkt_t    RefPkt[TEST_STREAM_PKTS * 2];   /* Scalar kernel's stream */
+static Pkt_t    TxPkt[TEST_STREAM_PKTS * 2];
+static uint16_t RefPktCnt;
+
+static uint32_t CheckCnt;
+static uint32_t FailCnt;
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static uint32_t NextRand(void);
+static void Fail(uint8_t k, const Code_t *Code, const char *Msg, int Group, int Lost);
+static void TestMulAdd(uint8_t k);
+static uint16_t EncodeStream(const Code_t *Code, Pkt_t Pkt[]);
+static void TestCode(uint8_t k, const Code_t *Code);
+static bool DecodeGroup(const Pkt_t *Pkt, uint16_t PktCnt, uint16_t FirstData, const bool Lost[]);
+
+
+/******************************************************************************
+** Function: main
+**
+*/
+int main(void)
+{
+   
+   uint32_t KernelFailCnt;
+   uint8_t  k, c;
+   
+   for (k = 0; k < (sizeof(Kernel)/sizeof(Kernel[0])); k++)
+   {
+      if (!TX_FEC_SelectKernel(Kernel[k].Kernel))
+      {
+         printf("%-6s skipped, not supported\n", Kernel[k].Name);
+         continue;
+      }
+      
+      CheckCnt      = 0;
+      KernelFailCnt = FailCnt;
+      TestMulAdd(k);
+      for (c = 0; c < (sizeof(Code)/sizeof(Code[0])); c++)
+      {
+         TestCode(k, &Code[c]);
+      }
+      
+      printf("%-6s %u checks, %u failures\n", Kernel[k].Name, CheckCnt, FailCnt - KernelFailCnt);
+   }
+   
+   TX_FEC_SelectKernel(TX_FEC_KERNEL_AUTO);
+   
+   return (FailCnt == 0) ? 0 : 1;
+   
+} /* End main() */
+
+
+/******************************************************************************
+** Function: NextRand
+**
+** xorshift32 so the erasure patterns are repeatable
+**
+*/
+static uint32_t NextRand(void)
+{
+   
+   Rand ^= Rand << 13;
+   Rand ^= Rand >> 17;
+   Rand ^= Rand << 5;
+   
+   return Rand;
+   
+} /* End NextRand() */
+
+
+/******************************************************************************
+** Function: Fail
+**
+*/
+static void Fail(uint8_t k, const Code_t *Code, const char *Msg, int Group, int Lost)
+{
+   
+   FailCnt++;
+   printf("FAIL %s K=%d M=%d PktLen=%d group %d, %d lost: %s\n",
+          Kernel[k].Name, Code->K, Code->M, Code->PktLen, Group, Lost, Msg);
+   
+} /* End Fail() */
+
+
+/******************************************************************************
+** Function: TestMulAdd
+**
+** Compare the selected kernel with a bytewise multiply-add for every
+** length and source/destination alignment
+**
+*/
+static void TestMulAdd(uint8_t k)
+{
+   
+   uint8_t  Src[TX_FEC_MAX_SYM_LEN + 32];
+   uint8_t  Dst[TX_FEC_MAX_SYM_LEN + 32];
+   uint8_t  Ref[TX_FEC_MAX_SYM_LEN + 32];
+   uint8_t  One[1];
+   uint16_t Len, Align, i;
+   uint8_t  Coef;
+   
+   for (Len = 0; Len <= TX_FEC_MAX_SYM_LEN; Len++)
+   {
+      for (Align = 0; Align < 32; Align += 7)
+      {
+         Coef = (uint8_t)NextRand();
+         for (i = 0; i < sizeof(Src); i++)
+         {
+            Src[i] = (uint8_t)NextRand();
+            Dst[i] = (uint8_t)NextRand();
+         }
+         memcpy(Ref, Dst, sizeof(Ref));
+         
+         /* A one byte multiply-add always uses the scalar loop */
+         for (i = 0; i < Len; i++)
+         {
+            One[0] = Ref[Align + i];
+            TX_FEC_MulAdd(One, &Src[Align + i], Coef, 1);
+            Ref[Align + i] = One[0];
+         }
+         TX_FEC_MulAdd(&Dst[Align], &Src[Align], Coef, Len);
+         
+         CheckCnt++;
+         if (memcmp(Dst, Ref, sizeof(Dst)) != 0)
+         {
+            FailCnt++;
+            printf("FAIL %s multiply-add of %d bytes at offset %d differs from the scalar loop\n",
+                   Kernel[k].Name, Len, Align);
+         }
+      }
+   }
+   
+} /* End TestMulAdd() */
+
+
+/******************************************************************************
+** Function: EncodeStream
+**
+** Encode DataPkt[] into Pkt[] and return the number of packets
+**
+*/
+static uint16_t EncodeStream(const Code_t *Code, Pkt_t Pkt[])
+{
+   
+   uint16_t PktCnt = 0;
+   uint16_t i;
+   
+   TX_FEC_Constructor(&TxFec, Code->K, Code->M, Code->PktLen);
+   TX_FEC_Reset(&TxFec);
+   
+   for (i = 0; i < TEST_STREAM_PKTS; i++)
+   {
+      memcpy(&Pkt[PktCnt].Data[TX_FEC_HDR_LEN], DataPkt[i].Data, DataPkt[i].Len);
+      Pkt[PktCnt].Len = TX_FEC_EncodeData(&TxFec, Pkt[PktCnt].Data, DataPkt[i].Len);
+      PktCnt++;
+      while (TxFec.ParityPending)
+      {
+         Pkt[PktCnt].Len = TX_FEC_NextParity(&TxFec, Pkt[PktCnt].Data);
+         PktCnt++;
+      }
+   }
+   if (TX_FEC_EndGroup(&TxFec))
+   {
+      while (TxFec.ParityPending)
+      {
+         Pkt[PktCnt].Len = TX_FEC_NextParity(&TxFec, Pkt[PktCnt].Data);
+         PktCnt++;
+      }
+   }
+   
+   return PktCnt;
+   
+} /* End EncodeStream() */
+
+
+/******************************************************************************
+** Function: TestCode
+**
+** Encode a stream with the selected kernel and decode each group after
+** erasing up to M of its packets
+**
+*/
+static void TestCode(uint8_t k, const Code_t *Code)
+{
+   
+   bool     Lost[TEST_GROUP_MAX];
+   uint16_t PktCnt;
+   uint16_t First, GroupPkts, DataPkts, FirstData = 0;
+   uint16_t Group = 0;
+   uint16_t LostCnt, Start, Trial, i, n;
+   uint16_t DataMax = Code->PktLen - TX_FEC_HDR_LEN - 1;
+   
+   /* Random lengths including empty and full packets and a partial last group */
+   for (i = 0; i < TEST_STREAM_PKTS; i++)
+   {
+      switch (i % 4)
+      {
+         case 0:  DataPkt[i].Len = DataMax; break;
+         case 1:  DataPkt[i].Len = (i % 8 == 1) ? 0 : 1; break;
+         default: DataPkt[i].Len = (uint16_t)(NextRand() % (DataMax + 1)); break;
+      }
+      for (n = 0; n < DataPkt[i].Len; n++)
+      {
+         DataPkt[i].Data[n] = (uint8_t)NextRand();
+      }
+   }
+   
+   TX_FEC_SelectKernel(TX_FEC_KERNEL_SCALAR);
+   RefPktCnt = EncodeStream(Code, RefPkt);
+   TX_FEC_SelectKernel(Kernel[k].Kernel);
+   PktCnt = EncodeStream(Code, TxPkt);
+   
+   CheckCnt++;
+   if (PktCnt != RefPktCnt)
+   {
+      FailCnt++;
+      printf("FAIL %s K=%d M=%d PktLen=%d: %d packets, the scalar kernel encoded %d\n",
+             Kernel[k].Name, Code->K, Code->M, Code->PktLen, PktCnt, RefPktCnt);
+      return;
+   }
+   for (i = 0; i < PktCnt; i++)
+   {
+      if (TxPkt[i].Len != RefPkt[i].Len || memcmp(TxPkt[i].Data, RefPkt[i].Data, TxPkt[i].Len) != 0)
+      {
+         FailCnt++;
+         printf("FAIL %s K=%d M=%d PktLen=%d: packet %d differs from the scalar kernel\n",
+                Kernel[k].Name, Code->K, Code->M, Code->PktLen, i);
+         return;
+      }
+   }
+   
+   for (First = 0; First < PktCnt; First += GroupPkts, Group++)
+   {
+      
+      DataPkts = (TEST_STREAM_PKTS - FirstData < Code->K) ? (TEST_STREAM_PKTS - FirstData) : Code->K;
+      GroupPkts = DataPkts + Code->M;
+      
+      for (LostCnt = 0; LostCnt <= Code->M; LostCnt++)
+      {
+         
+         /* Bursts at every position */
+         for (Start = 0; (Start + LostCnt) <= GroupPkts; Start++)
+         {
+            for (i = 0; i < GroupPkts; i++)
+            {
+               Lost[i] = (i >= Start && i < (Start + LostCnt));
+            }
+            CheckCnt++;
+            if (!DecodeGroup(&TxPkt[First], GroupPkts, FirstData, Lost))
+            {
+               Fail(k, Code, "burst erasure not recovered", Group, LostCnt);
+            }
+         }
+         
+         /* Random patterns */
+         for (Trial = 0; Trial < TEST_RANDOM_TRIALS; Trial++)
+         {
+            memset(Lost, 0, sizeof(Lost));
+            for (n = 0; n < LostCnt; )
+            {
+               i = (uint16_t)(NextRand() % GroupPkts);
+               if (!Lost[i])
+               {
+                  Lost[i] = true;
+                  n++;
+               }
+            }
+            CheckCnt++;
+            if (!DecodeGroup(&TxPkt[First], GroupPkts, FirstData, Lost))
+            {
+               Fail(k, Code, "random erasure not recovered", Group, LostCnt);
+            }
+         }
+      }
+      
+      /* More data packets lost than parity packets received */
+      if (DataPkts > Code->M)
+      {
+         for (i = 0; i < GroupPkts; i++)
+         {
+            Lost[i] = (i <= Code->M);
+         }
+         CheckCnt++;
+         if (DecodeGroup(&TxPkt[First], GroupPkts, FirstData, Lost))
+         {
+            Fail(k, Code, "decode succeeded with too few packets", Group, Code->M + 1);
+         }
+      }
+      
+      FirstData += DataPkts;
+   
+   }
+   
+} /* End TestCode() */
+
+
+/******************************************************************************
+** Function: DecodeGroup
+**
+** Decode a group's received packets like a receiver and return true if
+** every data packet is recovered with its original length and data
+**
+*/
+static bool DecodeGroup(const Pkt_t *Pkt, uint16_t PktCnt, uint16_t FirstData, const bool Lost[])
+{
+   
+   static uint8_t SymBuf[TX_FEC_MAX_DATA][TX_FEC_MAX_SYM_LEN];
+   static uint8_t ParityBuf[TX_FEC_MAX_PARITY][TX_FEC_MAX_SYM_LEN];
+   uint8_t  *Symbol[TX_FEC_MAX_DATA];
+   uint8_t  *Parity[TX_FEC_MAX_PARITY];
+   uint8_t  ParityIdx[TX_FEC_MAX_PARITY];
+   bool     Present[TX_FEC_MAX_DATA];
+   uint8_t  ParityCnt = 0;
+   uint8_t  K = 0;       /* Data packets in the group, a receiver reads it from a parity header */
+   uint16_t SymLen = 0;
+   uint16_t DataLen;
+   uint16_t i;
+   uint8_t  Idx;
+   
+   memset(SymBuf, 0, sizeof(SymBuf));
+   memset(Present, 0, sizeof(Present));
+   
+   for (i = 0; i < PktCnt; i++)
+   {
+      Idx = Pkt[i].Data[2];
+      if (Idx & TX_FEC_PARITY)
+      {
+         if (!Lost[i])
+         {
+            SymLen = Pkt[i].Len - TX_FEC_HDR_LEN;
+            memcpy(ParityBuf[ParityCnt], &Pkt[i].Data[TX_FEC_HDR_LEN], SymLen);
+            Parity[ParityCnt]    = ParityBuf[ParityCnt];
+            ParityIdx[ParityCnt] = Idx & ~TX_FEC_PARITY;
+            ParityCnt++;
+         }
+      }
+      else
+      {
+         K++;
+      }
+      if (!(Idx & TX_FEC_PARITY) && !Lost[i])
+      {
+         DataLen = Pkt[i].Len - TX_FEC_HDR_LEN;
+         SymBuf[Idx][0] = (uint8_t)DataLen;
+         memcpy(&SymBuf[Idx][1], &Pkt[i].Data[TX_FEC_HDR_LEN], DataLen);
+         Present[Idx] = true;
+      }
+   }
+   
+   for (i = 0; i < K; i++)
+   {
+      Symbol[i] = SymBuf[i];
+   }
+   
+   if (!TX_FEC_DecodeGroup(K, SymLen, Symbol, Present, Parity, ParityIdx, ParityCnt))
+   {
+      return false;
+   }
+   
+   for (i = 0; i < K; i++)
+   {
+      if (SymBuf[i][0] != DataPkt[FirstData + i].Len ||
+          memcmp(&SymBuf[i][1], DataPkt[FirstData + i].Data, DataPkt[FirstData + i].Len) != 0)
+      {
+         return false;
+      }
+   }
+   
+   return true;
+   
+} /* End DecodeGroup() */